@@ -0,0 +1,231 @@
+#include "adpcm.h"
+#include "engine.h"
+
+void encodeAdpcmBlock(AdpcmEncoder* encoder, int channels, Uint8* block);
+void decodeAdpcmBlock(const Uint8* block, int channels, Sint16* out);
+Uint8 encodeAdpcmSample(int sample, int* predictor, int* index);
+int decodeAdpcmSample(Uint8 nibble, int* predictor, int* index);
+
+const int adpcmStepTable[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+const int adpcmIndexTable[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+/*ALLOCATE A CLIP HOLDING UP TO maxFrames (ROUNDED UP TO WHOLE BLOCKS) SO ENCODING NEVER ALLOCATES*/
+bool initAdpcmClip(AdpcmClip* clip, int channels, int freq, Uint32 maxFrames)
+{
+	Uint32 blocks = (maxFrames + ADPCM_BLOCK_FRAMES - 1) / ADPCM_BLOCK_FRAMES;
+
+	SDL_zerop(clip);
+
+	if(channels < 1 || channels > ADPCM_MAX_CHANNELS){
+		SDL_SetError("IMA-ADPCM clips hold 1 or %d channels, not %d", ADPCM_MAX_CHANNELS, channels);
+		print_err("Could not create ADPCM clip");
+		return false;
+	}
+
+	clip->data = (Uint8*)SDL_malloc(blocks * ADPCM_BLOCK_BYTES(channels));
+	if(clip->data == NULL){
+		print_err("Could not allocate ADPCM clip");
+		return false;
+	}
+
+	clip->capacity = blocks * ADPCM_BLOCK_BYTES(channels);
+	clip->channels = channels;
+	clip->freq = freq;
+
+	return true;
+}
+
+/*EMPTY clip FOR A NEW RECORDING AND RESTART encoder*/
+void resetAdpcmClip(AdpcmClip* clip, AdpcmEncoder* encoder)
+{
+	int c;
+
+	clip->size = 0;
+	clip->frames = 0;
+	encoder->nPending = 0;
+
+	for(c = 0; c < ADPCM_MAX_CHANNELS; c++)
+		encoder->index[c] = 0;
+}
+
+void freeAdpcmClip(AdpcmClip* clip)
+{
+	SDL_free(clip->data);
+	SDL_zerop(clip);
+}
+
+/*APPEND frames INTERLEAVED S16 FRAMES, ENCODING EVERY BLOCK THEY COMPLETE, RETURN FRAMES TAKEN (FEWER ONCE THE CLIP IS FULL)*/
+Uint32 encodeAdpcm(AdpcmEncoder* encoder, AdpcmClip* clip, const Sint16* samples, Uint32 frames)
+{
+	Uint32 blockBytes = ADPCM_BLOCK_BYTES(clip->channels), taken = 0, n;
+
+	while(taken < frames && clip->size + blockBytes <= clip->capacity)
+	{
+		n = SDL_min(frames - taken, (Uint32)(ADPCM_BLOCK_FRAMES - encoder->nPending));
+		SDL_memcpy(&encoder->pending[encoder->nPending * clip->channels], &samples[taken * clip->channels], n * clip->channels * sizeof(Sint16));
+		encoder->nPending += n;
+		taken += n;
+
+		if(encoder->nPending == ADPCM_BLOCK_FRAMES){
+			encodeAdpcmBlock(encoder, clip->channels, &clip->data[clip->size]);
+			clip->size += blockBytes;
+			clip->frames += ADPCM_BLOCK_FRAMES;
+			encoder->nPending = 0;
+		}
+	}
+
+	return taken;
+}
+
+/*ENCODE THE LAST PARTIAL BLOCK, PADDED WITH ITS FINAL FRAME (clip->frames KEEPS THE REAL LENGTH)*/
+void flushAdpcmEncoder(AdpcmEncoder* encoder, AdpcmClip* clip)
+{
+	int i;
+
+	if(encoder->nPending == 0 || clip->size + ADPCM_BLOCK_BYTES(clip->channels) > clip->capacity)
+		return;
+
+	for(i = encoder->nPending * clip->channels; i < ADPCM_BLOCK_FRAMES * clip->channels; i++)
+		encoder->pending[i] = encoder->pending[i - clip->channels];
+
+	encodeAdpcmBlock(encoder, clip->channels, &clip->data[clip->size]);
+	clip->size += ADPCM_BLOCK_BYTES(clip->channels);
+	clip->frames += encoder->nPending;
+	encoder->nPending = 0;
+}
+
+void startAdpcmDecoder(AdpcmDecoder* decoder)
+{
+	decoder->nextBlock = 0;
+	decoder->frames = 0;
+	decoder->position = 0;
+}
+
+/*DECODE UP TO maxFrames INTERLEAVED S16 FRAMES FROM WHERE THE LAST CALL STOPPED, 0 AT THE END OF THE CLIP*/
+Uint32 decodeAdpcm(AdpcmDecoder* decoder, const AdpcmClip* clip, Sint16* out, Uint32 maxFrames)
+{
+	Uint32 blockBytes = ADPCM_BLOCK_BYTES(clip->channels), written = 0, n;
+
+	while(written < maxFrames)
+	{
+		if(decoder->position == decoder->frames){
+			if((decoder->nextBlock + 1) * blockBytes > clip->size)
+				break;
+
+			decodeAdpcmBlock(&clip->data[decoder->nextBlock * blockBytes], clip->channels, decoder->block);
+			decoder->frames = (int)SDL_min(clip->frames - decoder->nextBlock * ADPCM_BLOCK_FRAMES, (Uint32)ADPCM_BLOCK_FRAMES);
+			decoder->position = 0;
+			decoder->nextBlock++;
+		}
+
+		n = SDL_min(maxFrames - written, (Uint32)(decoder->frames - decoder->position));
+		SDL_memcpy(&out[written * clip->channels], &decoder->block[decoder->position * clip->channels], n * clip->channels * sizeof(Sint16));
+		decoder->position += n;
+		written += n;
+	}
+
+	return written;
+}
+
+/*ENCODE THE ADPCM_BLOCK_FRAMES PENDING FRAMES INTO ONE BLOCK: FIRST FRAME RAW IN THE HEADERS, THE REST AS NIBBLES*/
+void encodeAdpcmBlock(AdpcmEncoder* encoder, int channels, Uint8* block)
+{
+	Uint8 *word = block + 4 * channels;
+	int predictor[ADPCM_MAX_CHANNELS];
+	int c, i, k;
+	Uint8 nibble;
+
+	for(c = 0; c < channels; c++){
+		predictor[c] = encoder->pending[c];
+		block[4*c] = (Uint8)(predictor[c] & 0xFF);
+		block[4*c + 1] = (Uint8)((predictor[c] >> 8) & 0xFF);
+		block[4*c + 2] = (Uint8)encoder->index[c];
+		block[4*c + 3] = 0;
+	}
+
+	//each channel in turn gets 4 bytes holding its next 8 samples, low nibble first
+	for(i = 1; i < ADPCM_BLOCK_FRAMES; i += 8){
+		for(c = 0; c < channels; c++){
+			for(k = 0; k < 8; k++){
+				nibble = encodeAdpcmSample(encoder->pending[(i + k) * channels + c], &predictor[c], &encoder->index[c]);
+				if(k % 2 == 0)
+					word[k / 2] = nibble;
+				else
+					word[k / 2] |= nibble << 4;
+			}
+			word += 4;
+		}
+	}
+}
+
+void decodeAdpcmBlock(const Uint8* block, int channels, Sint16* out)
+{
+	const Uint8 *word = block + 4 * channels;
+	int predictor[ADPCM_MAX_CHANNELS], index[ADPCM_MAX_CHANNELS];
+	int c, i, k;
+
+	for(c = 0; c < channels; c++){
+		predictor[c] = (Sint16)(block[4*c] | (block[4*c + 1] << 8));
+		index[c] = SDL_min((int)block[4*c + 2], 88);
+		out[c] = (Sint16)predictor[c];
+	}
+
+	for(i = 1; i < ADPCM_BLOCK_FRAMES; i += 8){
+		for(c = 0; c < channels; c++){
+			for(k = 0; k < 8; k++)
+				out[(i + k) * channels + c] = (Sint16)decodeAdpcmSample((word[k / 2] >> (4 * (k % 2))) & 0xF, &predictor[c], &index[c]);
+			word += 4;
+		}
+	}
+}
+
+/*QUANTIZE THE DIFFERENCE TO THE PREDICTION INTO A SIGN AND 3 BITS OF THE CURRENT STEP, TRACKING THE DECODER'S STATE*/
+Uint8 encodeAdpcmSample(int sample, int* predictor, int* index)
+{
+	int step = adpcmStepTable[*index];
+	int diff = sample - *predictor;
+	Uint8 nibble = 0;
+
+	if(diff < 0){
+		nibble = 8;
+		diff = -diff;
+	}
+
+	if(diff >= step){
+		nibble |= 4;
+		diff -= step;
+	}
+	if(diff >= step >> 1){
+		nibble |= 2;
+		diff -= step >> 1;
+	}
+	if(diff >= step >> 2)
+		nibble |= 1;
+
+	decodeAdpcmSample(nibble, predictor, index);
+
+	return nibble;
+}
+
+int decodeAdpcmSample(Uint8 nibble, int* predictor, int* index)
+{
+	int step = adpcmStepTable[*index];
+	int delta = step >> 3;
+
+	if(nibble & 4) delta += step;
+	if(nibble & 2) delta += step >> 1;
+	if(nibble & 1) delta += step >> 2;
+
+	*predictor += (nibble & 8) ? -delta : delta;
+	*predictor = SDL_min(SDL_max(*predictor, -32768), 32767);
+	*index = SDL_min(SDL_max(*index + adpcmIndexTable[nibble], 0), 88);
+
+	return *predictor;
+}
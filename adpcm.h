@@ -0,0 +1,45 @@
+#ifndef ADPCM_H
+#define ADPCM_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+
+#define ADPCM_MAX_CHANNELS 2
+#define ADPCM_BLOCK_FRAMES 505                      //frames per block: the header sample plus 8 per 4 nibble bytes
+#define ADPCM_BLOCK_BYTES(channels) (256 * (channels)) //WAV IMA-ADPCM block align for ADPCM_BLOCK_FRAMES
+
+//IMA-ADPCM clip in the WAV (format 0x11) block layout: per channel a 4 byte header (first sample, step index),
+//then 4 bytes of 8 nibbles per channel in turn, about 4 bits per sample
+typedef struct{
+	Uint8 *data;
+	Uint32 capacity;  //bytes, whole blocks
+	Uint32 size;      //bytes of encoded blocks
+	Uint32 frames;    //frames encoded, the last block may be partial
+	int channels;
+	int freq;
+} AdpcmClip;
+
+//S16 frames waiting for a full block, and the step state carried from block to block
+typedef struct{
+	Sint16 pending[ADPCM_BLOCK_FRAMES * ADPCM_MAX_CHANNELS];
+	int nPending;
+	int index[ADPCM_MAX_CHANNELS];
+} AdpcmEncoder;
+
+//one decoded block handed out a slice at a time
+typedef struct{
+	Sint16 block[ADPCM_BLOCK_FRAMES * ADPCM_MAX_CHANNELS];
+	Uint32 nextBlock;
+	int frames;       //frames decoded in block
+	int position;     //next frame of block to hand out
+} AdpcmDecoder;
+
+bool initAdpcmClip(AdpcmClip* clip, int channels, int freq, Uint32 maxFrames);
+void resetAdpcmClip(AdpcmClip* clip, AdpcmEncoder* encoder);
+void freeAdpcmClip(AdpcmClip* clip);
+Uint32 encodeAdpcm(AdpcmEncoder* encoder, AdpcmClip* clip, const Sint16* samples, Uint32 frames);
+void flushAdpcmEncoder(AdpcmEncoder* encoder, AdpcmClip* clip);
+void startAdpcmDecoder(AdpcmDecoder* decoder);
+Uint32 decodeAdpcm(AdpcmDecoder* decoder, const AdpcmClip* clip, Sint16* out, Uint32 maxFrames);
+
+#endif
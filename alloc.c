@@ -0,0 +1,127 @@
+#include "alloc.h"
+
+#define ARENA_HEADER_SIZE ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+Arena levelArena, frameArena;
+
+/*GET size BYTES (ALIGNED TO ARENA_ALIGNMENT) FROM arena, ADDING A NEW BLOCK IF THE NEWEST ONE IS FULL*/
+void* arenaAlloc(Arena* arena, size_t size)
+{
+	ArenaBlock *block = arena->head;
+	size_t blockSize = arena->blockSize > 0 ? arena->blockSize : ARENA_BLOCK_SIZE;
+	void *memory;
+
+	size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+	if(block == NULL || block->used + size > block->size)
+	{
+		if(size > blockSize)
+			blockSize = size; //oversized requests get a block of their own
+
+		block = (ArenaBlock*)SDL_malloc(ARENA_HEADER_SIZE + blockSize);
+		if(block == NULL){
+			SDL_OutOfMemory();
+			return NULL;
+		}
+
+		block->size = blockSize;
+		block->used = 0;
+		block->next = arena->head;
+		arena->head = block;
+		arena->reserved += blockSize;
+		arena->nBlocks++;
+	}
+
+	memory = (Uint8*)block + ARENA_HEADER_SIZE + block->used;
+	block->used += size;
+	arena->used += size;
+
+	return memory;
+}
+
+/*GET A ZEROED ARRAY OF count ELEMENTS OF size BYTES FROM arena*/
+void* arenaCalloc(Arena* arena, size_t count, size_t size)
+{
+	void *memory;
+
+	if(size != 0 && count > (size_t)-1 / size)
+		return NULL;
+
+	memory = arenaAlloc(arena, count * size);
+	if(memory != NULL)
+		SDL_memset(memory, 0, count * size);
+
+	return memory;
+}
+
+/*RELEASE EVERYTHING ALLOCATED FROM arena, KEEPING ITS OLDEST BLOCK FOR REUSE*/
+void arenaReset(Arena* arena)
+{
+	ArenaBlock *block;
+
+	while(arena->head != NULL && arena->head->next != NULL){
+		block = arena->head;
+		arena->head = block->next;
+		arena->reserved -= block->size;
+		arena->nBlocks--;
+		SDL_free(block);
+	}
+
+	if(arena->head != NULL)
+		arena->head->used = 0;
+
+	arena->used = 0;
+}
+
+/*RELEASE arena AND ALL ITS BLOCKS*/
+void arenaFree(Arena* arena)
+{
+	arenaReset(arena);
+	SDL_free(arena->head);
+	arena->head = NULL;
+	arena->reserved = 0;
+	arena->nBlocks = 0;
+}
+
+/*SET UP pool OF slotSize SLOTS CARVED FROM arena*/
+void poolInit(Pool* pool, Arena* arena, size_t slotSize)
+{
+	pool->arena = arena;
+	pool->slotSize = slotSize > sizeof(void*) ? slotSize : sizeof(void*); //free slots hold the free list link
+	pool->freeList = NULL;
+	pool->live = 0;
+}
+
+/*GET A SLOT FROM pool (RELEASED SLOTS FIRST)*/
+void* poolAlloc(Pool* pool)
+{
+	void *slot = pool->freeList;
+
+	if(slot != NULL)
+		pool->freeList = *(void**)slot;
+	else
+		slot = arenaAlloc(pool->arena, pool->slotSize);
+
+	if(slot != NULL)
+		pool->live++;
+
+	return slot;
+}
+
+/*GIVE slot BACK TO pool FOR REUSE*/
+void poolRelease(Pool* pool, void* slot)
+{
+	if(slot == NULL)
+		return;
+
+	*(void**)slot = pool->freeList;
+	pool->freeList = slot;
+	pool->live--;
+}
+
+/*FORGET ALL pool SLOTS (CALL WITH A RESET OF ITS ARENA)*/
+void poolReset(Pool* pool)
+{
+	pool->freeList = NULL;
+	pool->live = 0;
+}
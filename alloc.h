@@ -0,0 +1,43 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT 16
+
+typedef struct ArenaBlock{
+	struct ArenaBlock *next; //older block
+	size_t size, used;
+} ArenaBlock;
+
+//bump allocator: many allocations carved from a few blocks, all released at once
+typedef struct{
+	ArenaBlock *head; //newest block
+	size_t blockSize; //0: ARENA_BLOCK_SIZE
+	size_t reserved, used;
+	int nBlocks;
+} Arena;
+
+//fixed size slots carved from an arena, released slots are reused before the arena grows
+typedef struct{
+	Arena *arena;
+	size_t slotSize;
+	void *freeList;
+	int live;
+} Pool;
+
+void* arenaAlloc(Arena* arena, size_t size);
+void* arenaCalloc(Arena* arena, size_t count, size_t size);
+void arenaReset(Arena* arena);
+void arenaFree(Arena* arena);
+
+void poolInit(Pool* pool, Arena* arena, size_t slotSize);
+void* poolAlloc(Pool* pool);
+void poolRelease(Pool* pool, void* slot);
+void poolReset(Pool* pool);
+
+extern Arena levelArena, frameArena;
+
+#endif
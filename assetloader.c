@@ -0,0 +1,300 @@
+#include "assetloader.h"
+#include "SDL2/SDL_image.h"
+
+Asset* addAsset(AssetLoader* loader, AssetEnum type, const char* path, Uint32* handle);
+int decodeAssets(void* data);
+void decodeAsset(AssetLoader* loader, Asset* asset);
+void registerAsset(Asset* asset);
+double assetMs(Uint64 start, Uint64 end);
+
+void initAssetLoader(AssetLoader* loader)
+{
+	SDL_zerop(loader);
+}
+
+/*LOAD AN IMAGE INTO A STATIC TEXTURE, *texture IS SET BY finishAssetLoader (OR RIGHT AWAY IF resources ALREADY HAS IT)*/
+void queueImage(AssetLoader* loader, const char* path, SDL_Color* colorKey, TextureHandle* texture)
+{
+	Asset *asset;
+
+	*texture = findTexture(&resources, path, colorKey, false);
+	if(texture->id != 0)
+		return;
+
+	asset = addAsset(loader, ASSET_IMAGE, path, &texture->id);
+	if(asset != NULL)
+		asset->colorKey = colorKey;
+}
+
+/*LOAD AN IMAGE INTO A PIXEL STREAMING TEXTURE, CONVERTED ON THE WORKER TO pixelFormat (THE WINDOW FORMAT, QUERIED BY THE CALLER
+ *ON THE VIDEO THREAD). THE CONVERTED PIXELS STAY WITH THE TEXTURE (getTexturePixels)*/
+void queuePixelImage(AssetLoader* loader, const char* path, Uint32 pixelFormat, TextureHandle* texture)
+{
+	Asset *asset;
+
+	*texture = findTexture(&resources, path, NULL, true);
+	if(texture->id != 0)
+		return;
+
+	asset = addAsset(loader, ASSET_PIXEL_IMAGE, path, &texture->id);
+	if(asset != NULL)
+		asset->pixelFormat = pixelFormat;
+}
+
+void queueFont(AssetLoader* loader, const char* path, int size, FontHandle* font)
+{
+	Asset *asset;
+
+	*font = findFont(&resources, path, size);
+	if(font->id != 0)
+		return;
+
+	asset = addAsset(loader, ASSET_FONT, path, &font->id);
+	if(asset != NULL)
+		asset->fontSize = size;
+}
+
+/*LOAD A SOUND FOR mixer, WHICH MUST BE READY BEFORE THE LOADER STARTS*/
+void queueSound(AssetLoader* loader, Mixer* mixer, const char* path, SoundHandle* sound)
+{
+	Asset *asset;
+
+	*sound = findSound(&resources, path);
+	if(sound->id != 0)
+		return;
+
+	asset = addAsset(loader, ASSET_SOUND, path, &sound->id);
+	if(asset != NULL)
+		asset->mixer = mixer;
+}
+
+Asset* addAsset(AssetLoader* loader, AssetEnum type, const char* path, Uint32* handle)
+{
+	Asset *asset;
+
+	if(loader->nAssets == ASSET_MAX){
+		SDL_SetError("More than %d startup assets", ASSET_MAX);
+		print_err("Could not queue asset");
+		return NULL;
+	}
+
+	asset = &loader->assets[loader->nAssets++];
+	SDL_zerop(asset);
+	asset->type = type;
+	asset->path = path;
+	asset->handle = handle;
+
+	return asset;
+}
+
+/*START ONE WORKER PER CPU (AT LEAST 2, NO MORE THAN ASSETS); THE WAITING THREAD DECODES TOO, SO FAILING TO START ANY ONLY COSTS TIME*/
+void startAssetLoader(AssetLoader* loader)
+{
+	int i, nWorkers = SDL_min(SDL_max(SDL_GetCPUCount(), 2), SDL_min(loader->nAssets, ASSET_MAX_WORKERS));
+
+	SDL_AtomicSet(&loader->next, 0);
+	loader->startCounter = SDL_GetPerformanceCounter();
+
+	loader->fontLock = SDL_CreateMutex();
+	if(loader->fontLock == NULL){
+		print_err("Could not create font lock, decoding assets on one thread");
+		return;
+	}
+
+	for(i = 0; i < nWorkers; i++)
+	{
+		loader->workerArgs[i] = (AssetWorker){loader, i + 1};
+		loader->workers[i] = SDL_CreateThread(decodeAssets, "assetLoader", &loader->workerArgs[i]);
+
+		if(loader->workers[i] == NULL){
+			print_err("Could not start asset worker");
+			break;
+		}
+	}
+
+	loader->nWorkers = i;
+}
+
+/*DECODE ALONGSIDE THE WORKERS UNTIL EVERY ASSET IS CLAIMED, THEN JOIN THEM*/
+void waitAssetLoader(AssetLoader* loader)
+{
+	AssetWorker self = {loader, 0};
+	int i;
+
+	decodeAssets(&self);
+
+	for(i = 0; i < loader->nWorkers; i++)
+		SDL_WaitThread(loader->workers[i], NULL);
+
+	loader->nWorkers = 0;
+	loader->decodeWallMs = assetMs(loader->startCounter, SDL_GetPerformanceCounter());
+
+	SDL_DestroyMutex(loader->fontLock);
+	loader->fontLock = NULL;
+}
+
+/*ON THE RENDER THREAD: UPLOAD THE DECODED IMAGES, HAND EVERYTHING TO resources AND SET THE QUEUED HANDLES (0 FOR WHAT FAILED),
+ *THEN LOG PER ASSET DECODE/UPLOAD TIMES AGAINST THE WALL TIME DECODING TOOK*/
+void finishAssetLoader(AssetLoader* loader, FILE* out)
+{
+	const char *types[] = {"image", "pixels", "font", "sound"};
+	double decodeSum = 0, uploadSum = 0;
+	Uint64 start;
+	int i;
+
+	for(i = 0; i < loader->nAssets; i++)
+	{
+		Asset *asset = &loader->assets[i];
+
+		start = SDL_GetPerformanceCounter();
+		registerAsset(asset);
+		asset->uploadMs = assetMs(start, SDL_GetPerformanceCounter());
+
+		fprintf(out, "[assets] %-28s %-6s %s decode %7.2fms (worker %d) upload %6.2fms\n", asset->path, types[asset->type],
+			!asset->loaded ? "FAILED" : asset->cache.hit ? "cached" : "ok    ", asset->decodeMs, asset->worker, asset->uploadMs);
+
+		decodeSum += asset->decodeMs;
+		uploadSum += asset->uploadMs;
+	}
+
+	fprintf(out, "[assets] %d assets: decode %.2fms wall (%.2fms summed), uploads %.2fms\n", loader->nAssets, loader->decodeWallMs, decodeSum, uploadSum);
+
+	loader->nAssets = 0;
+}
+
+/*UPLOAD asset IF IT IS AN IMAGE AND MOVE IT INTO resources, SHARING ONE LOADED UNDER THE SAME KEY MEANWHILE*/
+void registerAsset(Asset* asset)
+{
+	SDL_Surface *pixels = NULL;
+	Texture texture;
+
+	*asset->handle = 0;
+
+	switch(asset->type){
+	case ASSET_IMAGE:
+	case ASSET_PIXEL_IMAGE:
+		if(asset->surface == NULL)
+			break;
+
+		*asset->handle = findTexture(&resources, asset->path, asset->colorKey, asset->type == ASSET_PIXEL_IMAGE).id;
+		if(*asset->handle == 0){
+			if(asset->type == ASSET_PIXEL_IMAGE){
+				//a cached surface is only a view of the mapped file, the texture keeps its own copy
+				pixels = asset->cache.hit ? SDL_ConvertSurfaceFormat(asset->surface, asset->surface->format->format, 0) : asset->surface;
+				SDL_zero(texture);
+				if(pixels != NULL)
+					texture = createPixelTexture(pixels, asset->path);
+				else
+					print_err("Could not copy cached pixels");
+			}
+			else{
+				texture = createSurfaceTexture(asset->surface, asset->path, asset->colorKey);
+			}
+
+			*asset->handle = addTexture(&resources, asset->path, asset->colorKey, texture, pixels).id;
+		}
+
+		if(asset->cache.hit)
+			closePixelCache(&asset->cache);
+		else if(pixels != asset->surface)
+			SDL_FreeSurface(asset->surface);
+		asset->surface = NULL;
+		break;
+
+	case ASSET_FONT:
+		*asset->handle = findFont(&resources, asset->path, asset->fontSize).id;
+		if(*asset->handle != 0)
+			TTF_CloseFont(asset->font);
+		else if(asset->font != NULL)
+			*asset->handle = addFont(&resources, asset->path, asset->fontSize, asset->font).id;
+		asset->font = NULL;
+		break;
+
+	case ASSET_SOUND:
+		*asset->handle = findSound(&resources, asset->path).id;
+		if(*asset->handle != 0)
+			freeSound(&asset->sound);
+		else if(asset->loaded)
+			*asset->handle = addSound(&resources, asset->path, asset->sound).id;
+		break;
+	}
+
+	asset->loaded = *asset->handle != 0;
+}
+
+/*WORKER: CLAIM AND DECODE ASSETS UNTIL NONE ARE LEFT*/
+int decodeAssets(void* data)
+{
+	AssetWorker *worker = (AssetWorker*)data;
+	AssetLoader *loader = worker->loader;
+	Uint64 start;
+	int next;
+
+	while((next = SDL_AtomicAdd(&loader->next, 1)) < loader->nAssets)
+	{
+		start = SDL_GetPerformanceCounter();
+
+		decodeAsset(loader, &loader->assets[next]);
+
+		loader->assets[next].worker = worker->id;
+		loader->assets[next].decodeMs = assetMs(start, SDL_GetPerformanceCounter());
+	}
+
+	return 0;
+}
+
+void decodeAsset(AssetLoader* loader, Asset* asset)
+{
+	SDL_Surface *converted;
+
+	switch(asset->type){
+	case ASSET_IMAGE:
+	case ASSET_PIXEL_IMAGE:
+		if(openPixelCache(&asset->cache, asset->path, asset->pixelFormat)){
+			asset->surface = asset->cache.surface;
+			asset->loaded = true;
+			break;
+		}
+
+		asset->surface = loadSurface(asset->path);
+
+		//palettes are not cached, static images with one are kept as 32 bit instead
+		if(asset->surface != NULL && (asset->type == ASSET_PIXEL_IMAGE || asset->surface->format->palette != NULL)){
+			converted = SDL_ConvertSurfaceFormat(asset->surface, asset->type == ASSET_PIXEL_IMAGE ? asset->pixelFormat : SDL_PIXELFORMAT_ARGB8888, 0);
+			if(converted == NULL)
+				print_err("Could not load formatted surface for pixel streaming");
+
+			SDL_FreeSurface(asset->surface);
+			asset->surface = converted;
+		}
+
+		if(asset->surface != NULL)
+			writePixelCache(&asset->cache, asset->surface); //a failed write only costs the next start a decode
+
+		asset->loaded = asset->surface != NULL;
+		break;
+
+	case ASSET_FONT:
+		if(loader->fontLock != NULL)
+			SDL_LockMutex(loader->fontLock);
+
+		asset->font = TTF_OpenFont(asset->path, asset->fontSize);
+
+		if(loader->fontLock != NULL)
+			SDL_UnlockMutex(loader->fontLock);
+
+		if(asset->font == NULL)
+			print_err("Could not open font");
+		asset->loaded = asset->font != NULL;
+		break;
+
+	case ASSET_SOUND:
+		asset->loaded = loadSound(asset->mixer, &asset->sound, asset->path);
+		break;
+	}
+}
+
+double assetMs(Uint64 start, Uint64 end)
+{
+	return (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
@@ -0,0 +1,72 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_ttf.h"
+#include "engine.h"
+#include "mixer.h"
+#include "pixelcache.h"
+#include "resources.h"
+
+#define ASSET_MAX 32
+#define ASSET_MAX_WORKERS 8
+
+typedef enum
+{
+	ASSET_IMAGE,       //surface for a static texture
+	ASSET_PIXEL_IMAGE, //surface converted to pixelFormat for a pixel streaming texture
+	ASSET_FONT,
+	ASSET_SOUND        //stereo float at the mixer rate
+} AssetEnum;
+
+typedef struct{
+	AssetEnum type;
+	const char *path;
+	int fontSize;
+	Uint32 pixelFormat;
+	SDL_Color *colorKey;
+	Mixer *mixer;
+	SDL_Surface *surface;   //images, uploaded and freed (or kept as the pixels of a streaming texture) by finishAssetLoader
+	PixelCache cache;       //images: a hit supplies surface without decoding
+	TTF_Font *font;         //handed to resources by finishAssetLoader
+	Sound sound;            //handed to resources by finishAssetLoader
+	Uint32 *handle;         //where finishAssetLoader puts the resource
+	bool loaded;
+	int worker;             //0: the thread waiting for the loader
+	double decodeMs, uploadMs;
+} Asset;
+
+typedef struct AssetLoader AssetLoader;
+
+typedef struct{
+	AssetLoader *loader;
+	int id;
+} AssetWorker;
+
+//startup assets decoded (files read, images decoded and converted or mapped from their pixel cache, fonts opened, sounds converted) on worker threads,
+//leaving only texture uploads to the render thread. assets are claimed one at a time, so startup takes about as long as the slowest one.
+//assets resources already holds are shared from there instead of being queued
+struct AssetLoader{
+	Asset assets[ASSET_MAX];
+	int nAssets;
+	SDL_atomic_t next;                      //next asset to claim
+	SDL_Thread *workers[ASSET_MAX_WORKERS];
+	AssetWorker workerArgs[ASSET_MAX_WORKERS];
+	int nWorkers;
+	SDL_mutex *fontLock;                    //SDL_ttf opens every face from one FreeType library, one at a time
+	Uint64 startCounter;
+	double decodeWallMs;
+};
+
+void initAssetLoader(AssetLoader* loader);
+void queueImage(AssetLoader* loader, const char* path, SDL_Color* colorKey, TextureHandle* texture);
+void queuePixelImage(AssetLoader* loader, const char* path, Uint32 pixelFormat, TextureHandle* texture);
+void queueFont(AssetLoader* loader, const char* path, int size, FontHandle* font);
+void queueSound(AssetLoader* loader, Mixer* mixer, const char* path, SoundHandle* sound);
+void startAssetLoader(AssetLoader* loader);
+void waitAssetLoader(AssetLoader* loader);
+void finishAssetLoader(AssetLoader* loader, FILE* out);
+
+#endif
@@ -0,0 +1,220 @@
+#include "atlas.h"
+
+bool parseAtlasLine(Atlas* atlas, const char* line);
+
+/*READ CLIP FILE path INTO atlas (false WITH SDL ERROR SET IF IT CAN'T BE OPENED OR A LINE IS MALFORMED)*/
+bool readAtlas(Atlas* atlas, const char* path)
+{
+	char line[ATLAS_LINE_SIZE];
+	FILE *file = fopen(path, "r");
+	int lineNumber = 0;
+
+	SDL_zerop(atlas);
+
+	if(file == NULL){
+		SDL_SetError("Could not open %s", path);
+		return false;
+	}
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		lineNumber++;
+		if(!parseAtlasLine(atlas, line)){
+			SDL_SetError("%s:%d: bad atlas line", path, lineNumber);
+			fclose(file);
+			return false;
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+/*PARSE ONE page/clip LINE (BLANK LINES AND # COMMENTS ARE SKIPPED)*/
+bool parseAtlasLine(Atlas* atlas, const char* line)
+{
+	char path[ATLAS_PATH_SIZE], word[ATLAS_NAME_SIZE];
+	AtlasClip clip;
+	unsigned int key;
+	int n, m;
+
+	while(*line == ' ' || *line == '\t')
+		line++;
+
+	if(*line == '\0' || *line == '\n' || *line == '\r' || *line == '#')
+		return true;
+
+	if(sscanf(line, "page %127s%n", path, &n) == 1){
+		SDL_Color color;
+
+		if(sscanf(line + n, " key %6x", &key) == 1){
+			color = (SDL_Color){(Uint8)(key >> 16), (Uint8)(key >> 8), (Uint8)key, 0};
+			return addAtlasPage(atlas, path, &color) >= 0;
+		}
+
+		return addAtlasPage(atlas, path, NULL) >= 0;
+	}
+
+	SDL_zero(clip);
+	if(sscanf(line, "clip %31s %d %d %d %d %d%n", clip.name, &clip.page, &clip.rect.x, &clip.rect.y, &clip.rect.w, &clip.rect.h, &n) != 6)
+		return false;
+
+	clip.frame = (SDL_Rect){0, 0, clip.rect.w, clip.rect.h};
+	clip.levels = 1;
+
+	for(line += n; sscanf(line, " %31s%n", word, &n) == 1; line += n)
+	{
+		line += n;
+
+		if(strcmp(word, "level") == 0 && sscanf(line, " %d%n", &clip.level, &m) == 1)
+			n = m;
+		else if(strcmp(word, "levels") == 0 && sscanf(line, " %d%n", &clip.levels, &m) == 1)
+			n = m;
+		else if(strcmp(word, "frame") == 0 && sscanf(line, " %d %d %d %d%n", &clip.frame.x, &clip.frame.y, &clip.frame.w, &clip.frame.h, &m) == 4)
+			n = m;
+		else
+			return false;
+	}
+
+	if(clip.page < 0 || clip.page >= atlas->nPages || clip.rect.w <= 0 || clip.rect.h <= 0 || clip.frame.w <= 0 || clip.frame.h <= 0 ||
+		clip.level < 0 || clip.level >= ATLAS_MAX_LEVELS || clip.levels < 1 || clip.level + clip.levels > ATLAS_MAX_LEVELS || atlas->nClips == ATLAS_MAX_CLIPS)
+		return false;
+
+	atlas->clips[atlas->nClips++] = clip;
+	return true;
+}
+
+/*WRITE atlas AS A CLIP FILE TO path*/
+bool writeAtlas(Atlas* atlas, const char* path)
+{
+	FILE *file = fopen(path, "w");
+	AtlasClip *clip;
+	int i;
+
+	if(file == NULL){
+		SDL_SetError("Could not open %s", path);
+		return false;
+	}
+
+	fprintf(file, "# sprite clips, see atlas.h\n");
+
+	for(i = 0; i < atlas->nPages; i++)
+	{
+		fprintf(file, "page %s", atlas->pages[i]);
+		if(atlas->pageKeyed[i])
+			fprintf(file, " key %02X%02X%02X", atlas->pageKeys[i].r, atlas->pageKeys[i].g, atlas->pageKeys[i].b);
+		fprintf(file, "\n");
+	}
+
+	for(i = 0; i < atlas->nClips; i++)
+	{
+		clip = &atlas->clips[i];
+		fprintf(file, "clip %s %d %d %d %d %d level %d frame %d %d %d %d", clip->name, clip->page,
+			clip->rect.x, clip->rect.y, clip->rect.w, clip->rect.h, clip->level, clip->frame.x, clip->frame.y, clip->frame.w, clip->frame.h);
+		if(clip->levels > 1)
+			fprintf(file, " levels %d", clip->levels);
+		fprintf(file, "\n");
+	}
+
+	if(fclose(file) != 0){
+		SDL_SetError("Could not write %s", path);
+		return false;
+	}
+
+	return true;
+}
+
+/*ADD IMAGE path AS A PAGE OF atlas (colorKey MAY BE NULL) AND RETURN ITS INDEX, THE EXISTING ONE IF ALREADY THERE (-1 IF FULL)*/
+int addAtlasPage(Atlas* atlas, const char* path, SDL_Color* colorKey)
+{
+	int i;
+
+	for(i = 0; i < atlas->nPages; i++)
+	{
+		if(strcmp(atlas->pages[i], path) == 0)
+			return i;
+	}
+
+	if(atlas->nPages == ATLAS_MAX_PAGES || strlen(path) >= ATLAS_PATH_SIZE)
+		return -1;
+
+	SDL_strlcpy(atlas->pages[i], path, ATLAS_PATH_SIZE);
+	atlas->pageKeyed[i] = colorKey != NULL;
+	if(colorKey != NULL)
+		atlas->pageKeys[i] = *colorKey;
+
+	return atlas->nPages++;
+}
+
+/*FIND CLIP name CLOSEST TO level WITHOUT GOING ABOVE IT (NULL IF THERE IS NONE)*/
+AtlasClip* findAtlasClip(Atlas* atlas, const char* name, int level)
+{
+	AtlasClip *best = NULL;
+	int i;
+
+	for(i = 0; i < atlas->nClips; i++)
+	{
+		if(atlas->clips[i].level <= level && (best == NULL || atlas->clips[i].level > best->level) && strcmp(atlas->clips[i].name, name) == 0)
+			best = &atlas->clips[i];
+	}
+
+	return best;
+}
+
+/*QUEUE EVERY PAGE OF atlas ON loader (THE COLOR KEYS ARE READ FROM atlas, SO IT HAS TO OUTLIVE THE LOAD)*/
+void queueAtlas(AssetLoader* loader, Atlas* atlas)
+{
+	int i;
+
+	for(i = 0; i < atlas->nPages; i++)
+		queueImage(loader, atlas->pages[i], atlas->pageKeyed[i] ? &atlas->pageKeys[i] : NULL, &atlas->textures[i]);
+}
+
+/*CHECK EVERY PAGE OF atlas HAS A TEXTURE*/
+bool atlasLoaded(Atlas* atlas)
+{
+	int i;
+
+	for(i = 0; i < atlas->nPages; i++)
+	{
+		if(getTexture(&resources, atlas->textures[i]) == NULL)
+			return false;
+	}
+
+	return atlas->nPages > 0;
+}
+
+/*ADD CLIP name OF atlas TO sprite ON index, DRAWN AT 1/2^level OF ITS FULL SIZE (THE PRESCALED VARIANT IF THE ATLAS HAS ONE,
+SCALED WHEN DRAWING OTHERWISE). sprite DRAWS FROM THE CLIP'S PAGE, SO ALL ITS CLIPS HAVE TO SIT ON THE SAME ONE*/
+bool addAtlasClip(Sprite* sprite, int index, Atlas* atlas, const char* name, int level, bool setRender)
+{
+	AtlasClip *clip = findAtlasClip(atlas, name, level);
+	Texture *page = clip != NULL ? getTexture(&resources, atlas->textures[clip->page]) : NULL;
+
+	if(page == NULL || index < 0 || index >= sprite->nClips){
+		SDL_SetError("No atlas clip %s", name);
+		print_err("Could not add atlas clip");
+		return false;
+	}
+
+	sprite->sheet = page;
+	addClip(sprite, index, clip->rect, false);
+	setClipFrame(sprite, index, clip->frame);
+
+	if(setRender)
+		setRenderRect(sprite, index);
+
+	if(clip->level < level)
+		setScaleRect(sprite, clip->frame.w >> (level - clip->level), clip->frame.h >> (level - clip->level));
+
+	return true;
+}
+
+/*RELEASE THE PAGE TEXTURES OF atlas (ITS CLIPS STAY READABLE)*/
+void releaseAtlas(Atlas* atlas)
+{
+	int i;
+
+	for(i = 0; i < atlas->nPages; i++)
+		releaseTexture(&resources, &atlas->textures[i]);
+}
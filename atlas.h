@@ -0,0 +1,49 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "engine.h"
+#include "assetloader.h"
+
+#define ATLAS_MAX_PAGES 16
+#define ATLAS_MAX_CLIPS 96
+#define ATLAS_NAME_SIZE 32
+#define ATLAS_PATH_SIZE 128
+#define ATLAS_MAX_LEVELS 4   //full size, 1/2, 1/4, 1/8
+#define ATLAS_LINE_SIZE 256
+
+typedef struct{
+	char name[ATLAS_NAME_SIZE];
+	int page;
+	int level;        //drawn at 1/2^level of the full size sprite
+	SDL_Rect rect;    //pixels on the page
+	SDL_Rect frame;   //untrimmed size (w,h) and where rect sits inside it (x,y)
+	int levels;       //packer spec only: downscaled variants to emit, level included
+} AtlasClip;
+
+//named sprite clips and the images (pages) they sit on, read from a clip file:
+//  page PATH [key RRGGBB]
+//  clip NAME PAGE X Y W H [level N] [frame X Y W H] [levels N]
+//imgs/sprites.txt lists the clips on their source images, tools/atlaspack.c trims and packs them (with downscaled
+//variants) into a single page and writes the same format back, so the game reads either one
+typedef struct{
+	char pages[ATLAS_MAX_PAGES][ATLAS_PATH_SIZE];
+	SDL_Color pageKeys[ATLAS_MAX_PAGES];
+	bool pageKeyed[ATLAS_MAX_PAGES];
+	TextureHandle textures[ATLAS_MAX_PAGES];
+	AtlasClip clips[ATLAS_MAX_CLIPS];
+	int nPages, nClips;
+} Atlas;
+
+bool readAtlas(Atlas* atlas, const char* path);
+bool writeAtlas(Atlas* atlas, const char* path);
+int addAtlasPage(Atlas* atlas, const char* path, SDL_Color* colorKey);
+AtlasClip* findAtlasClip(Atlas* atlas, const char* name, int level);
+void queueAtlas(AssetLoader* loader, Atlas* atlas);
+bool atlasLoaded(Atlas* atlas);
+bool addAtlasClip(Sprite* sprite, int index, Atlas* atlas, const char* name, int level, bool setRender);
+void releaseAtlas(Atlas* atlas);
+
+#endif
@@ -0,0 +1,362 @@
+#include "audioconvert.h"
+#include "engine.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CONVERT_SSE2 1
+#endif
+
+bool supportedConverterFormat(SDL_AudioFormat format);
+int greatestCommonDivisor(int a, int b);
+void buildResampleFilter(AudioConverter* conv);
+void samplesToFloat(const Uint8* in, SDL_AudioFormat format, float* out, int n);
+void floatToSamples(const float* in, SDL_AudioFormat format, Uint8* out, int n);
+void pushConverterInput(AudioConverter* conv, const Uint8* in, int frames);
+float resampleDot(const float* history, const float* coefs);
+
+/*PREPARE conv TO TURN in SPEC AUDIO INTO out SPEC AUDIO, FALSE (AND A PLAIN BYTE COPY) IF A FORMAT IS NOT SUPPORTED*/
+bool initAudioConverter(AudioConverter* conv, const SDL_AudioSpec* in, const SDL_AudioSpec* out)
+{
+	int divisor;
+
+	SDL_zerop(conv);
+	conv->inFormat = in->format;
+	conv->outFormat = out->format;
+	conv->inChannels = in->channels;
+	conv->outChannels = out->channels;
+	conv->inFreq = in->freq;
+	conv->outFreq = out->freq;
+	conv->inFrameSize = in->channels * (SDL_AUDIO_BITSIZE(in->format) / 8);
+	conv->outFrameSize = out->channels * (SDL_AUDIO_BITSIZE(out->format) / 8);
+
+	if(in->format == out->format && in->channels == out->channels && in->freq == out->freq){
+		conv->passthrough = true;
+		return true;
+	}
+
+	if(!supportedConverterFormat(in->format) || !supportedConverterFormat(out->format) || in->channels == 0 || out->channels == 0 ||
+		in->freq <= 0 || out->freq <= 0){
+		SDL_SetError("Unsupported audio conversion");
+		print_err("Could not convert recording to the playback format, playing it unconverted");
+		conv->passthrough = true;
+		conv->outFrameSize = conv->inFrameSize;
+		return false;
+	}
+
+	//output frame n sits at input frame n * inFreq / outFreq = n * step / phases
+	conv->resample = in->freq != out->freq;
+	divisor = greatestCommonDivisor(in->freq, out->freq);
+	conv->phases = out->freq / divisor;
+	conv->step = in->freq / divisor;
+	if(conv->phases > RESAMPLE_MAX_PHASES){ //awkward ratios: slightly off rate rather than a huge filter bank
+		conv->step = (int)((double)conv->step * RESAMPLE_MAX_PHASES / conv->phases + 0.5);
+		conv->phases = RESAMPLE_MAX_PHASES;
+	}
+
+	conv->historyCapacity = RESAMPLE_TAPS + CONVERTER_BLOCK_FRAMES;
+	conv->history = (float*)SDL_malloc(conv->outChannels * conv->historyCapacity * sizeof(float));
+	conv->scratch = (float*)SDL_malloc(CONVERTER_BLOCK_FRAMES * conv->inChannels * sizeof(float));
+	conv->outScratch = (float*)SDL_malloc(CONVERTER_BLOCK_FRAMES * conv->outChannels * sizeof(float));
+	conv->coefs = conv->resample ? (float*)SDL_malloc(conv->phases * RESAMPLE_TAPS * sizeof(float)) : NULL;
+
+	if(conv->history == NULL || conv->scratch == NULL || conv->outScratch == NULL || (conv->resample && conv->coefs == NULL)){
+		print_err("Could not allocate audio converter");
+		freeAudioConverter(conv);
+		conv->passthrough = true;
+		conv->outFrameSize = conv->inFrameSize;
+		return false;
+	}
+
+	if(conv->resample)
+		buildResampleFilter(conv);
+
+	resetAudioConverter(conv);
+
+	return true;
+}
+
+/*START A NEW STREAM: FORGET BUFFERED INPUT, PRIME THE FILTER WITH SILENCE SO OUTPUT STARTS ALIGNED WITH THE INPUT*/
+void resetAudioConverter(AudioConverter* conv)
+{
+	int c;
+
+	conv->phase = 0;
+	conv->position = 0;
+	conv->historyFrames = conv->resample ? RESAMPLE_TAPS/2 - 1 : 0;
+
+	for(c = 0; c < conv->outChannels && conv->history != NULL; c++)
+		SDL_memset(conv->history + c * conv->historyCapacity, 0, conv->historyFrames * sizeof(float));
+}
+
+void freeAudioConverter(AudioConverter* conv)
+{
+	SDL_free(conv->coefs);
+	SDL_free(conv->history);
+	SDL_free(conv->scratch);
+	SDL_free(conv->outScratch);
+	conv->coefs = conv->history = conv->scratch = conv->outScratch = NULL;
+}
+
+/*CONVERT FROM in (inLen BYTES) INTO out UNTIL outCapacity BYTES ARE WRITTEN OR THE INPUT RUNS OUT,
+RETURN BYTES WRITTEN AND SET consumed TO INPUT BYTES USED (THE REST IS FOR THE NEXT CALL)*/
+Uint32 convertAudio(AudioConverter* conv, const Uint8* in, Uint32 inLen, Uint8* out, Uint32 outCapacity, Uint32* consumed)
+{
+	int written = 0, pending = 0, maxOut = outCapacity / conv->outFrameSize, inFrames = inLen / conv->inFrameSize, used = 0;
+	int n, c, keep, taps = conv->resample ? RESAMPLE_TAPS : 1;
+	float *channel, *dst;
+
+	if(conv->passthrough){
+		n = (int)SDL_min(inLen, (Uint32)maxOut * conv->outFrameSize);
+		n -= n % conv->inFrameSize;
+		SDL_memcpy(out, in, n);
+		*consumed = n;
+		return n;
+	}
+
+	for(;;)
+	{
+		//drain what the history already allows, a float block at a time
+		while(written + pending < maxOut && conv->position + taps <= conv->historyFrames)
+		{
+			dst = conv->outScratch + pending * conv->outChannels;
+
+			for(c = 0; c < conv->outChannels; c++){
+				channel = conv->history + c * conv->historyCapacity + conv->position;
+				dst[c] = conv->resample ? resampleDot(channel, conv->coefs + conv->phase * RESAMPLE_TAPS) : *channel;
+			}
+
+			if(conv->resample){
+				conv->phase += conv->step;
+				conv->position += conv->phase / conv->phases;
+				conv->phase %= conv->phases;
+			}
+			else{
+				conv->position++;
+			}
+
+			if(++pending == CONVERTER_BLOCK_FRAMES){
+				floatToSamples(conv->outScratch, conv->outFormat, out + written * conv->outFrameSize, pending * conv->outChannels);
+				written += pending;
+				pending = 0;
+			}
+		}
+
+		if(written + pending == maxOut || used == inFrames)
+			break;
+
+		//slide unused frames to the front and refill the history with a block of input
+		keep = SDL_max(conv->historyFrames - conv->position, 0);
+		for(c = 0; c < conv->outChannels; c++){
+			channel = conv->history + c * conv->historyCapacity;
+			SDL_memmove(channel, channel + SDL_min(conv->position, conv->historyFrames), keep * sizeof(float));
+		}
+		conv->position -= conv->historyFrames - keep;
+		conv->historyFrames = keep;
+
+		n = SDL_min(SDL_min(inFrames - used, conv->historyCapacity - conv->historyFrames), CONVERTER_BLOCK_FRAMES);
+		if(n <= 0)
+			break;
+
+		pushConverterInput(conv, in + used * conv->inFrameSize, n);
+		used += n;
+	}
+
+	floatToSamples(conv->outScratch, conv->outFormat, out + written * conv->outFrameSize, pending * conv->outChannels);
+	written += pending;
+	*consumed = used * conv->inFrameSize;
+
+	return written * conv->outFrameSize;
+}
+
+/*CONVERT frames INPUT FRAMES TO FLOAT AND APPEND THEM TO THE PLANAR HISTORY, MAPPING CHANNELS (MONO DOWNMIX AVERAGES, UPMIX REPEATS THE LAST CHANNEL)*/
+void pushConverterInput(AudioConverter* conv, const Uint8* in, int frames)
+{
+	float *dst, sum;
+	int c, f, k;
+
+	samplesToFloat(in, conv->inFormat, conv->scratch, frames * conv->inChannels);
+
+	for(c = 0; c < conv->outChannels; c++)
+	{
+		dst = conv->history + c * conv->historyCapacity + conv->historyFrames;
+
+		if(conv->outChannels == 1 && conv->inChannels > 1){
+			for(f = 0; f < frames; f++){
+				sum = 0;
+				for(k = 0; k < conv->inChannels; k++)
+					sum += conv->scratch[f * conv->inChannels + k];
+				dst[f] = sum / conv->inChannels;
+			}
+		}
+		else{
+			k = SDL_min(c, conv->inChannels - 1);
+			for(f = 0; f < frames; f++)
+				dst[f] = conv->scratch[f * conv->inChannels + k];
+		}
+	}
+
+	conv->historyFrames += frames;
+}
+
+/*ONE POLYPHASE BRANCH: RESAMPLE_TAPS MULTIPLY-ADDS (4 LANES AT A TIME WITH SSE2)*/
+float resampleDot(const float* history, const float* coefs)
+{
+	float sum = 0;
+	int t = 0;
+
+#ifdef CONVERT_SSE2
+	__m128 acc = _mm_setzero_ps();
+	float lanes[4];
+
+	for(; t + 4 <= RESAMPLE_TAPS; t += 4)
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(history + t), _mm_loadu_ps(coefs + t)));
+
+	_mm_storeu_ps(lanes, acc);
+	sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+	for(; t < RESAMPLE_TAPS; t++)
+		sum += history[t] * coefs[t];
+
+	return sum;
+}
+
+/*BLACKMAN WINDOWED SINC BRANCHES, CUTOFF AT THE LOWER OF BOTH NYQUISTS*/
+void buildResampleFilter(AudioConverter* conv)
+{
+	double cutoff = SDL_min(1.0, (double)conv->outFreq / conv->inFreq) * 0.95;
+	double x, w, sum, half = RESAMPLE_TAPS / 2.0;
+	float *branch;
+	int p, t;
+
+	for(p = 0; p < conv->phases; p++)
+	{
+		branch = conv->coefs + p * RESAMPLE_TAPS;
+		sum = 0;
+
+		for(t = 0; t < RESAMPLE_TAPS; t++){
+			x = t - (RESAMPLE_TAPS/2 - 1) - (double)p / conv->phases; //distance from the output point
+			w = 0.42 + 0.5 * cos(M_PI * x / half) + 0.08 * cos(2 * M_PI * x / half);
+			branch[t] = (float)((x == 0 ? cutoff : sin(M_PI * cutoff * x) / (M_PI * x)) * w);
+			sum += branch[t];
+		}
+
+		for(t = 0; t < RESAMPLE_TAPS; t++)
+			branch[t] = (float)(branch[t] / sum);
+	}
+}
+
+/*n SAMPLES OF format TO FLOAT IN [-1, 1) (S16 WITH SSE2)*/
+void samplesToFloat(const Uint8* in, SDL_AudioFormat format, float* out, int n)
+{
+	int i = 0;
+	Sint16 s16;
+	Sint32 s32;
+
+	switch(format){
+	case AUDIO_F32SYS:
+		SDL_memcpy(out, in, n * sizeof(float));
+		break;
+	case AUDIO_S16SYS:
+#ifdef CONVERT_SSE2
+		{
+			const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+			__m128i s;
+
+			for(; i + 8 <= n; i += 8){
+				s = _mm_loadu_si128((const __m128i*)(in + i * sizeof(Sint16)));
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16)), scale));
+				_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16)), scale));
+			}
+		}
+#endif
+		for(; i < n; i++){
+			SDL_memcpy(&s16, in + i * sizeof(Sint16), sizeof(Sint16));
+			out[i] = s16 * (1.0f / 32768.0f);
+		}
+		break;
+	case AUDIO_S32SYS:
+		for(; i < n; i++){
+			SDL_memcpy(&s32, in + i * sizeof(Sint32), sizeof(Sint32));
+			out[i] = (float)s32 * (1.0f / 2147483648.0f);
+		}
+		break;
+	case AUDIO_S8:
+		for(; i < n; i++)
+			out[i] = (Sint8)in[i] * (1.0f / 128.0f);
+		break;
+	default: //AUDIO_U8
+		for(; i < n; i++)
+			out[i] = (in[i] - 128) * (1.0f / 128.0f);
+		break;
+	}
+}
+
+/*n FLOAT SAMPLES TO format, CLIPPED (S16 WITH SSE2)*/
+void floatToSamples(const float* in, SDL_AudioFormat format, Uint8* out, int n)
+{
+	int i = 0;
+	float f;
+	Sint16 s16;
+	Sint32 s32;
+
+	switch(format){
+	case AUDIO_F32SYS:
+		SDL_memcpy(out, in, n * sizeof(float));
+		break;
+	case AUDIO_S16SYS:
+#ifdef CONVERT_SSE2
+		{
+			const __m128 scale = _mm_set1_ps(32767.0f), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+
+			for(; i + 8 <= n; i += 8){
+				_mm_storeu_si128((__m128i*)(out + i * sizeof(Sint16)), _mm_packs_epi32(
+					_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), lo), hi)),
+					_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), lo), hi))));
+			}
+		}
+#endif
+		for(; i < n; i++){
+			f = SDL_min(SDL_max(in[i] * 32767.0f, -32768.0f), 32767.0f);
+			s16 = (Sint16)lrintf(f);
+			SDL_memcpy(out + i * sizeof(Sint16), &s16, sizeof(Sint16));
+		}
+		break;
+	case AUDIO_S32SYS:
+		for(; i < n; i++){
+			s32 = (Sint32)SDL_min(SDL_max(in[i] * 2147483647.0, -2147483648.0), 2147483647.0);
+			SDL_memcpy(out + i * sizeof(Sint32), &s32, sizeof(Sint32));
+		}
+		break;
+	case AUDIO_S8:
+		for(; i < n; i++)
+			out[i] = (Uint8)(Sint8)SDL_min(SDL_max(in[i] * 127.0f, -128.0f), 127.0f);
+		break;
+	default: //AUDIO_U8
+		for(; i < n; i++)
+			out[i] = (Uint8)(SDL_min(SDL_max(in[i] * 127.0f, -128.0f), 127.0f) + 128);
+		break;
+	}
+}
+
+bool supportedConverterFormat(SDL_AudioFormat format)
+{
+	return format == AUDIO_F32SYS || format == AUDIO_S16SYS || format == AUDIO_S32SYS || format == AUDIO_S8 || format == AUDIO_U8;
+}
+
+int greatestCommonDivisor(int a, int b)
+{
+	int t;
+
+	while(b != 0){
+		t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
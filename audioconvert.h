@@ -0,0 +1,37 @@
+#ifndef AUDIOCONVERT_H
+#define AUDIOCONVERT_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+
+#define RESAMPLE_TAPS 16            //FIR length per polyphase branch (multiple of 4)
+#define RESAMPLE_MAX_PHASES 1024    //rate ratios needing more branches are rounded to this many
+#define CONVERTER_BLOCK_FRAMES 256  //input frames converted to float per pass
+
+//streaming capture -> playback conversion: sample format to float, channel remap,
+//polyphase windowed sinc resampling, float to the output format
+typedef struct{
+	SDL_AudioFormat inFormat, outFormat;
+	int inChannels, outChannels;
+	int inFreq, outFreq;
+	int inFrameSize, outFrameSize;
+	bool passthrough;   //same spec (or unsupported formats): bytes are copied as they are
+	bool resample;
+	int phases;         //polyphase branches (L)
+	int step;           //branches advanced per output frame (M)
+	int phase;
+	float *coefs;       //phases * RESAMPLE_TAPS, each branch sums to 1
+	float *history;     //planar, outChannels * historyCapacity frames
+	int historyCapacity;
+	int historyFrames;  //valid frames in history
+	int position;       //first history frame of the next output
+	float *scratch;     //CONVERTER_BLOCK_FRAMES interleaved input frames as float
+	float *outScratch;  //CONVERTER_BLOCK_FRAMES interleaved output frames as float
+} AudioConverter;
+
+bool initAudioConverter(AudioConverter* conv, const SDL_AudioSpec* in, const SDL_AudioSpec* out);
+void resetAudioConverter(AudioConverter* conv);
+void freeAudioConverter(AudioConverter* conv);
+Uint32 convertAudio(AudioConverter* conv, const Uint8* in, Uint32 inLen, Uint8* out, Uint32 outCapacity, Uint32* consumed);
+
+#endif
@@ -0,0 +1,806 @@
+#include <stdlib.h>
+#include <time.h>
+#include "engine.h"
+#include "perf.h"
+#include "levelgen.h"
+#include "mixer.h"
+#include "audioconvert.h"
+#include "adpcm.h"
+#include "resources.h"
+
+#define BENCH_TILE_SHEET_PATH "imgs/tiles.png"
+#define BENCH_TEXT_BOX_PATH "imgs/txtbox.png"
+#define BENCH_FONT_PATH "fonts/slkscr.ttf"
+#define BENCH_FONT_SIZE 36
+#define BENCH_LEVEL_FILE "bench_level.map"
+#define BENCH_SEED 1234
+#define BENCH_MAZE_WALL_PERCENT 90
+#define BENCH_MIX_FREQ 44100
+#define BENCH_MIX_CALLBACK_FRAMES 2048 //the game's Mix_OpenAudio chunk size
+#define BENCH_CONVERT_CHUNK 4096      //output bytes per convertAudio call, as the playback feeder does
+#define BENCH_ANIMATE_DELAY 2         //pac's delay factor
+#define BENCH_ANIMATE_MAX_CLIPS 8
+
+#define BENCH_MIN_RUN_MS 100
+#define BENCH_REPETITIONS 5
+#define BENCH_MAX_PARAMS 8
+#define BENCH_DEFAULT_MAX_PARAM 1000000
+
+typedef struct{
+	const char *name;
+	const char *paramName;
+	bool (*setup)(int param);
+	void (*run)(int param, int iterations);
+	void (*teardown)(int param);
+	int params[BENCH_MAX_PARAMS];
+	int nParams;
+	bool squared; //param is a map side, --max-param caps param*param tiles
+} Benchmark;
+
+typedef struct{
+	int iterations;
+	double nsPerOp[BENCH_REPETITIONS];
+	double min, median, mean;
+} BenchResult;
+
+bool initBench();
+void closeBench();
+double measure(Benchmark* bench, int param, int iterations);
+BenchResult runBenchmark(Benchmark* bench, int param);
+void writeResult(FILE* out, Benchmark* bench, int param, BenchResult result, bool first);
+int compareDoubles(const void* a, const void* b);
+LevelSpec benchLevelSpec(int side);
+bool loadBenchMap(int side);
+void freeBenchMap();
+
+bool setupRects(int param);
+void runCheckCollision(int param, int iterations);
+void freeRects(int param);
+bool setupBoxSets(int param);
+void runCheckInnerBoxesCollisions(int param, int iterations);
+bool setupCircleSprites(int param);
+void runCheckCircularCollision(int param, int iterations);
+void freeCircleSprites(int param);
+bool setupTileMap(int param);
+void runCheckTileMapCollisions(int param, int iterations);
+void teardownTileMap(int param);
+bool setupLevelFile(int param);
+void runLoadTileMap(int param, int iterations);
+void teardownLevelFile(int param);
+void runRenderTileMap(int param, int iterations);
+void runAddSineWaveTexture(int param, int iterations);
+bool setupTextBox(int param);
+void runRenderTextBox(int param, int iterations);
+void teardownTextBox(int param);
+bool setupMixerVoices(int param);
+void runMixerCallback(int param, int iterations);
+void teardownMixerVoices(int param);
+bool setupConverter(int param);
+void runConvertAudio(int param, int iterations);
+void teardownConverter(int param);
+bool setupAdpcmClip(int param);
+void runAdpcmRoundTrip(int param, int iterations);
+void teardownAdpcmClip(int param);
+bool setupResources(int param);
+void runLoadResources(int param, int iterations);
+void teardownResources(int param);
+bool setupAnimatedSprite(int param);
+void runAnimate(int param, int iterations);
+void teardownAnimatedSprite(int param);
+
+SDL_Rect *rects = NULL;
+SDL_Rect *boxSetA = NULL, *boxSetB = NULL;
+Sprite *circleSprites = NULL;
+Sprite probe;
+Textbox benchTextBox;
+SDL_Rect tileClips[N_TILE_TYPES];
+Mixer benchMixer;
+Sound benchSound;
+Sint16 benchMixStream[BENCH_MIX_CALLBACK_FRAMES * 2];
+AudioConverter benchConverter;
+Uint8 benchConvertOut[BENCH_CONVERT_CHUNK];
+AdpcmClip benchClip;
+AdpcmEncoder benchEncoder;
+AdpcmDecoder benchDecoder;
+Sint16 *benchClipSamples = NULL;
+Sprite animatedSprite;
+SDL_Rect animatedClips[BENCH_ANIMATE_MAX_CLIPS];
+volatile int benchSink = 0;
+
+Benchmark benchmarks[] = {
+	{"checkCollision", "rects", setupRects, runCheckCollision, freeRects, {1000, 100000, 1000000, 10000000}, 4, false},
+	{"checkInnerBoxesCollisions", "boxes_per_set", setupBoxSets, runCheckInnerBoxesCollisions, freeRects, {1, 5, 16, 64, 256, 1024}, 6, false},
+	{"checkCircularCollision", "sprites", setupCircleSprites, runCheckCircularCollision, freeCircleSprites, {1000, 100000, 1000000, 4000000}, 4, false},
+	{"checkTileMapCollisions", "map_side", setupTileMap, runCheckTileMapCollisions, teardownTileMap, {11, 100, 316, 1000, 2000, 4000, 10000}, 7, true},
+	{"loadTileMap", "map_side", setupLevelFile, runLoadTileMap, teardownLevelFile, {11, 100, 316, 1000, 2000, 4000, 10000}, 7, true},
+	{"renderTileMap", "map_side", setupTileMap, runRenderTileMap, teardownTileMap, {11, 100, 316, 1000, 2000, 4000, 10000}, 7, true},
+	{"addSineWaveTexture", "map_side", setupTileMap, runAddSineWaveTexture, teardownTileMap, {11}, 1, true},
+	{"renderTextBox", "text_len", setupTextBox, runRenderTextBox, teardownTextBox, {3, 10, 19}, 3, false},
+	{"mixerCallback", "voices", setupMixerVoices, runMixerCallback, teardownMixerVoices, {1, 16, 64, 256, 512}, 5, false},
+	{"convertAudio", "out_freq", setupConverter, runConvertAudio, teardownConverter, {22050, 44100, 48000, 96000}, 4, false},
+	{"adpcmRoundTrip", "channels", setupAdpcmClip, runAdpcmRoundTrip, teardownAdpcmClip, {1, 2}, 2, false},
+	{"loadResources", "already_held", setupResources, runLoadResources, teardownResources, {0, 1}, 2, false},
+	{"animate", "clips", setupAnimatedSprite, runAnimate, teardownAnimatedSprite, {2, 3, 8}, 3, false}
+};
+
+/*RUN EVERY BENCHMARK (OR ONLY --filter NAME) FOR EACH PARAM UP TO --max-param ENTITIES/TILES (--large: NO CAP), PRINT JSON RESULTS TO STDOUT OR --out FILE*/
+int main(int argc, char** argv)
+{
+	const char *filter = NULL, *outPath = NULL;
+	int maxParam = BENCH_DEFAULT_MAX_PARAM;
+	int i, j, nBenchmarks = sizeof(benchmarks) / sizeof(Benchmark);
+	bool first = true;
+	FILE *out = stdout;
+	SDL_version version;
+	SDL_RendererInfo info;
+	BenchResult result;
+
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--filter") == 0 && i+1 < argc)
+			filter = argv[++i];
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outPath = argv[++i];
+		else if(strcmp(argv[i], "--max-param") == 0 && i+1 < argc)
+			maxParam = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--large") == 0)
+			maxParam = SDL_MAX_SINT32;
+		else{
+			fprintf(stderr, "usage: %s [--filter NAME] [--max-param N | --large] [--out FILE]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if(!initBench()){
+		fprintf(stderr, "Could not initialize benchmark environment\n");
+		closeBench();
+		return 1;
+	}
+
+	if(outPath != NULL && (out = fopen(outPath, "w")) == NULL){
+		fprintf(stderr, "Could not open %s\n", outPath);
+		closeBench();
+		return 1;
+	}
+
+	SDL_GetVersion(&version);
+	SDL_GetRendererInfo(renderer, &info);
+
+	fprintf(out, "{\n  \"context\": {\"sdl_version\": \"%d.%d.%d\", \"video_driver\": \"%s\", \"renderer\": \"%s\", \"cpu_count\": %d, \"timestamp\": %ld, \"min_run_ms\": %d, \"repetitions\": %d},\n  \"benchmarks\": [",
+		version.major, version.minor, version.patch, SDL_GetCurrentVideoDriver(), info.name, SDL_GetCPUCount(), (long)time(NULL), BENCH_MIN_RUN_MS, BENCH_REPETITIONS);
+
+	for(i = 0; i < nBenchmarks; i++)
+	{
+		if(filter != NULL && strcmp(filter, benchmarks[i].name) != 0)
+			continue;
+
+		for(j = 0; j < benchmarks[i].nParams && (benchmarks[i].squared ? (double)benchmarks[i].params[j] * benchmarks[i].params[j] : benchmarks[i].params[j]) <= maxParam; j++)
+		{
+			fprintf(stderr, "%s/%s=%d...", benchmarks[i].name, benchmarks[i].paramName, benchmarks[i].params[j]);
+
+			if(!benchmarks[i].setup(benchmarks[i].params[j])){
+				fprintf(stderr, " setup failed, skipped\n");
+				benchmarks[i].teardown(benchmarks[i].params[j]);
+				continue;
+			}
+
+			result = runBenchmark(&benchmarks[i], benchmarks[i].params[j]);
+			benchmarks[i].teardown(benchmarks[i].params[j]);
+
+			writeResult(out, &benchmarks[i], benchmarks[i].params[j], result, first);
+			first = false;
+			fprintf(stderr, " %.1f ns/op (median, %d iterations)\n", result.median, result.iterations);
+		}
+	}
+
+	fprintf(out, "\n  ]\n}\n");
+
+	if(out != stdout)
+		fclose(out);
+
+	closeBench();
+	return 0;
+}
+
+/*INIT SDL ON THE DUMMY VIDEO DRIVER (UNLESS OVERRIDDEN) WITH A SOFTWARE RENDERER AND LOAD SHARED BENCH ASSETS*/
+bool initBench()
+{
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+	if(SDL_Init(SDL_INIT_VIDEO) < 0){
+		print_err("Could not initialize SDL");
+		return false;
+	}
+
+	window = SDL_CreateWindow("bench", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_HIDDEN);
+	if(window == NULL){
+		print_err("Could not create window");
+		return false;
+	}
+
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+	if(renderer == NULL){
+		print_err("Could not create software renderer");
+		return false;
+	}
+
+	if(!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) || TTF_Init() == -1){
+		print_err("Could not initialize SDL_image/SDL_ttf");
+		return false;
+	}
+
+	camera = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect));
+	*camera = (SDL_Rect){0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+
+	textBoxFont = loadFontResource(&resources, BENCH_FONT_PATH, BENCH_FONT_SIZE);
+	textBoxSheet = loadTextureResource(&resources, BENCH_TEXT_BOX_PATH, NULL);
+	tileSheet = loadPixelTextureResource(&resources, BENCH_TILE_SHEET_PATH);
+
+	if(textBoxFont.id == 0 || textBoxSheet.id == 0 || tileSheet.id == 0)
+		return false;
+
+	tileClips[EMPTY] = (SDL_Rect){0, 0, getTexture(&resources, tileSheet)->w, getTexture(&resources, tileSheet)->h};
+	tileClips[STANDARD_BLOCK] = tileClips[EMPTY];
+
+	return true;
+}
+
+/*RELEASE BENCH ASSETS AND QUIT SDL*/
+void closeBench()
+{
+	releaseTexture(&resources, &textBoxSheet);
+	releaseTexture(&resources, &tileSheet);
+	releaseFont(&resources, &textBoxFont);
+	closeResourceManager(&resources, stderr);
+	SDL_free(camera);
+	freeLevelMemory();
+	SDL_DestroyRenderer(renderer);
+	SDL_DestroyWindow(window);
+	TTF_Quit();
+	IMG_Quit();
+	SDL_Quit();
+}
+
+/*TIME iterations RUNS OF bench, RETURN ELAPSED NANOSECONDS*/
+double measure(Benchmark* bench, int param, int iterations)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	bench->run(param, iterations);
+
+	return (double)(SDL_GetPerformanceCounter() - start) * 1e9 / SDL_GetPerformanceFrequency();
+}
+
+/*CALIBRATE ITERATIONS TO LAST AT LEAST BENCH_MIN_RUN_MS, THEN REPEAT BENCH_REPETITIONS TIMES AND REDUCE TO MIN/MEDIAN/MEAN NS PER OP*/
+BenchResult runBenchmark(Benchmark* bench, int param)
+{
+	BenchResult result;
+	double elapsed, sorted[BENCH_REPETITIONS];
+	int i;
+
+	result.iterations = 1;
+	elapsed = measure(bench, param, result.iterations);
+
+	while(elapsed < BENCH_MIN_RUN_MS * 1e6 && result.iterations < SDL_MAX_SINT32 / 10)
+	{
+		if(elapsed <= 0)
+			result.iterations *= 10;
+		else
+			result.iterations = (int)SDL_min((double)result.iterations * 10, result.iterations * (BENCH_MIN_RUN_MS * 1.2e6 / elapsed) + 1);
+
+		elapsed = measure(bench, param, result.iterations);
+	}
+
+	result.mean = 0;
+	for(i = 0; i < BENCH_REPETITIONS; i++){
+		result.nsPerOp[i] = measure(bench, param, result.iterations) / result.iterations;
+		sorted[i] = result.nsPerOp[i];
+		result.mean += result.nsPerOp[i] / BENCH_REPETITIONS;
+	}
+
+	qsort(sorted, BENCH_REPETITIONS, sizeof(double), compareDoubles);
+	result.min = sorted[0];
+	result.median = sorted[BENCH_REPETITIONS / 2];
+
+	return result;
+}
+
+/*WRITE ONE JSON RESULT OBJECT INTO THE "benchmarks" ARRAY*/
+void writeResult(FILE* out, Benchmark* bench, int param, BenchResult result, bool first)
+{
+	int i;
+
+	fprintf(out, "%s\n    {\"name\": \"%s\", \"param_name\": \"%s\", \"param\": %d, \"iterations\": %d, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, \"ns_per_op_mean\": %.3f, \"ns_per_op\": [",
+		first ? "" : ",", bench->name, bench->paramName, param, result.iterations, result.min, result.median, result.mean);
+
+	for(i = 0; i < BENCH_REPETITIONS; i++)
+		fprintf(out, "%s%.3f", i == 0 ? "" : ", ", result.nsPerOp[i]);
+
+	fprintf(out, "]}");
+}
+
+int compareDoubles(const void* a, const void* b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+/*FIXED SEED side x side MAZE, THE SAME MAP ON EVERY RUN*/
+LevelSpec benchLevelSpec(int side)
+{
+	LevelSpec spec = {LEVEL_MAZE, side, side, BENCH_MAZE_WALL_PERCENT, BENCH_SEED};
+
+	return spec;
+}
+
+/*BUILD GLOBAL map AS A side x side GENERATED MAZE*/
+bool loadBenchMap(int side)
+{
+	map = generateTileMap(benchLevelSpec(side), getTexture(&resources, tileSheet), tileClips, N_TILE_TYPES);
+
+	return map.tiles != NULL && map.size == side * side;
+}
+
+void freeBenchMap()
+{
+	freeTileMap(&map);
+	resetLevelMemory();
+}
+
+/*param RANDOM RECTS OF SPRITE-LIKE SIZES SCATTERED OVER THE LEVEL*/
+bool setupRects(int param)
+{
+	int i;
+
+	rects = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect) * param);
+	if(rects == NULL)
+		return false;
+
+	srand(BENCH_SEED);
+	for(i = 0; i < param; i++)
+		rects[i] = (SDL_Rect){rand() % LEVEL_WIDTH, rand() % LEVEL_HEIGHT, 10 + rand() % SHEET_STANDARD_SPRITE_SIZE, 10 + rand() % SHEET_STANDARD_SPRITE_SIZE};
+
+	return true;
+}
+
+/*TEST EACH RECT AGAINST ITS NEIGHBOUR, WALKING THE WHOLE SET*/
+void runCheckCollision(int param, int iterations)
+{
+	int i, index = 0, hits = 0;
+
+	for(i = 0; i < iterations; i++){
+		hits += checkCollision(rects[index], rects[index + 1 < param ? index + 1 : 0]);
+		index = index + 1 < param ? index + 1 : 0;
+	}
+
+	benchSink += hits;
+}
+
+void freeRects(int param)
+{
+	SDL_free(rects);
+	SDL_free(boxSetA);
+	SDL_free(boxSetB);
+	rects = boxSetA = boxSetB = NULL;
+}
+
+/*TWO DISJOINT BOX SETS OF param BOXES EACH (WORST CASE: EVERY PAIR IS TESTED)*/
+bool setupBoxSets(int param)
+{
+	int i;
+
+	boxSetA = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect) * param);
+	boxSetB = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect) * param);
+	if(boxSetA == NULL || boxSetB == NULL)
+		return false;
+
+	for(i = 0; i < param; i++){
+		boxSetA[i] = (SDL_Rect){i * 2, 0, 2, 15};
+		boxSetB[i] = (SDL_Rect){i * 2, 100, 2, 15};
+	}
+
+	return true;
+}
+
+void runCheckInnerBoxesCollisions(int param, int iterations)
+{
+	int i, hits = 0;
+
+	for(i = 0; i < iterations; i++)
+		hits += checkInnerBoxesCollisions(boxSetA, param, boxSetB, param);
+
+	benchSink += hits;
+}
+
+/*param SPRITES, EVEN ONES WITH CIRCULAR COLLIDERS (CIRCLE VS CIRCLE AND CIRCLE VS BOX PATHS)*/
+bool setupCircleSprites(int param)
+{
+	int i;
+
+	circleSprites = (Sprite*)SDL_calloc(param, sizeof(Sprite));
+	if(circleSprites == NULL)
+		return false;
+
+	srand(BENCH_SEED);
+	for(i = 0; i < param; i++){
+		circleSprites[i].collider = (SDL_Rect){rand() % LEVEL_WIDTH, rand() % LEVEL_HEIGHT, SHEET_STANDARD_SPRITE_SIZE, SHEET_STANDARD_SPRITE_SIZE};
+		circleSprites[i].circleCollider = (Circle){circleSprites[i].collider.x + 95, circleSprites[i].collider.y + 95, i % 2 == 0 ? 95 : 0};
+	}
+
+	return true;
+}
+
+void runCheckCircularCollision(int param, int iterations)
+{
+	int i, index = 0, hits = 0;
+
+	for(i = 0; i < iterations; i++){
+		hits += checkCircularCollision(circleSprites[index], circleSprites[index + 1 < param ? index + 1 : 0]);
+		index = index + 1 < param ? index + 1 : 0;
+	}
+
+	benchSink += hits;
+}
+
+void freeCircleSprites(int param)
+{
+	SDL_free(circleSprites);
+	circleSprites = NULL;
+}
+
+/*BUILD A param x param MAZE AND A SPRITE SIZED PROBE IN ITS MIDDLE*/
+bool setupTileMap(int param)
+{
+	SDL_zero(probe);
+	probe.collider = (SDL_Rect){(param / 2) * tileClips[EMPTY].w, (param / 2) * tileClips[EMPTY].h, SHEET_STANDARD_SPRITE_SIZE, SHEET_STANDARD_SPRITE_SIZE};
+
+	return loadBenchMap(param);
+}
+
+void runCheckTileMapCollisions(int param, int iterations)
+{
+	int i, hits = 0;
+
+	for(i = 0; i < iterations; i++)
+		hits += checkTileMapCollisions(probe);
+
+	benchSink += hits;
+}
+
+void teardownTileMap(int param)
+{
+	freeBenchMap();
+}
+
+bool setupLevelFile(int param)
+{
+	return generateLevelFile(benchLevelSpec(param), BENCH_LEVEL_FILE);
+}
+
+void runLoadTileMap(int param, int iterations)
+{
+	int i;
+
+	for(i = 0; i < iterations; i++){
+		map = loadTileMap(param * param, BENCH_LEVEL_FILE, getTexture(&resources, tileSheet), tileClips, N_TILE_TYPES);
+		benchSink += map.size;
+		freeBenchMap();
+	}
+}
+
+void teardownLevelFile(int param)
+{
+	remove(BENCH_LEVEL_FILE);
+}
+
+/*RENDER THE MAP FROM THE TOP-LEFT CAMERA, FLUSHING SO RASTERIZATION IS INCLUDED*/
+void runRenderTileMap(int param, int iterations)
+{
+	int i;
+
+	*camera = (SDL_Rect){0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+
+	for(i = 0; i < iterations; i++){
+		renderTileMap(map, camera);
+		SDL_RenderFlush(renderer);
+	}
+}
+
+void runAddSineWaveTexture(int param, int iterations)
+{
+	int i;
+
+	for(i = 0; i < iterations; i++)
+		addSineWaveTexture(&map, i);
+}
+
+/*TEXTBOX WITH A param CHARACTERS LONG TEXT (WRAPPED PAST THE BOX WIDTH)*/
+bool setupTextBox(int param)
+{
+	char text[TEXT_BOX_BUFFER_SIZE];
+	int i;
+
+	for(i = 0; i < param && i < TEXT_BOX_BUFFER_SIZE-1; i++)
+		text[i] = 'a' + (i % 26);
+	text[i] = '\0';
+
+	benchTextBox = loadTextBox(text, black);
+
+	return benchTextBox.layout.nLines > 0;
+}
+
+/*RENDER THE TEXTBOX THE WAY THE GAME DOES EVERY FRAME (POSITION RESET + RENDER), FLUSHED*/
+void runRenderTextBox(int param, int iterations)
+{
+	int i;
+
+	*camera = (SDL_Rect){0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+
+	for(i = 0; i < iterations; i++){
+		benchTextBox.x = 100;
+		benchTextBox.y = 300;
+		benchTextBox.h = SHEET_STANDARD_SPRITE_SIZE/2;
+		renderTextBox(&benchTextBox);
+		SDL_RenderFlush(renderer);
+	}
+}
+
+void teardownTextBox(int param)
+{
+	freeTextLayout(&benchTextBox.layout);
+	freeSprite(&benchTextBox.sprite);
+	resetLevelMemory();
+}
+
+/*param LOOPING VOICES OF A ONE SECOND NOISE SOUND ON A STEREO S16 MIXER, SPREAD OVER DIFFERENT GAINS AND OFFSETS*/
+bool setupMixerVoices(int param)
+{
+	Uint32 i;
+	int v;
+
+	if(!initMixer(&benchMixer, BENCH_MIX_FREQ, AUDIO_S16SYS, 2))
+		return false;
+
+	benchSound.frames = BENCH_MIX_FREQ;
+	benchSound.samples = (float*)SDL_malloc(benchSound.frames * 2 * sizeof(float));
+	if(benchSound.samples == NULL)
+		return false;
+
+	srand(BENCH_SEED);
+	for(i = 0; i < benchSound.frames * 2; i++)
+		benchSound.samples[i] = (rand() % 2001 - 1000) / 1000.0f;
+
+	for(v = 0; v < param; v++){
+		if(playSound(&benchMixer, &benchSound, (v % 10) / 10.0f, 1.0f - (v % 10) / 10.0f, true) < 0)
+			return false;
+	}
+
+	return true;
+}
+
+/*ONE POST MIX CALLBACK OF THE GAME'S CHUNK SIZE PER OP (NEEDS TO STAY WELL UNDER A MILLISECOND)*/
+void runMixerCallback(int param, int iterations)
+{
+	int i;
+
+	for(i = 0; i < iterations; i++){
+		SDL_memset(benchMixStream, 0, sizeof(benchMixStream));
+		mixerCallback(&benchMixer, (Uint8*)benchMixStream, sizeof(benchMixStream));
+	}
+
+	benchSink += benchMixStream[0];
+}
+
+void teardownMixerVoices(int param)
+{
+	closeMixer(&benchMixer);
+	freeSound(&benchSound);
+}
+
+/*CONVERTER FROM ONE SECOND OF STEREO F32 AT BENCH_MIX_FREQ (THE BENCH SOUND) TO STEREO S16 AT param HZ*/
+bool setupConverter(int param)
+{
+	SDL_AudioSpec in = {0}, out = {0};
+	Uint32 i;
+
+	in.freq = BENCH_MIX_FREQ;
+	in.format = AUDIO_F32SYS;
+	in.channels = 2;
+	out.freq = param;
+	out.format = AUDIO_S16SYS;
+	out.channels = 2;
+
+	if(!initAudioConverter(&benchConverter, &in, &out))
+		return false;
+
+	benchSound.frames = BENCH_MIX_FREQ;
+	benchSound.samples = (float*)SDL_malloc(benchSound.frames * 2 * sizeof(float));
+	if(benchSound.samples == NULL)
+		return false;
+
+	srand(BENCH_SEED);
+	for(i = 0; i < benchSound.frames * 2; i++)
+		benchSound.samples[i] = (rand() % 2001 - 1000) / 1000.0f;
+
+	return true;
+}
+
+/*CONVERT ONE SECOND OF AUDIO PER OP, SO NS/OP / 1E9 IS THE REAL TIME FACTOR (FRACTION OF A CORE KEPT BUSY)*/
+void runConvertAudio(int param, int iterations)
+{
+	const Uint8 *in;
+	Uint32 left, n, used;
+	int i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		resetAudioConverter(&benchConverter);
+		in = (const Uint8*)benchSound.samples;
+		left = benchSound.frames * 2 * sizeof(float);
+
+		while(left > 0)
+		{
+			n = convertAudio(&benchConverter, in, left, benchConvertOut, sizeof(benchConvertOut), &used);
+			if(n == 0 && used == 0)
+				break;
+
+			in += used;
+			left -= used;
+		}
+	}
+
+	benchSink += benchConvertOut[0];
+}
+
+void teardownConverter(int param)
+{
+	freeAudioConverter(&benchConverter);
+	freeSound(&benchSound);
+}
+
+/*ONE SECOND OF S16 NOISE WITH param CHANNELS AND AN ADPCM CLIP LARGE ENOUGH FOR IT*/
+bool setupAdpcmClip(int param)
+{
+	Uint32 i;
+
+	if(!initAdpcmClip(&benchClip, param, BENCH_MIX_FREQ, BENCH_MIX_FREQ))
+		return false;
+
+	benchClipSamples = (Sint16*)SDL_malloc(BENCH_MIX_FREQ * param * sizeof(Sint16));
+	if(benchClipSamples == NULL)
+		return false;
+
+	srand(BENCH_SEED);
+	for(i = 0; i < (Uint32)(BENCH_MIX_FREQ * param); i++)
+		benchClipSamples[i] = (Sint16)(rand() % 20001 - 10000);
+
+	return true;
+}
+
+/*ENCODE AND DECODE ONE SECOND OF AUDIO PER OP, SO NS/OP / 1E9 IS THE REAL TIME FACTOR OF THE CODEC*/
+void runAdpcmRoundTrip(int param, int iterations)
+{
+	Uint32 decoded;
+	int i;
+
+	for(i = 0; i < iterations; i++)
+	{
+		resetAdpcmClip(&benchClip, &benchEncoder);
+		encodeAdpcm(&benchEncoder, &benchClip, benchClipSamples, BENCH_MIX_FREQ);
+		flushAdpcmEncoder(&benchEncoder, &benchClip);
+
+		startAdpcmDecoder(&benchDecoder);
+		do{
+			decoded = decodeAdpcm(&benchDecoder, &benchClip, (Sint16*)benchConvertOut, sizeof(benchConvertOut) / (param * sizeof(Sint16)));
+		}while(decoded > 0);
+	}
+
+	benchSink += benchConvertOut[0] + benchClip.size;
+}
+
+void teardownAdpcmClip(int param)
+{
+	freeAdpcmClip(&benchClip);
+	SDL_free(benchClipSamples);
+	benchClipSamples = NULL;
+}
+
+/*LEVEL LOAD OF THE BENCH ASSETS (FONT, TEXT BOX SHEET, PIXEL STREAMING TILES) AND THEIR RELEASE; WITH param THE BENCH STILL
+ *HOLDS THEM, AS A RELOADED LEVEL WOULD, SO EVERY LOAD IS SHARED INSTEAD OF DECODED AND UPLOADED*/
+bool setupResources(int param)
+{
+	if(param == 0){ //drop the bench's own references so each load starts cold
+		releaseTexture(&resources, &textBoxSheet);
+		releaseTexture(&resources, &tileSheet);
+		releaseFont(&resources, &textBoxFont);
+	}
+
+	return true;
+}
+
+void runLoadResources(int param, int iterations)
+{
+	TextureHandle sheet, tiles;
+	FontHandle font;
+	int i;
+
+	for(i = 0; i < iterations; i++){
+		font = loadFontResource(&resources, BENCH_FONT_PATH, BENCH_FONT_SIZE);
+		sheet = loadTextureResource(&resources, BENCH_TEXT_BOX_PATH, NULL);
+		tiles = loadPixelTextureResource(&resources, BENCH_TILE_SHEET_PATH);
+
+		releaseTexture(&resources, &tiles);
+		releaseTexture(&resources, &sheet);
+		releaseFont(&resources, &font);
+	}
+}
+
+void teardownResources(int param)
+{
+	if(param == 0){
+		textBoxFont = loadFontResource(&resources, BENCH_FONT_PATH, BENCH_FONT_SIZE);
+		textBoxSheet = loadTextureResource(&resources, BENCH_TEXT_BOX_PATH, NULL);
+		tileSheet = loadPixelTextureResource(&resources, BENCH_TILE_SHEET_PATH);
+	}
+}
+
+/*A SPRITE OF param CLIPS, CHECKING FIRST THAT animate SHOWS THE SAME CLIP SEQUENCE AS IT ALWAYS HAS (EACH CLIP nClips*delay
+ *FRAMES, THE LAST ONE FRAME LONGER, THEN FRAME 0 AGAIN) AND THAT A FRAME COUNTED AHEAD OFF SCREEN COMES BACK INTO THAT CYCLE*/
+bool setupAnimatedSprite(int param)
+{
+	int i, expectedFrame = 0, expectedClip, cycle = param * param * BENCH_ANIMATE_DELAY;
+
+	SDL_zero(animatedSprite);
+	for(i = 0; i < param; i++)
+		animatedClips[i] = (SDL_Rect){i * SHEET_STANDARD_SPRITE_SIZE, 0, SHEET_STANDARD_SPRITE_SIZE, SHEET_STANDARD_SPRITE_SIZE};
+
+	animatedSprite.clips = animatedClips;
+	animatedSprite.nClips = param;
+
+	for(i = 0; i < 3 * cycle; i++)
+	{
+		expectedClip = expectedFrame / (param * BENCH_ANIMATE_DELAY);
+		if(expectedClip >= param){
+			expectedFrame = 0;
+			expectedClip = param - 1;
+		}
+
+		animate(&animatedSprite, BENCH_ANIMATE_DELAY);
+		if(animatedSprite.renderRect != &animatedClips[expectedClip] || animatedSprite.frame != expectedFrame){
+			SDL_SetError("animate frame %d: clip %d, expected %d", i, (int)(animatedSprite.renderRect - animatedClips), expectedClip);
+			print_err("animate changed its clip sequence");
+			return false;
+		}
+
+		animatedSprite.frame++;
+		expectedFrame++;
+	}
+
+	animatedSprite.frame = 1000 * cycle + param * BENCH_ANIMATE_DELAY;
+	animate(&animatedSprite, BENCH_ANIMATE_DELAY);
+	if(animatedSprite.frame > cycle || animatedSprite.renderRect != &animatedClips[1]){ //one clip into the cycle
+		SDL_SetError("frame %d after catching up", animatedSprite.frame);
+		print_err("animate didn't bring a frame counted ahead back into its cycle");
+		return false;
+	}
+
+	return true;
+}
+
+/*ONE ANIMATED FRAME PER OP*/
+void runAnimate(int param, int iterations)
+{
+	int i;
+
+	for(i = 0; i < iterations; i++){
+		animate(&animatedSprite, BENCH_ANIMATE_DELAY);
+		animatedSprite.frame++;
+	}
+
+	benchSink += animatedSprite.frame;
+}
+
+void teardownAnimatedSprite(int param)
+{
+	SDL_zero(animatedSprite);
+}
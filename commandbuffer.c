@@ -0,0 +1,560 @@
+#include "commandbuffer.h"
+#include "perf.h"
+
+RenderCommand* addRenderCommand(CommandBuffer* buffer, RenderCommandType type);
+void* copyCommandData(CommandBuffer* buffer, const void* data, size_t size);
+void replayRenderCommand(RenderCommand* command);
+void applyTextureSurface(Texture* texture, SDL_Surface* surface);
+void applyRenderTarget(Texture* target, int w, int h, float scale);
+int framePipelineThread(void* data);
+
+CommandBuffer *renderCommands = NULL;
+
+/*START AN EMPTY buffer*/
+void initCommandBuffer(CommandBuffer* buffer)
+{
+	SDL_zerop(buffer);
+}
+
+/*DROP EVERY COMMAND OF buffer (KEEPING ITS MEMORY), FREEING SURFACES THAT WERE NEVER REPLAYED*/
+void resetCommandBuffer(CommandBuffer* buffer)
+{
+	int i;
+
+	for(i = 0; i < buffer->nCommands; i++)
+	{
+		if(buffer->commands[i].type == RENDER_SET_SURFACE)
+			SDL_FreeSurface((SDL_Surface*)buffer->commands[i].data);
+	}
+
+	buffer->nCommands = 0;
+	arenaReset(&buffer->data);
+}
+
+/*ISSUE buffer'S COMMANDS ON renderer IN THE ORDER THEY WERE RECORDED (RENDERER THREAD ONLY)*/
+void replayCommandBuffer(CommandBuffer* buffer)
+{
+	int i;
+
+	for(i = 0; i < buffer->nCommands; i++)
+		replayRenderCommand(&buffer->commands[i]);
+}
+
+/*ISSUE command, RECORDED INTO ANOTHER BUFFER, ON renderCommands (ON THE RENDERER AT ONCE IF NULL) WITH ITS DATA COPIED.
+A SET SURFACE'S SURFACE MOVES ALONG, command NO LONGER OWNS IT*/
+void emitRenderCommand(RenderCommand* command)
+{
+	RenderCommand *copy;
+	size_t size = 0;
+
+	if(renderCommands == NULL){
+		replayRenderCommand(command);
+		return;
+	}
+
+	copy = addRenderCommand(renderCommands, command->type);
+	if(copy == NULL)
+		return;
+
+	*copy = *command;
+
+	switch(command->type)
+	{
+	case RENDER_FILL_RECTS:
+		size = command->count * sizeof(SDL_Rect);
+		break;
+	case RENDER_LINES:
+		size = command->count * sizeof(SDL_Point);
+		break;
+	case RENDER_GEOMETRY:
+		size = command->count * sizeof(SDL_Vertex);
+		break;
+	case RENDER_UPDATE_TEXTURE:
+		size = command->dst.h * command->count;
+		break;
+	default:
+		break;
+	}
+
+	if(size > 0){
+		copy->data = copyCommandData(renderCommands, command->data, size);
+		if(copy->data == NULL)
+			renderCommands->nCommands--;
+	}
+
+	if(command->type == RENDER_SET_SURFACE)
+		command->data = NULL;
+}
+
+/*ISSUE ONE RECORDED COMMAND ON renderer*/
+void replayRenderCommand(RenderCommand* command)
+{
+	switch(command->type)
+	{
+	case RENDER_CLEAR:
+		SDL_SetRenderDrawColor(renderer, command->color.r, command->color.g, command->color.b, command->color.a);
+		SDL_RenderClear(renderer);
+		break;
+	case RENDER_COPY:
+		SDL_RenderCopyEx(renderer, command->texture->texture, command->clipped ? &command->src : NULL, &command->dst,
+			command->angle, command->centered ? &command->center : NULL, command->flip);
+		break;
+	case RENDER_COLOR_MOD:
+		SDL_SetTextureColorMod(command->texture->texture, command->color.r, command->color.g, command->color.b);
+		break;
+	case RENDER_FILL_RECTS:
+		SDL_SetRenderDrawBlendMode(renderer, command->blend);
+		SDL_SetRenderDrawColor(renderer, command->color.r, command->color.g, command->color.b, command->color.a);
+		SDL_RenderFillRects(renderer, (SDL_Rect*)command->data, command->count);
+		break;
+	case RENDER_LINES:
+		SDL_SetRenderDrawBlendMode(renderer, command->blend);
+		SDL_SetRenderDrawColor(renderer, command->color.r, command->color.g, command->color.b, command->color.a);
+		SDL_RenderDrawLines(renderer, (SDL_Point*)command->data, command->count);
+		break;
+	case RENDER_GEOMETRY:
+		SDL_SetRenderDrawBlendMode(renderer, command->blend);
+		SDL_RenderGeometry(renderer, NULL, (SDL_Vertex*)command->data, command->count, NULL, 0);
+		break;
+	case RENDER_UPDATE_TEXTURE:
+		if(SDL_UpdateTexture(command->texture->texture, &command->dst, command->data, command->count) != 0)
+			print_err("Could not update texture");
+		break;
+	case RENDER_SET_SURFACE:
+		applyTextureSurface(command->texture, (SDL_Surface*)command->data);
+		command->data = NULL; //taken over
+		break;
+	case RENDER_SET_TARGET:
+		applyRenderTarget(command->texture, command->dst.w, command->dst.h, command->scale);
+		break;
+	case RENDER_SET_CLIP:
+		SDL_RenderSetClipRect(renderer, command->clipped ? &command->dst : NULL);
+		break;
+	}
+}
+
+/*RELEASE buffer'S MEMORY (AND SURFACES IT STILL HOLDS)*/
+void freeCommandBuffer(CommandBuffer* buffer)
+{
+	resetCommandBuffer(buffer);
+	arenaFree(&buffer->data);
+	SDL_free(buffer->commands);
+	SDL_zerop(buffer);
+}
+
+/*APPEND A ZEROED COMMAND OF type TO buffer, GROWING IT IF FULL (NULL IF OUT OF MEMORY)*/
+RenderCommand* addRenderCommand(CommandBuffer* buffer, RenderCommandType type)
+{
+	RenderCommand *commands, *command;
+
+	if(buffer->nCommands == buffer->capacity)
+	{
+		commands = (RenderCommand*)SDL_realloc(buffer->commands, (buffer->capacity + COMMAND_BUFFER_GROWTH) * sizeof(RenderCommand));
+		if(commands == NULL){
+			SDL_OutOfMemory();
+			print_err("Could not record render command");
+			return NULL;
+		}
+
+		buffer->commands = commands;
+		buffer->capacity += COMMAND_BUFFER_GROWTH;
+	}
+
+	command = &buffer->commands[buffer->nCommands++];
+	SDL_zerop(command);
+	command->type = type;
+
+	return command;
+}
+
+/*COPY size BYTES OF data INTO buffer'S ARENA, VALID UNTIL IT IS RESET*/
+void* copyCommandData(CommandBuffer* buffer, const void* data, size_t size)
+{
+	void *copy = arenaAlloc(&buffer->data, size);
+
+	if(copy == NULL){
+		print_err("Could not record render command data");
+		return NULL;
+	}
+
+	SDL_memcpy(copy, data, size);
+	return copy;
+}
+
+/*CLEAR THE WHOLE TARGET TO color*/
+void drawClear(SDL_Color color)
+{
+	RenderCommand *command;
+
+	if(renderCommands == NULL){
+		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderClear(renderer);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_CLEAR);
+	if(command != NULL)
+		command->color = color;
+}
+
+/*COPY clip OF texture (ALL OF IT IF NULL) TO dst, TURNED angle DEGREES AROUND center (dst'S CENTER IF NULL) AND FLIPPED*/
+void drawTexture(Texture* texture, SDL_Rect* clip, SDL_Rect dst, double angle, SDL_Point* center, SDL_RendererFlip flip)
+{
+	RenderCommand *command;
+
+	if(renderCommands == NULL){
+		SDL_RenderCopyEx(renderer, texture->texture, clip, &dst, angle, center, flip);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_COPY);
+	if(command == NULL)
+		return;
+
+	command->texture = texture;
+	command->dst = dst;
+	command->angle = angle;
+	command->flip = flip;
+
+	if(clip != NULL){
+		command->src = *clip;
+		command->clipped = true;
+	}
+
+	if(center != NULL){
+		command->center = *center;
+		command->centered = true;
+	}
+}
+
+/*TINT FOLLOWING COPIES OF texture BY color*/
+void drawTextureColorMod(Texture* texture, SDL_Color color)
+{
+	RenderCommand *command;
+
+	if(renderCommands == NULL){
+		SDL_SetTextureColorMod(texture->texture, color.r, color.g, color.b);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_COLOR_MOD);
+	if(command != NULL){
+		command->texture = texture;
+		command->color = color;
+	}
+}
+
+/*FILL n rects IN color (ALPHA INCLUDED) WITH blend*/
+void drawFillRects(const SDL_Rect* rects, int n, SDL_Color color, SDL_BlendMode blend)
+{
+	RenderCommand *command;
+
+	if(n <= 0)
+		return;
+
+	if(renderCommands == NULL){
+		SDL_SetRenderDrawBlendMode(renderer, blend);
+		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderFillRects(renderer, rects, n);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_FILL_RECTS);
+	if(command == NULL)
+		return;
+
+	command->color = color;
+	command->blend = blend;
+	command->data = copyCommandData(renderCommands, rects, n * sizeof(SDL_Rect));
+	command->count = command->data != NULL ? n : 0;
+}
+
+/*DRAW LINES JOINING n points IN color (ALPHA INCLUDED) WITH blend*/
+void drawLines(const SDL_Point* points, int n, SDL_Color color, SDL_BlendMode blend)
+{
+	RenderCommand *command;
+
+	if(n < 2)
+		return;
+
+	if(renderCommands == NULL){
+		SDL_SetRenderDrawBlendMode(renderer, blend);
+		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderDrawLines(renderer, points, n);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_LINES);
+	if(command == NULL)
+		return;
+
+	command->color = color;
+	command->blend = blend;
+	command->data = copyCommandData(renderCommands, points, n * sizeof(SDL_Point));
+	command->count = command->data != NULL ? n : 0;
+}
+
+/*DRAW n UNTEXTURED vertices (EVERY 3 A TRIANGLE, COLORED PER VERTEX) WITH blend*/
+void drawGeometry(const SDL_Vertex* vertices, int n, SDL_BlendMode blend)
+{
+	RenderCommand *command;
+
+	if(n < 3)
+		return;
+
+	if(renderCommands == NULL){
+		SDL_SetRenderDrawBlendMode(renderer, blend);
+		SDL_RenderGeometry(renderer, NULL, vertices, n, NULL, 0);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_GEOMETRY);
+	if(command == NULL)
+		return;
+
+	command->blend = blend;
+	command->data = copyCommandData(renderCommands, vertices, n * sizeof(SDL_Vertex));
+	command->count = command->data != NULL ? n : 0;
+}
+
+/*UPLOAD rect OF pixels (SAME SIZE AND FORMAT AS texture) TO texture, THE ROWS ARE COPIED IF THE UPLOAD IS RECORDED*/
+bool updateTextureRect(Texture* texture, SDL_Rect rect, SDL_Surface* pixels)
+{
+	RenderCommand *command;
+	Uint8 *rows, *source = (Uint8*)pixels->pixels + rect.y * pixels->pitch + rect.x * pixels->format->BytesPerPixel;
+	int row, rowSize = rect.w * pixels->format->BytesPerPixel;
+
+	if(renderCommands == NULL){
+		if(SDL_UpdateTexture(texture->texture, &rect, source, pixels->pitch) != 0){
+			print_err("Could not update texture");
+			return false;
+		}
+
+		perf.textureUploads++;
+		return true;
+	}
+
+	rows = (Uint8*)arenaAlloc(&renderCommands->data, rect.h * rowSize);
+	command = rows != NULL ? addRenderCommand(renderCommands, RENDER_UPDATE_TEXTURE) : NULL;
+	if(command == NULL){
+		print_err("Could not record texture update");
+		return false;
+	}
+
+	for(row = 0; row < rect.h; row++)
+		SDL_memcpy(rows + row * rowSize, source + row * pixels->pitch, rowSize);
+
+	command->texture = texture;
+	command->dst = rect;
+	command->data = rows;
+	command->count = rowSize;
+	perf.textureUploads++;
+
+	return true;
+}
+
+/*REPLACE texture WITH ONE MADE FROM surface (TAKEN OVER, NULL: JUST DESTROY IT). ITS SIZE CHANGES AT ONCE, THE SDL TEXTURE
+WHEN THE COMMAND IS REPLAYED, SO UNTIL THEN COPIES STILL RECORDED DRAW THE OLD ONE*/
+void setTextureSurface(Texture* texture, SDL_Surface* surface)
+{
+	RenderCommand *command;
+
+	texture->w = surface != NULL ? surface->w : 0;
+	texture->h = surface != NULL ? surface->h : 0;
+
+	if(surface != NULL)
+		perf.textureUploads++;
+
+	if(renderCommands == NULL){
+		applyTextureSurface(texture, surface);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_SET_SURFACE);
+	if(command == NULL){
+		SDL_FreeSurface(surface);
+		return;
+	}
+
+	command->texture = texture;
+	command->data = surface;
+}
+
+/*DESTROY texture'S SDL TEXTURE AND CREATE IT AGAIN FROM surface (FREED AFTERWARDS, NULL: LEAVE IT EMPTY)*/
+void applyTextureSurface(Texture* texture, SDL_Surface* surface)
+{
+	if(texture->texture != NULL)
+		SDL_DestroyTexture(texture->texture);
+	texture->texture = NULL;
+
+	if(surface == NULL)
+		return;
+
+	texture->texture = SDL_CreateTextureFromSurface(renderer, surface);
+	if(texture->texture == NULL)
+		print_err("Unable to load texture from surface");
+
+	SDL_FreeSurface(surface);
+}
+
+/*DRAW WHAT FOLLOWS INTO target (NULL: THE WINDOW) SCALED BY scale. target IS CREATED, OR GROWN TO AT LEAST w x h, WHEN THE
+COMMAND IS REPLAYED; ITS w/h BELONG TO THE RENDERER THREAD. IF IT CAN'T BE MADE THE DRAWS GO TO THE WINDOW UNSCALED*/
+void drawSetTarget(Texture* target, int w, int h, float scale)
+{
+	RenderCommand *command;
+
+	if(renderCommands == NULL){
+		applyRenderTarget(target, w, h, scale);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_SET_TARGET);
+	if(command != NULL){
+		command->texture = target;
+		command->dst.w = w;
+		command->dst.h = h;
+		command->scale = scale;
+	}
+}
+
+/*LIMIT FOLLOWING DRAWS TO rect (NULL: THE WHOLE TARGET)*/
+void drawSetClip(const SDL_Rect* rect)
+{
+	RenderCommand *command;
+
+	if(renderCommands == NULL){
+		SDL_RenderSetClipRect(renderer, rect);
+		return;
+	}
+
+	command = addRenderCommand(renderCommands, RENDER_SET_CLIP);
+	if(command != NULL && rect != NULL){
+		command->dst = *rect;
+		command->clipped = true;
+	}
+}
+
+/*SWITCH THE RENDERER TO target (SEE drawSetTarget)*/
+void applyRenderTarget(Texture* target, int w, int h, float scale)
+{
+	if(target != NULL && (target->texture == NULL || target->w < w || target->h < h))
+	{
+		if(target->texture != NULL)
+			SDL_DestroyTexture(target->texture);
+
+		target->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+		target->w = target->texture != NULL ? w : 0;
+		target->h = target->texture != NULL ? h : 0;
+
+		if(target->texture == NULL)
+			print_err("Could not create render target");
+		else
+			SDL_SetTextureScaleMode(target->texture, SDL_ScaleModeLinear); //smooth upscale
+	}
+
+	if(target != NULL && target->texture == NULL){
+		target = NULL;
+		scale = 1;
+	}
+
+	if(SDL_SetRenderTarget(renderer, target != NULL ? target->texture : NULL) != 0){
+		print_err("Could not set render target");
+		scale = 1;
+	}
+
+	SDL_RenderSetScale(renderer, scale, scale);
+}
+
+/*START step ON ITS OWN THREAD, IDLE UNTIL THE FIRST swapFramePipeline*/
+bool startFramePipeline(FramePipeline* pipeline, FrameStep step, void* data)
+{
+	SDL_zerop(pipeline);
+	initCommandBuffer(&pipeline->buffers[0]);
+	initCommandBuffer(&pipeline->buffers[1]);
+	pipeline->step = step;
+	pipeline->data = data;
+	pipeline->running = true;
+
+	pipeline->go = SDL_CreateSemaphore(0);
+	pipeline->done = SDL_CreateSemaphore(0);
+	if(pipeline->go != NULL && pipeline->done != NULL)
+		pipeline->thread = SDL_CreateThread(framePipelineThread, "simulation", pipeline);
+
+	if(pipeline->thread == NULL){
+		print_err("Could not start simulation thread");
+		if(pipeline->go != NULL)
+			SDL_DestroySemaphore(pipeline->go);
+		if(pipeline->done != NULL)
+			SDL_DestroySemaphore(pipeline->done);
+		SDL_zerop(pipeline);
+		return false;
+	}
+
+	return true;
+}
+
+/*WAIT FOR THE FRAME BEING RECORDED (IF ANY), AFTER THIS THE SIMULATION IS IDLE UNTIL THE NEXT SWAP. FALSE ONCE step ASKED TO STOP*/
+bool syncFramePipeline(FramePipeline* pipeline)
+{
+	if(pipeline->busy){
+		SDL_SemWait(pipeline->done);
+		pipeline->busy = false;
+	}
+
+	return pipeline->running;
+}
+
+/*START RECORDING THE NEXT FRAME INTO ONE BUFFER AND REPLAY THE ONE JUST RECORDED FROM THE OTHER (CALLER PRESENTS)*/
+void swapFramePipeline(FramePipeline* pipeline)
+{
+	CommandBuffer *recorded;
+
+	syncFramePipeline(pipeline);
+
+	recorded = &pipeline->buffers[pipeline->recording];
+	pipeline->recording ^= 1;
+	pipeline->busy = true;
+	SDL_SemPost(pipeline->go);
+
+	replayCommandBuffer(recorded);
+}
+
+/*FINISH THE FRAME BEING RECORDED, STOP THE SIMULATION THREAD AND FREE BOTH BUFFERS (WHAT WASN'T REPLAYED IS DROPPED)*/
+void stopFramePipeline(FramePipeline* pipeline)
+{
+	if(pipeline->thread == NULL)
+		return;
+
+	syncFramePipeline(pipeline);
+	pipeline->stop = true;
+	SDL_SemPost(pipeline->go);
+	SDL_WaitThread(pipeline->thread, NULL);
+
+	SDL_DestroySemaphore(pipeline->go);
+	SDL_DestroySemaphore(pipeline->done);
+	freeCommandBuffer(&pipeline->buffers[0]);
+	freeCommandBuffer(&pipeline->buffers[1]);
+	pipeline->thread = NULL;
+	renderCommands = NULL;
+}
+
+/*SIMULATION THREAD: RECORD ONE FRAME PER go INTO THE BUFFER NOT BEING REPLAYED*/
+int framePipelineThread(void* data)
+{
+	FramePipeline *pipeline = (FramePipeline*)data;
+
+	SDL_SemWait(pipeline->go);
+
+	while(!pipeline->stop)
+	{
+		renderCommands = &pipeline->buffers[pipeline->recording];
+		resetCommandBuffer(renderCommands);
+
+		pipeline->running = pipeline->step(pipeline->data);
+
+		SDL_SemPost(pipeline->done);
+		SDL_SemWait(pipeline->go);
+	}
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef COMMANDBUFFER_H
+#define COMMANDBUFFER_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "engine.h"
+#include "alloc.h"
+
+#define COMMAND_BUFFER_GROWTH 256 //commands added each time a buffer runs out of room
+
+typedef enum
+{
+	RENDER_CLEAR,
+	RENDER_COPY,
+	RENDER_COLOR_MOD,
+	RENDER_FILL_RECTS,
+	RENDER_LINES,
+	RENDER_GEOMETRY,
+	RENDER_UPDATE_TEXTURE,
+	RENDER_SET_SURFACE,
+	RENDER_SET_TARGET,
+	RENDER_SET_CLIP
+} RenderCommandType;
+
+//one recorded renderer call, everything it needs copied in except the Texture, whose SDL texture is looked up when replayed
+typedef struct{
+	RenderCommandType type;
+	Texture *texture;
+	SDL_Rect src, dst;      //copy: clip (if clipped) and destination, update: texture rect, set target: its minimum size,
+	                        //set clip: the clip rect (if clipped)
+	bool clipped, centered;
+	double angle;
+	SDL_Point center;
+	SDL_RendererFlip flip;
+	SDL_Color color;        //clear/fill/lines draw color, color mod
+	SDL_BlendMode blend;
+	float scale;            //set target: render scale
+	void *data;             //rects/points/vertices/pixels in the buffer's arena, set surface: the surface (owned until replayed)
+	int count;              //rects/points/vertices, update: pitch of data
+} RenderCommand;
+
+//render calls of one frame, recorded by the simulation and replayed on the thread that owns the renderer
+typedef struct{
+	RenderCommand *commands;
+	int nCommands, capacity;
+	Arena data;
+} CommandBuffer;
+
+typedef bool (*FrameStep)(void* data); //simulate and record one frame, false to stop
+
+//runs step on its own thread one frame ahead of the renderer: while it records frame N+1 into one buffer the
+//main thread replays frame N from the other and waits out the vsync in SDL_RenderPresent
+typedef struct{
+	SDL_Thread *thread;
+	CommandBuffer buffers[2];
+	int recording;          //buffer step fills, the other one is replayed
+	FrameStep step;
+	void *data;
+	SDL_sem *go;            //main -> simulation: record the next frame (or finish if stop)
+	SDL_sem *done;          //simulation -> main: frame recorded
+	bool busy;              //main thread only: a frame is being recorded
+	bool running;           //last step wanted more frames, read after done
+	bool stop;
+} FramePipeline;
+
+void initCommandBuffer(CommandBuffer* buffer);
+void resetCommandBuffer(CommandBuffer* buffer);
+void replayCommandBuffer(CommandBuffer* buffer);
+void emitRenderCommand(RenderCommand* command);
+void freeCommandBuffer(CommandBuffer* buffer);
+
+void drawClear(SDL_Color color);
+void drawTexture(Texture* texture, SDL_Rect* clip, SDL_Rect dst, double angle, SDL_Point* center, SDL_RendererFlip flip);
+void drawTextureColorMod(Texture* texture, SDL_Color color);
+void drawFillRects(const SDL_Rect* rects, int n, SDL_Color color, SDL_BlendMode blend);
+void drawLines(const SDL_Point* points, int n, SDL_Color color, SDL_BlendMode blend);
+void drawGeometry(const SDL_Vertex* vertices, int n, SDL_BlendMode blend);
+bool updateTextureRect(Texture* texture, SDL_Rect rect, SDL_Surface* pixels);
+void setTextureSurface(Texture* texture, SDL_Surface* surface);
+void drawSetTarget(Texture* target, int w, int h, float scale);
+void drawSetClip(const SDL_Rect* rect);
+
+bool startFramePipeline(FramePipeline* pipeline, FrameStep step, void* data);
+bool syncFramePipeline(FramePipeline* pipeline);
+void swapFramePipeline(FramePipeline* pipeline);
+void stopFramePipeline(FramePipeline* pipeline);
+
+extern CommandBuffer *renderCommands; //NULL: draw calls go straight to the renderer
+
+#endif
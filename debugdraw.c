@@ -0,0 +1,174 @@
+#include "debugdraw.h"
+#include "commandbuffer.h"
+#include "perf.h"
+
+#ifdef DEBUG_DRAW
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+DebugBatch* getDebugBatch(SDL_Color color);
+void addDebugQuad(float x0, float y0, float x1, float y1, SDL_Color color);
+
+DebugDraw debugDraw = {true, {{{0, 0, 0, 0}, NULL, 0, 0}}, 0, NULL, 0, 0};
+
+/*QUEUE A FILLED rect IN color (ALPHA INCLUDED)*/
+void debugRect(SDL_Rect rect, SDL_Color color)
+{
+	DebugBatch *batch;
+	SDL_Rect *rects;
+
+	if(!debugDraw.enabled)
+		return;
+
+	batch = getDebugBatch(color);
+
+	if(batch->nRects == batch->capacity)
+	{
+		rects = (SDL_Rect*)SDL_realloc(batch->rects, (batch->capacity > 0 ? 2 * batch->capacity : 64) * sizeof(SDL_Rect));
+		if(rects == NULL){
+			print_err("Could not queue debug rect");
+			return;
+		}
+
+		batch->rects = rects;
+		batch->capacity = batch->capacity > 0 ? 2 * batch->capacity : 64;
+	}
+
+	batch->rects[batch->nRects++] = rect;
+}
+
+/*QUEUE A ONE PIXEL WIDE LINE FROM a TO b IN color*/
+void debugLine(SDL_Point a, SDL_Point b, SDL_Color color)
+{
+	if(debugDraw.enabled)
+		addDebugQuad(a.x + 0.5f, a.y + 0.5f, b.x + 0.5f, b.y + 0.5f, color);
+}
+
+/*QUEUE circle'S OUTLINE IN color (DEBUG_DRAW_CIRCLE_SEGMENTS LINES)*/
+void debugCircle(Circle circle, SDL_Color color)
+{
+	float x0, y0, x1, y1;
+	int i;
+
+	if(!debugDraw.enabled || circle.r <= 0)
+		return;
+
+	x0 = circle.x + circle.r + 0.5f;
+	y0 = circle.y + 0.5f;
+
+	for(i = 1; i <= DEBUG_DRAW_CIRCLE_SEGMENTS; i++)
+	{
+		x1 = circle.x + circle.r * (float)cos(i * 2 * M_PI / DEBUG_DRAW_CIRCLE_SEGMENTS) + 0.5f;
+		y1 = circle.y + circle.r * (float)sin(i * 2 * M_PI / DEBUG_DRAW_CIRCLE_SEGMENTS) + 0.5f;
+		addDebugQuad(x0, y0, x1, y1, color);
+		x0 = x1;
+		y0 = y1;
+	}
+}
+
+/*DRAW EVERYTHING QUEUED SINCE THE LAST FLUSH (ONE FILL PER COLOR, ONE GEOMETRY CALL FOR ALL LINES) AND EMPTY THE QUEUE*/
+void flushDebugDraw()
+{
+	int i;
+
+	for(i = 0; i < debugDraw.nBatches; i++)
+	{
+		if(debugDraw.batches[i].nRects == 0)
+			continue;
+
+		drawFillRects(debugDraw.batches[i].rects, debugDraw.batches[i].nRects, debugDraw.batches[i].color, SDL_BLENDMODE_BLEND);
+		debugDraw.batches[i].nRects = 0;
+		perf.drawCalls++;
+	}
+
+	if(debugDraw.nVertices > 0){
+		drawGeometry(debugDraw.vertices, debugDraw.nVertices, SDL_BLENDMODE_BLEND);
+		debugDraw.nVertices = 0;
+		perf.drawCalls++;
+	}
+
+	//colors are matched again every frame, the batches (and their memory) stay
+	debugDraw.nBatches = 0;
+}
+
+/*TURN THE DEBUG OVERLAY ON/OFF (NOTHING IS QUEUED WHILE IT IS OFF)*/
+void toggleDebugDraw()
+{
+	debugDraw.enabled = !debugDraw.enabled;
+}
+
+/*RELEASE THE QUEUE'S MEMORY*/
+void freeDebugDraw()
+{
+	int i;
+
+	for(i = 0; i < DEBUG_DRAW_MAX_COLORS; i++)
+		SDL_free(debugDraw.batches[i].rects);
+
+	SDL_free(debugDraw.vertices);
+	SDL_zero(debugDraw);
+}
+
+/*FIND OR START THE BATCH OF color (THE LAST ONE TAKES EVERY COLOR PAST DEBUG_DRAW_MAX_COLORS)*/
+DebugBatch* getDebugBatch(SDL_Color color)
+{
+	DebugBatch *batch;
+	int i;
+
+	for(i = 0; i < debugDraw.nBatches; i++)
+	{
+		batch = &debugDraw.batches[i];
+		if(batch->color.r == color.r && batch->color.g == color.g && batch->color.b == color.b && batch->color.a == color.a)
+			return batch;
+	}
+
+	if(debugDraw.nBatches == DEBUG_DRAW_MAX_COLORS)
+		return &debugDraw.batches[DEBUG_DRAW_MAX_COLORS - 1];
+
+	batch = &debugDraw.batches[debugDraw.nBatches++];
+	batch->color = color;
+	batch->nRects = 0;
+
+	return batch;
+}
+
+/*QUEUE THE LINE (x0,y0)-(x1,y1) AS TWO TRIANGLES ONE PIXEL ACROSS*/
+void addDebugQuad(float x0, float y0, float x1, float y1, SDL_Color color)
+{
+	SDL_Vertex *vertices, *v;
+	float dx = x1 - x0, dy = y1 - y0, length = (float)sqrt(dx*dx + dy*dy), nx, ny;
+
+	if(debugDraw.nVertices + 6 > debugDraw.capacity)
+	{
+		vertices = (SDL_Vertex*)SDL_realloc(debugDraw.vertices, (debugDraw.capacity > 0 ? 2 * debugDraw.capacity : 384) * sizeof(SDL_Vertex));
+		if(vertices == NULL){
+			print_err("Could not queue debug line");
+			return;
+		}
+
+		debugDraw.vertices = vertices;
+		debugDraw.capacity = debugDraw.capacity > 0 ? 2 * debugDraw.capacity : 384;
+	}
+
+	//half a pixel to each side of the line, a point still gets a pixel
+	if(length == 0){
+		x1 += 1;
+		dx = length = 1;
+	}
+
+	nx = -dy / length * 0.5f;
+	ny = dx / length * 0.5f;
+
+	v = &debugDraw.vertices[debugDraw.nVertices];
+	v[0] = (SDL_Vertex){{x0 + nx, y0 + ny}, color, {0, 0}};
+	v[1] = (SDL_Vertex){{x0 - nx, y0 - ny}, color, {0, 0}};
+	v[2] = (SDL_Vertex){{x1 + nx, y1 + ny}, color, {0, 0}};
+	v[3] = v[1];
+	v[4] = v[2];
+	v[5] = (SDL_Vertex){{x1 - nx, y1 - ny}, color, {0, 0}};
+	debugDraw.nVertices += 6;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "engine.h"
+
+//debug overlay, compiled out (every call below does nothing) when NDEBUG is defined, i.e. make release
+#ifndef NDEBUG
+#define DEBUG_DRAW
+#endif
+
+#define DEBUG_DRAW_MAX_COLORS 16     //color/alpha batches per frame, further colors share the last one
+#define DEBUG_DRAW_CIRCLE_SEGMENTS 24
+
+//one color/alpha worth of filled rects, flushed with a single SDL_RenderFillRects
+typedef struct{
+	SDL_Color color;
+	SDL_Rect *rects;
+	int nRects, capacity;
+} DebugBatch;
+
+//shapes queued during the frame (screen space), flushed at once: rects per batch, lines and circle outlines
+//as one pixel wide quads in a single SDL_RenderGeometry carrying their colors per vertex
+typedef struct{
+	bool enabled;
+	DebugBatch batches[DEBUG_DRAW_MAX_COLORS];
+	int nBatches;
+	SDL_Vertex *vertices;
+	int nVertices, capacity;
+} DebugDraw;
+
+#ifdef DEBUG_DRAW
+
+void debugRect(SDL_Rect rect, SDL_Color color);
+void debugLine(SDL_Point a, SDL_Point b, SDL_Color color);
+void debugCircle(Circle circle, SDL_Color color);
+void flushDebugDraw();
+void toggleDebugDraw();
+void freeDebugDraw();
+
+extern DebugDraw debugDraw;
+
+#else
+
+static inline void debugRect(SDL_Rect rect, SDL_Color color){}
+static inline void debugLine(SDL_Point a, SDL_Point b, SDL_Color color){}
+static inline void debugCircle(Circle circle, SDL_Color color){}
+static inline void flushDebugDraw(){}
+static inline void toggleDebugDraw(){}
+static inline void freeDebugDraw(){}
+
+#endif
+
+#endif
@@ -0,0 +1,466 @@
+#include "dirtyrect.h"
+#include "perf.h"
+
+//texture rect uploaded during the scene, copies reading from it changed even if the copy itself didn't
+typedef struct{
+	Texture *texture;
+	SDL_Rect rect;
+} DirtyUpload;
+
+bool measureScene(DirtyRegions* dirty, SDL_Rect screen);
+SDL_Rect commandBounds(const RenderCommand* command, SDL_Rect screen);
+Uint64 hashBytes(Uint64 hash, const void* data, size_t size);
+Uint64 hashCommand(const RenderCommand* command, const SDL_Color* tint);
+int compareDirtyRecords(const void* a, const void* b);
+void diffDirtyRecords(DirtyRegions* dirty, SDL_Rect screen);
+void addDamage(DirtyRegions* dirty, SDL_Rect rect, SDL_Rect screen);
+bool growDirtyArray(void** array, int* capacity, int needed, size_t size);
+
+/*START dirty WITH NOTHING KEPT (DISABLED, OR IF THE RENDERER CAN'T DRAW TO TEXTURES: THE SCENE IS DRAWN AS IT IS RECORDED)*/
+void initDirtyRegions(DirtyRegions* dirty, bool enabled)
+{
+	SDL_zerop(dirty);
+	initCommandBuffer(&dirty->scene);
+	dirty->enabled = enabled && SDL_RenderTargetSupported(renderer);
+	dirty->invalid = true;
+}
+
+/*REDRAW THE WHOLE SCENE NEXT FRAME (THE KEPT TARGET'S CONTENTS WERE LOST)*/
+void invalidateDirtyRegions(DirtyRegions* dirty)
+{
+	dirty->invalid = true;
+}
+
+/*RECORD THE SCENE DRAWN FROM HERE ON INSTEAD OF SENDING IT ON*/
+void beginDirtyScene(DirtyRegions* dirty)
+{
+	if(!dirty->enabled)
+		return;
+
+	dirty->outer = renderCommands;
+	dirty->drawCalls = perf.drawCalls;
+	resetCommandBuffer(&dirty->scene);
+	renderCommands = &dirty->scene;
+}
+
+/*FIND WHAT CHANGED SINCE THE LAST FRAME, REDRAW ONLY THAT INTO THE KEPT TARGET (ONE CLIPPED PASS OVER THE SCENE PER
+DAMAGED REGION) AND COPY THE TARGET TO THE WINDOW*/
+void endDirtyScene(DirtyRegions* dirty, SDL_Rect* camera)
+{
+	CommandBuffer *scene = &dirty->scene;
+	RenderCommand *command;
+	SDL_Rect screen = {0, 0, camera->w, camera->h}, *rect;
+	int i, r, area = 0, emitted = 0;
+	bool measured;
+
+	if(!dirty->enabled)
+		return;
+
+	renderCommands = dirty->outer;
+	dirty->nRects = 0;
+
+	measured = measureScene(dirty, screen);
+	if(measured && !dirty->invalid && dirty->w == screen.w && dirty->h == screen.h)
+		diffDirtyRecords(dirty, screen);
+	else
+		addDamage(dirty, screen, screen);
+
+	for(i = 0; i < dirty->nRects; i++)
+		area += dirty->rects[i].w * dirty->rects[i].h;
+
+	if(area * 100 > screen.w * screen.h * DIRTY_FULL_PERCENT){
+		dirty->rects[0] = screen;
+		dirty->nRects = 1;
+		area = screen.w * screen.h;
+	}
+
+	dirty->redrawnPercent = screen.w * screen.h > 0 ? area * 100 / (screen.w * screen.h) : 0;
+
+	drawSetTarget(&dirty->target, screen.w, screen.h, 1);
+
+	//uploads once, ahead of every pass: a texture isn't drawn before it is uploaded in the same scene
+	for(i = 0; i < scene->nCommands; i++)
+	{
+		if(scene->commands[i].type == RENDER_UPDATE_TEXTURE || scene->commands[i].type == RENDER_SET_SURFACE)
+			emitRenderCommand(&scene->commands[i]);
+	}
+
+	for(r = 0; r < dirty->nRects; r++)
+	{
+		rect = &dirty->rects[r];
+		drawSetClip(rect);
+
+		for(i = 0; i < scene->nCommands; i++)
+		{
+			command = &scene->commands[i];
+
+			switch(command->type)
+			{
+			case RENDER_CLEAR:
+				drawFillRects(rect, 1, command->color, SDL_BLENDMODE_NONE); //SDL_RenderClear ignores the clip rect
+				break;
+			case RENDER_COLOR_MOD:
+				emitRenderCommand(command);
+				break;
+			case RENDER_COPY:
+			case RENDER_FILL_RECTS:
+			case RENDER_LINES:
+			case RENDER_GEOMETRY:
+				if(!measured || (!SDL_RectEmpty(&dirty->bounds[i]) && SDL_HasIntersection(&dirty->bounds[i], rect))){
+					emitRenderCommand(command);
+					emitted++;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	drawSetClip(NULL);
+	drawSetTarget(NULL, 0, 0, 1);
+	drawTexture(&dirty->target, &screen, screen, 0, NULL, SDL_FLIP_NONE);
+
+	//count the calls that reach the renderer, not the ones recorded
+	perf.drawCalls = dirty->drawCalls + emitted + 1;
+
+	dirty->invalid = !measured;
+	dirty->w = screen.w;
+	dirty->h = screen.h;
+	dirty->current ^= 1;
+}
+
+/*RELEASE THE TARGET (RENDERER THREAD) AND THE TRACKING MEMORY*/
+void freeDirtyRegions(DirtyRegions* dirty)
+{
+	if(dirty->target.texture != NULL)
+		SDL_DestroyTexture(dirty->target.texture);
+
+	freeCommandBuffer(&dirty->scene);
+	SDL_free(dirty->bounds);
+	SDL_free(dirty->records[0]);
+	SDL_free(dirty->records[1]);
+	SDL_zerop(dirty);
+}
+
+/*BOUND EVERY SCENE COMMAND, HASH EVERY DRAW INTO THIS FRAME'S RECORDS (SORTED) AND DAMAGE COPIES OF TEXTURES UPLOADED
+THIS FRAME. FALSE IF THE SCENE CAN'T BE COMPARED (OUT OF MEMORY, TOO MANY UPLOADS OR TINTED TEXTURES)*/
+bool measureScene(DirtyRegions* dirty, SDL_Rect screen)
+{
+	CommandBuffer *scene = &dirty->scene;
+	RenderCommand *command;
+	DirtyRecord *records;
+	DirtyUpload uploads[DIRTY_MAX_UPLOADS];
+	SDL_Color *tint;
+	SDL_Rect src;
+	int i, j, n = 0, nUploads = 0;
+
+	dirty->nRecords[dirty->current] = 0;
+
+	if(!growDirtyArray((void**)&dirty->bounds, &dirty->boundsCapacity, scene->nCommands, sizeof(SDL_Rect))
+		|| !growDirtyArray((void**)&dirty->records[dirty->current], &dirty->recordsCapacity[dirty->current], scene->nCommands, sizeof(DirtyRecord)))
+		return false;
+
+	records = dirty->records[dirty->current];
+
+	for(i = 0; i < scene->nCommands; i++)
+	{
+		command = &scene->commands[i];
+		dirty->bounds[i] = commandBounds(command, screen);
+
+		switch(command->type)
+		{
+		case RENDER_COLOR_MOD:
+			for(j = 0; j < dirty->nTints && dirty->tinted[j] != command->texture; j++);
+			if(j == DIRTY_MAX_TINTS){
+				dirty->nTints = 0;
+				return false;
+			}
+
+			dirty->tinted[j] = command->texture;
+			dirty->tints[j] = command->color;
+			dirty->nTints = SDL_max(dirty->nTints, j + 1);
+			break;
+		case RENDER_UPDATE_TEXTURE:
+		case RENDER_SET_SURFACE:
+			if(nUploads == DIRTY_MAX_UPLOADS)
+				return false;
+
+			uploads[nUploads].texture = command->texture;
+			uploads[nUploads].rect = command->type == RENDER_UPDATE_TEXTURE ? command->dst : (SDL_Rect){0, 0, SDL_MAX_SINT32, SDL_MAX_SINT32};
+			nUploads++;
+			break;
+		default:
+			if(SDL_RectEmpty(&dirty->bounds[i]) || !SDL_HasIntersection(&dirty->bounds[i], &screen))
+				break;
+
+			//a copy looks like its texture's color mod at that point, possibly set frames ago
+			tint = NULL;
+			for(j = 0; command->type == RENDER_COPY && j < dirty->nTints; j++){
+				if(dirty->tinted[j] == command->texture)
+					tint = &dirty->tints[j];
+			}
+
+			records[n].hash = hashCommand(command, tint);
+			records[n].bounds = dirty->bounds[i];
+			n++;
+			break;
+		}
+	}
+
+	SDL_qsort(records, n, sizeof(DirtyRecord), compareDirtyRecords);
+	dirty->nRecords[dirty->current] = n;
+
+	//same copy, new pixels
+	for(j = 0; j < nUploads; j++)
+	{
+		for(i = 0; i < scene->nCommands; i++)
+		{
+			command = &scene->commands[i];
+			if(command->type != RENDER_COPY || command->texture != uploads[j].texture || SDL_RectEmpty(&dirty->bounds[i]))
+				continue;
+
+			src = command->clipped ? command->src : (SDL_Rect){0, 0, command->texture->w, command->texture->h};
+			if(SDL_HasIntersection(&src, &uploads[j].rect))
+				addDamage(dirty, dirty->bounds[i], screen);
+		}
+	}
+
+	return true;
+}
+
+/*SCREEN RECT command CAN TOUCH (EMPTY IF IT DRAWS NOTHING)*/
+SDL_Rect commandBounds(const RenderCommand* command, SDL_Rect screen)
+{
+	SDL_Rect bounds = {0, 0, 0, 0}, *rects;
+	SDL_Point *points;
+	SDL_Vertex *vertices;
+	float minX, minY, maxX, maxY;
+	int i, cx, cy, dx, dy, r;
+
+	switch(command->type)
+	{
+	case RENDER_CLEAR:
+		return screen;
+	case RENDER_COPY:
+		if(command->angle == 0)
+			return command->dst;
+
+		//a turned copy stays inside the circle through its corner farthest from the center it turns around
+		cx = command->dst.x + (command->centered ? command->center.x : command->dst.w / 2);
+		cy = command->dst.y + (command->centered ? command->center.y : command->dst.h / 2);
+		dx = SDL_max(cx - command->dst.x, command->dst.x + command->dst.w - cx);
+		dy = SDL_max(cy - command->dst.y, command->dst.y + command->dst.h - cy);
+		r = (int)ceil(sqrt((double)dx * dx + (double)dy * dy)) + 1;
+		return (SDL_Rect){cx - r, cy - r, 2 * r, 2 * r};
+	case RENDER_FILL_RECTS:
+		rects = (SDL_Rect*)command->data;
+		for(i = 0; i < command->count; i++)
+		{
+			if(SDL_RectEmpty(&rects[i]))
+				continue;
+
+			if(SDL_RectEmpty(&bounds))
+				bounds = rects[i];
+			else
+				SDL_UnionRect(&bounds, &rects[i], &bounds);
+		}
+		return bounds;
+	case RENDER_LINES:
+		points = (SDL_Point*)command->data;
+		if(command->count == 0)
+			return bounds;
+
+		minX = maxX = (float)points[0].x;
+		minY = maxY = (float)points[0].y;
+		for(i = 1; i < command->count; i++)
+		{
+			minX = SDL_min(minX, (float)points[i].x);
+			maxX = SDL_max(maxX, (float)points[i].x);
+			minY = SDL_min(minY, (float)points[i].y);
+			maxY = SDL_max(maxY, (float)points[i].y);
+		}
+		break;
+	case RENDER_GEOMETRY:
+		vertices = (SDL_Vertex*)command->data;
+		if(command->count == 0)
+			return bounds;
+
+		minX = maxX = vertices[0].position.x;
+		minY = maxY = vertices[0].position.y;
+		for(i = 1; i < command->count; i++)
+		{
+			minX = SDL_min(minX, vertices[i].position.x);
+			maxX = SDL_max(maxX, vertices[i].position.x);
+			minY = SDL_min(minY, vertices[i].position.y);
+			maxY = SDL_max(maxY, vertices[i].position.y);
+		}
+		break;
+	default:
+		return bounds;
+	}
+
+	//points and vertices: every pixel they reach
+	bounds.x = (int)floor(minX);
+	bounds.y = (int)floor(minY);
+	bounds.w = (int)ceil(maxX) - bounds.x + 1;
+	bounds.h = (int)ceil(maxY) - bounds.y + 1;
+
+	return bounds;
+}
+
+/*FOLD size BYTES OF data INTO hash (FNV-1a)*/
+Uint64 hashBytes(Uint64 hash, const void* data, size_t size)
+{
+	const Uint8 *bytes = (const Uint8*)data;
+
+	while(size-- > 0)
+		hash = (hash ^ *bytes++) * 1099511628211ULL;
+
+	return hash;
+}
+
+/*HASH EVERYTHING THAT DECIDES THE PIXELS OF DRAW command (COPIES ALSO tint, THEIR TEXTURE'S COLOR MOD, NULL IF NEVER SEEN)*/
+Uint64 hashCommand(const RenderCommand* command, const SDL_Color* tint)
+{
+	Uint64 hash = hashBytes(14695981039346656037ULL, &command->type, sizeof(command->type));
+
+	switch(command->type)
+	{
+	case RENDER_CLEAR:
+		hash = hashBytes(hash, &command->color, sizeof(SDL_Color));
+		break;
+	case RENDER_COPY:
+		hash = hashBytes(hash, &command->texture, sizeof(Texture*));
+		hash = hashBytes(hash, &command->clipped, sizeof(bool));
+		if(command->clipped)
+			hash = hashBytes(hash, &command->src, sizeof(SDL_Rect));
+		hash = hashBytes(hash, &command->dst, sizeof(SDL_Rect));
+		hash = hashBytes(hash, &command->angle, sizeof(double));
+		hash = hashBytes(hash, &command->centered, sizeof(bool));
+		if(command->centered)
+			hash = hashBytes(hash, &command->center, sizeof(SDL_Point));
+		hash = hashBytes(hash, &command->flip, sizeof(SDL_RendererFlip));
+		if(tint != NULL)
+			hash = hashBytes(hash, tint, sizeof(SDL_Color));
+		else
+			hash = hashBytes(hash, "untinted", 8);
+		break;
+	case RENDER_FILL_RECTS:
+	case RENDER_LINES:
+		hash = hashBytes(hash, &command->color, sizeof(SDL_Color));
+		hash = hashBytes(hash, &command->blend, sizeof(SDL_BlendMode));
+		hash = hashBytes(hash, command->data, command->count * (command->type == RENDER_LINES ? sizeof(SDL_Point) : sizeof(SDL_Rect)));
+		break;
+	case RENDER_GEOMETRY:
+		hash = hashBytes(hash, &command->blend, sizeof(SDL_BlendMode));
+		hash = hashBytes(hash, command->data, command->count * sizeof(SDL_Vertex));
+		break;
+	default:
+		break;
+	}
+
+	return hash;
+}
+
+/*ORDER DirtyRecords BY HASH*/
+int compareDirtyRecords(const void* a, const void* b)
+{
+	Uint64 hashA = ((const DirtyRecord*)a)->hash, hashB = ((const DirtyRecord*)b)->hash;
+
+	return (hashA > hashB) - (hashA < hashB);
+}
+
+/*DAMAGE WHERE THIS FRAME'S AND THE LAST FRAME'S DRAWS DIFFER: DRAWS ONLY IN ONE OF THEM (BOTH SORTED BY HASH)*/
+void diffDirtyRecords(DirtyRegions* dirty, SDL_Rect screen)
+{
+	DirtyRecord *now = dirty->records[dirty->current], *before = dirty->records[dirty->current ^ 1];
+	int nNow = dirty->nRecords[dirty->current], nBefore = dirty->nRecords[dirty->current ^ 1];
+	int i = 0, j = 0;
+
+	while(i < nNow || j < nBefore)
+	{
+		if(j == nBefore || (i < nNow && now[i].hash < before[j].hash))
+			addDamage(dirty, now[i++].bounds, screen);      //new or changed draw
+		else if(i == nNow || before[j].hash < now[i].hash)
+			addDamage(dirty, before[j++].bounds, screen);   //gone or changed: what it covered
+		else{
+			i++;
+			j++;
+		}
+	}
+}
+
+/*ADD rect (CLIPPED TO screen) TO THE DAMAGED REGIONS, MERGING IT WITH THOSE CLOSER THAN DIRTY_MERGE_GAP, OR WITH THE ONE
+GROWING THE LEAST IF THERE ARE DIRTY_MAX_RECTS ALREADY*/
+void addDamage(DirtyRegions* dirty, SDL_Rect rect, SDL_Rect screen)
+{
+	SDL_Rect reach, merged;
+	int i, best, growth, bestGrowth;
+
+	if(SDL_RectEmpty(&rect) || !SDL_IntersectRect(&rect, &screen, &rect))
+		return;
+
+	i = 0;
+	while(i < dirty->nRects)
+	{
+		reach = (SDL_Rect){dirty->rects[i].x - DIRTY_MERGE_GAP, dirty->rects[i].y - DIRTY_MERGE_GAP,
+			dirty->rects[i].w + 2 * DIRTY_MERGE_GAP, dirty->rects[i].h + 2 * DIRTY_MERGE_GAP};
+
+		if(SDL_HasIntersection(&reach, &rect)){
+			//the union may reach regions already checked, start over without this one
+			SDL_UnionRect(&dirty->rects[i], &rect, &rect);
+			dirty->rects[i] = dirty->rects[--dirty->nRects];
+			i = 0;
+		}
+		else
+			i++;
+	}
+
+	if(dirty->nRects == DIRTY_MAX_RECTS)
+	{
+		best = 0;
+		bestGrowth = SDL_MAX_SINT32;
+
+		for(i = 0; i < dirty->nRects; i++)
+		{
+			SDL_UnionRect(&dirty->rects[i], &rect, &merged);
+			growth = merged.w * merged.h - dirty->rects[i].w * dirty->rects[i].h;
+			if(growth < bestGrowth){
+				best = i;
+				bestGrowth = growth;
+			}
+		}
+
+		SDL_UnionRect(&dirty->rects[best], &rect, &rect);
+		dirty->rects[best] = dirty->rects[--dirty->nRects];
+		addDamage(dirty, rect, screen); //grown, it may now be reach others
+		return;
+	}
+
+	dirty->rects[dirty->nRects++] = rect;
+}
+
+/*MAKE ROOM FOR needed ELEMENTS OF size IN *array, DOUBLING capacity*/
+bool growDirtyArray(void** array, int* capacity, int needed, size_t size)
+{
+	void *grown;
+	int newCapacity = *capacity > 0 ? *capacity : 256;
+
+	if(needed <= *capacity)
+		return true;
+
+	while(newCapacity < needed)
+		newCapacity *= 2;
+
+	grown = SDL_realloc(*array, newCapacity * size);
+	if(grown == NULL){
+		SDL_OutOfMemory();
+		print_err("Could not track dirty rects");
+		return false;
+	}
+
+	*array = grown;
+	*capacity = newCapacity;
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef DIRTYRECT_H
+#define DIRTYRECT_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "engine.h"
+#include "commandbuffer.h"
+
+#define DIRTY_MAX_RECTS 16      //damaged regions per frame, past this the closest ones are merged
+#define DIRTY_MERGE_GAP 8       //regions this close are merged, one pass beats two thin ones
+#define DIRTY_FULL_PERCENT 60   //damage covering more of the screen than this redraws it in a single pass
+#define DIRTY_MAX_TINTS 32      //textures whose color mod is tracked, past this the table starts over with a full redraw
+#define DIRTY_MAX_UPLOADS 32    //texture uploads per frame, past this the whole scene is redrawn
+
+//a scene draw as compared between frames: everything that decides its pixels hashed, and where they go
+typedef struct{
+	Uint64 hash;
+	SDL_Rect bounds;
+} DirtyRecord;
+
+//dirty rectangle mode: the scene is recorded, compared draw by draw with the previous frame's and only the damaged
+//regions (draws that appeared, vanished or changed, and copies of textures uploaded this frame) are drawn again, each
+//region clipped, into a target kept between frames that is then copied to the window. An unchanged scene costs one copy
+typedef struct{
+	bool enabled;
+	Texture target;             //the kept scene, renderer thread only
+	CommandBuffer scene;        //this frame's scene, sent on as clipped passes
+	CommandBuffer *outer;       //where the passes go, renderCommands at beginDirtyScene
+	SDL_Rect *bounds;           //screen bounds of every scene command, empty: draws nothing
+	int boundsCapacity;
+	DirtyRecord *records[2];    //draws of this and the previous frame, sorted by hash
+	int nRecords[2], recordsCapacity[2];
+	int current;
+	Texture *tinted[DIRTY_MAX_TINTS]; //last color mod recorded for each texture (it stays set across frames)
+	SDL_Color tints[DIRTY_MAX_TINTS];
+	int nTints;
+	SDL_Rect rects[DIRTY_MAX_RECTS];
+	int nRects;
+	int w, h;                   //scene size the target holds
+	bool invalid;               //target never drawn or its contents lost: redraw everything
+	int redrawnPercent;         //share of the screen redrawn last frame
+	int drawCalls;              //perf.drawCalls at beginDirtyScene
+} DirtyRegions;
+
+void initDirtyRegions(DirtyRegions* dirty, bool enabled);
+void invalidateDirtyRegions(DirtyRegions* dirty);
+void beginDirtyScene(DirtyRegions* dirty);
+void endDirtyScene(DirtyRegions* dirty, SDL_Rect* camera);
+void freeDirtyRegions(DirtyRegions* dirty);
+
+#endif
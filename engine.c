@@ -0,0 +1,1385 @@
+#include "engine.h"
+#include "resources.h"
+#include "perf.h"
+#include "commandbuffer.h"
+#include "debugdraw.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+SDL_Window *window = NULL;
+SDL_Renderer *renderer = NULL;
+SDL_Rect *camera = NULL;
+TextureHandle textBoxSheet, tileSheet;
+TileMap map;
+SineWave tileWave = {{NULL, NULL, {0, 0, 0, 0}}, NULL, 0, -1, 0, {0}};
+int levelWidth = LEVEL_WIDTH, levelHeight = LEVEL_HEIGHT;
+Pool colliderSetPool = {&levelArena, sizeof(ColliderSet), NULL, 0};
+FontHandle textBoxFont;
+SDL_Color black = {0, 0, 0, 0};
+SDL_Color yellow = {255, 255, 0, 0};
+SDL_Color green = {25, 102, 25, 0};
+SDL_Color lightBlack = {80, 80, 80, 0};
+
+/*ADD SPECIFIED clip TO GIVEN sprite ON index (IN nClips RANGE), SET AS CURRENT RENDER IF setRender*/
+void addClip(Sprite* sprite, int index, SDL_Rect clip, bool setRender)
+{
+	if(index < 0 || index >= sprite->nClips)
+		return;
+	
+	sprite->clips[index] = clip;
+	if(sprite->frames != NULL)
+		sprite->frames[index] = (SDL_Rect){0, 0, clip.w, clip.h};
+
+	if(setRender){
+		sprite->renderRect = &sprite->clips[index];
+		updateSpriteSize(sprite);
+	}
+}
+
+/*SET sprite'S SCALE RECT TO SIZE (w,h) (CREATE NEW ON levelArena IF NULL) AND UPDATE sprite INTERNAL SIZE*/
+void setScaleRect(Sprite* sprite, int w, int h)
+{
+	if(sprite->scaleRect == NULL){
+		sprite->scaleRect = (SDL_Rect*)arenaAlloc(&levelArena, sizeof(SDL_Rect));
+	}
+
+	*sprite->scaleRect = (SDL_Rect){0, 0, w, h};
+	updateSpriteSize(sprite);
+}
+
+/*SET THE UNTRIMMED frame OF sprite'S CLIP ON index (CREATE THE FRAMES ON levelArena IF NULL, EVERY OTHER CLIP BEING ITS OWN FRAME)*/
+void setClipFrame(Sprite* sprite, int index, SDL_Rect frame)
+{
+	int i;
+
+	if(index < 0 || index >= sprite->nClips || frame.w <= 0 || frame.h <= 0)
+		return;
+
+	if(sprite->frames == NULL){
+		if(frame.x == 0 && frame.y == 0 && frame.w == sprite->clips[index].w && frame.h == sprite->clips[index].h)
+			return; //untrimmed, nothing to keep
+
+		sprite->frames = (SDL_Rect*)arenaAlloc(&levelArena, sizeof(SDL_Rect) * sprite->nClips);
+		if(sprite->frames == NULL)
+			return;
+
+		for(i = 0; i < sprite->nClips; i++)
+			sprite->frames[i] = (SDL_Rect){0, 0, sprite->clips[i].w, sprite->clips[i].h};
+	}
+
+	sprite->frames[index] = frame;
+	updateSpriteSize(sprite);
+}
+
+/*UPDATE sprite INTERNAL SIZE(w,h) BASED ON SCALING AND RENDERING COMPONENTS*/
+void updateSpriteSize(Sprite* sprite)
+{
+	if(sprite->scaleRect != NULL){
+		sprite->w = sprite->scaleRect->w;
+		sprite->h = sprite->scaleRect->h;
+	}
+	else if(sprite->frames != NULL){
+		sprite->w = sprite->frames[sprite->renderRect - sprite->clips].w;
+		sprite->h = sprite->frames[sprite->renderRect - sprite->clips].h;
+	}
+	else{
+		sprite->w = sprite->renderRect->w;
+		sprite->h = sprite->renderRect->h;
+	}
+}
+
+/*LOAD SDL SURFACE FROM PATH*/
+SDL_Surface* loadSurface(const char* path)
+{
+	SDL_Surface *surface = IMG_Load(path);
+
+	if(surface == NULL){
+		print_err("Could not load surface");
+	}
+
+	return surface;
+}
+
+/*LOAD SDL SURFACE FROM PATH WITH PIXEL STREAMING PROPERTIES*/
+SDL_Surface* loadPixelSurface(const char* path)
+{
+	SDL_Surface *surface = loadSurface(path);
+	SDL_Surface *formattedSurface = SDL_ConvertSurfaceFormat(surface, SDL_GetWindowPixelFormat(window), 0);
+
+	if(formattedSurface == NULL){
+		print_err("Could not load formatted surface for pixel streaming");
+	}
+
+	SDL_FreeSurface(surface);
+
+	return formattedSurface;
+}
+
+/*LOAD SDL TEXTURE FROM PATH AND COLOR KEY IF NECESSARY*/
+Texture loadTexture(const char* path, SDL_Color* colorKey)
+{
+	SDL_Surface *loadedSurface = loadSurface(path);
+	Texture texture;
+
+	SDL_zero(texture);
+
+	if(loadedSurface == NULL){
+		print_err("Could not load surface for texture");
+	}
+	else{
+		texture = createSurfaceTexture(loadedSurface, path, colorKey);
+	}
+
+	SDL_FreeSurface(loadedSurface);
+
+	return texture;
+}
+
+/*UPLOAD A DECODED surface AS A STATIC TEXTURE, COLOR KEYED IF NECESSARY (surface STAYS WITH THE CALLER)*/
+Texture createSurfaceTexture(SDL_Surface* surface, const char* path, SDL_Color* colorKey)
+{
+	SDL_Texture *loadedTexture = NULL;
+	Texture texture;
+
+	SDL_zero(texture);
+
+	if(colorKey != NULL){
+		SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, colorKey->r, colorKey->g, colorKey->b));
+	}
+
+	loadedTexture = SDL_CreateTextureFromSurface(renderer, surface);
+	perf.textureUploads++;
+
+	if(loadedTexture == NULL){
+		print_err("Unable to load texture from surface");
+	}
+	else{
+		texture = (Texture){loadedTexture, path, surface->w, surface->h, false, NULL, 0};
+	}
+
+	return texture;
+}
+
+/*LOAD SDL TEXTURE FROM PATH WITH PIXEL STREAMING PROPERTIES*/
+Texture loadPixelTexture(const char* path)
+{
+	SDL_Surface *loadedSurface = loadPixelSurface(path);
+	Texture texture;
+
+	SDL_zero(texture);
+
+	if(loadedSurface == NULL){
+		print_err("Could not load surface for pixel streaming texture");
+	}
+	else{
+		texture = createPixelTexture(loadedSurface, path);
+	}
+
+	SDL_FreeSurface(loadedSurface);
+
+	return texture;
+}
+
+/*COPY A surface ALREADY IN THE WINDOW PIXEL FORMAT INTO A NEW PIXEL STREAMING TEXTURE (surface STAYS WITH THE CALLER)*/
+Texture createPixelTexture(SDL_Surface* surface, const char* path)
+{
+	SDL_Texture *loadedTexture = NULL;
+	Texture texture;
+	int row;
+
+	SDL_zero(texture);
+
+	loadedTexture = SDL_CreateTexture(renderer, SDL_GetWindowPixelFormat(window), SDL_TEXTUREACCESS_STREAMING, surface->w, surface->h);
+
+	if(loadedTexture == NULL){
+		print_err("Unable to load pixel streaming texture from surface");
+	}
+	else
+	{
+		SDL_LockTexture(loadedTexture, NULL, &texture.pixels, &texture.pitch);
+		if(texture.pitch == surface->pitch){
+			SDL_memcpy(texture.pixels, surface->pixels, surface->pitch * surface->h);
+		}
+		else{ //rows padded differently
+			for(row = 0; row < surface->h; row++)
+				SDL_memcpy((Uint8*)texture.pixels + row * texture.pitch, (Uint8*)surface->pixels + row * surface->pitch, SDL_min(texture.pitch, surface->pitch));
+		}
+		SDL_UnlockTexture(loadedTexture);
+		perf.textureUploads++;
+		texture.pixels = NULL;
+
+		texture = (Texture){loadedTexture, path, surface->w, surface->h, true, texture.pixels, texture.pitch};
+	}
+
+	return texture;
+}
+
+/*LOCK VALID PIXEL-STREAMING texture*/
+bool lockPixelTexture(Texture* texture)
+{
+	if(!texture->pixelstream){
+		print_err("No pixel-streaming texture provided for locking");
+		return false;
+	}
+
+	if(texture->pixels != NULL){
+		print_err("Texture is already locked/pixels in use");
+		return false;
+	}
+
+	if(SDL_LockTexture(texture->texture, NULL, &texture->pixels, &texture->pitch) != 0){
+		print_err("Unable to lock texture");
+		return false;
+	}
+	
+	return true;
+}
+
+/*UNLOCK VALID PIXEL-STREAMING texture*/
+bool unlockPixelTexture(Texture* texture)
+{
+	if(!texture->pixelstream){
+		print_err("No pixel-streaming texture provided for unlocking");
+		return false;
+	}
+
+	if(texture->pixels == NULL){
+		print_err("Texture is already unlocked/pixels not set");
+		return false;
+	}
+
+	SDL_UnlockTexture(texture->texture);
+	perf.textureUploads++;
+	texture->pixels = NULL;
+	texture->pitch = 0;
+
+	return true;
+}
+
+/*START canvas ON PIXEL STREAMING texture WITH A COPY OF pixels (WHAT texture SHOWS, IN ITS FORMAT)*/
+bool createPixelCanvas(PixelCanvas* canvas, Texture* texture, SDL_Surface* pixels)
+{
+	int row;
+
+	SDL_zerop(canvas);
+
+	if(!texture->pixelstream || pixels->w != texture->w || pixels->h != texture->h){
+		SDL_SetError("Canvas pixels don't match a pixel-streaming texture");
+		print_err("Could not create pixel canvas");
+		return false;
+	}
+
+	canvas->surface = SDL_CreateRGBSurfaceWithFormat(0, pixels->w, pixels->h, pixels->format->BitsPerPixel, pixels->format->format);
+	if(canvas->surface == NULL){
+		print_err("Could not create pixel canvas");
+		return false;
+	}
+
+	for(row = 0; row < pixels->h; row++)
+		SDL_memcpy((Uint8*)canvas->surface->pixels + row * canvas->surface->pitch, (Uint8*)pixels->pixels + row * pixels->pitch, pixels->w * pixels->format->BytesPerPixel);
+
+	canvas->texture = texture;
+	return true;
+}
+
+/*MARK rect OF canvas AS CHANGED (CLIPPED TO IT) FOR THE NEXT flushPixelCanvas*/
+void markPixelCanvas(PixelCanvas* canvas, SDL_Rect rect)
+{
+	SDL_Rect bounds = {0, 0, canvas->surface->w, canvas->surface->h}, clipped;
+
+	if(!SDL_IntersectRect(&rect, &bounds, &clipped))
+		return;
+
+	if(SDL_RectEmpty(&canvas->dirty))
+		canvas->dirty = clipped;
+	else
+		SDL_UnionRect(&canvas->dirty, &clipped, &canvas->dirty);
+}
+
+/*COPY rect OF source (SAME SIZE AND FORMAT AS canvas) ONTO canvas AND MARK IT*/
+void copyPixelCanvas(PixelCanvas* canvas, SDL_Surface* source, SDL_Rect rect)
+{
+	SDL_Surface *surface = canvas->surface;
+	SDL_Rect bounds = {0, 0, surface->w, surface->h};
+	int row, bpp = surface->format->BytesPerPixel;
+
+	if(!SDL_IntersectRect(&rect, &bounds, &rect))
+		return;
+
+	for(row = rect.y; row < rect.y + rect.h; row++)
+		SDL_memcpy((Uint8*)surface->pixels + row * surface->pitch + rect.x * bpp, (Uint8*)source->pixels + row * source->pitch + rect.x * bpp, rect.w * bpp);
+
+	markPixelCanvas(canvas, rect);
+}
+
+/*UPLOAD WHAT WAS MARKED ON canvas SINCE THE LAST FLUSH (NOTHING IF NOTHING WAS)*/
+bool flushPixelCanvas(PixelCanvas* canvas)
+{
+	SDL_Rect *dirty = &canvas->dirty;
+
+	if(SDL_RectEmpty(dirty))
+		return true;
+
+	if(!updateTextureRect(canvas->texture, *dirty, canvas->surface))
+		return false;
+
+	*dirty = (SDL_Rect){0, 0, 0, 0};
+
+	return true;
+}
+
+/*FREE canvas'S PIXELS (ITS TEXTURE KEEPS WHAT WAS LAST FLUSHED)*/
+void freePixelCanvas(PixelCanvas* canvas)
+{
+	SDL_FreeSurface(canvas->surface);
+	SDL_zerop(canvas);
+}
+
+/*RENDER text IN GIVEN COLOR AND FONT TO A NEW SURFACE (A BLANK GLYPH FOR AN EMPTY STRING), NULL ON ERROR*/
+SDL_Surface* renderTextSurface(const char *text, SDL_Color color, TTF_Font* font)
+{
+	SDL_Surface *loadedTTFSurface = NULL;
+
+	if(strlen(text) == 0) //empty texture on empty string
+		loadedTTFSurface = TTF_RenderUTF8_Solid(font, " ", color);
+	else
+		loadedTTFSurface = TTF_RenderUTF8_Solid(font, text, color); //SDL_TEXTINPUT hands out UTF-8
+
+	if(loadedTTFSurface == NULL)
+		print_err("Could not load TTF surface");
+
+	return loadedTTFSurface;
+}
+
+/*LOAD SDL TTF TEXTURE WITH GIVEN TEXT, COLOR AND FONT*/
+Texture loadRenderedText(const char *text, SDL_Color color, TTF_Font* font)
+{
+	SDL_Texture *loadedTTFTexture = NULL;
+	SDL_Surface *loadedTTFSurface = NULL;
+	Texture ttfText;
+	const char *allocSite = perfAllocSite("loadRenderedText");
+
+	SDL_zero(ttfText);
+
+	loadedTTFSurface = renderTextSurface(text, color, font);
+
+	if(loadedTTFSurface != NULL)
+	{
+		loadedTTFTexture = SDL_CreateTextureFromSurface(renderer, loadedTTFSurface);
+		perf.textureUploads++;
+
+		if(loadedTTFTexture == NULL){
+			print_err("Unable to load TTF texture from surface");
+		}
+		else{
+			ttfText = (Texture){loadedTTFTexture, "", loadedTTFSurface->w, loadedTTFSurface->h, false, NULL, 0};
+		}
+	}
+
+	SDL_FreeSurface(loadedTTFSurface);
+	loadedTTFSurface = NULL;
+
+	perfAllocSite(allocSite);
+
+	return ttfText;
+}
+
+/*LOAD NEW TILE MAP FROM tileFileName (ONE ROW PER LINE, ONE TILE TYPE DIGIT PER CHAR) WITH UP TO size TILES DEFINED BY nTileTypes AND tileSheet*/
+TileMap loadTileMap(int size, const char *tileFileName, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes)
+{
+	TileMap map = createTileMap(size, tileSheet, tileClips, nTileTypes);
+	SDL_RWops *tileFile = SDL_RWFromFile(tileFileName, "r");
+	char buffer[TILE_MAP_READ_CHUNK];
+	size_t nRead, j;
+	int col = 0;
+
+	if(tileFile == NULL){
+		print_err("Could not open tile map file");
+		return map;
+	}
+
+	while(map.size < size && (nRead = SDL_RWread(tileFile, buffer, 1, TILE_MAP_READ_CHUNK)) > 0)
+	{
+		for(j = 0; j < nRead && map.size < size; j++)
+		{
+			if(buffer[j] == '\r')
+				continue;
+
+			if(buffer[j] == '\n'){ //end of row
+				if(col > 0)
+					endTileMapRow(&map, col);
+				col = 0;
+				continue;
+			}
+
+			if(map.rows > 0 && col >= map.cols) //rows longer than the first one are truncated
+				continue;
+
+			addTileMapTile(&map, col++, (buffer[j] >= '0' && buffer[j] <= '9') ? buffer[j] - '0' : EMPTY);
+		}
+	}
+
+	if(col > 0) //last row without line break
+		endTileMapRow(&map, col);
+
+	SDL_RWclose(tileFile);
+
+	return map;
+}
+
+/*CREATE AN EMPTY TILE MAP ON levelArena WITH ROOM FOR size TILES (GRID CELL SIZE TAKEN FROM THE EMPTY TILE CLIP)*/
+TileMap createTileMap(int size, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes)
+{
+	TileMap map;
+
+	map.tiles = (Tile*)arenaAlloc(&levelArena, sizeof(Tile) * size);
+	map.tileClips = (SDL_Rect*)arenaAlloc(&levelArena, sizeof(SDL_Rect) * nTileTypes);
+
+	if(map.tileClips != NULL)
+		SDL_memcpy(map.tileClips, tileClips, sizeof(SDL_Rect) * nTileTypes);
+
+	map.size = 0;
+	map.capacity = map.tiles != NULL && map.tileClips != NULL ? size : 0;
+	map.sheet = tileSheet;
+	map.nTileTypes = nTileTypes;
+	map.cols = 0;
+	map.rows = 0;
+	map.tileW = tileClips[EMPTY].w;
+	map.tileH = tileClips[EMPTY].h;
+
+	return map;
+}
+
+/*APPEND TILE OF type AT COLUMN col OF map'S CURRENT (LAST) ROW*/
+void addTileMapTile(TileMap* map, int col, int type)
+{
+	SDL_Rect cell = {col * map->tileW, map->rows * map->tileH, map->tileW, map->tileH};
+
+	if(map->size >= map->capacity)
+		return;
+
+	if(type > 0 && type < map->nTileTypes){
+		cell.w = map->tileClips[type].w;
+		cell.h = map->tileClips[type].h;
+		map->tiles[map->size++] = loadTile(type, cell, true, true);
+	}
+	else if(type == EMPTY){
+		map->tiles[map->size++] = loadTile(EMPTY, cell, false, false);
+	}
+	else{
+		map->tiles[map->size++] = loadTile(UNDEFINED, (SDL_Rect){cell.x, cell.y, 0, 0}, false, false);
+	}
+}
+
+/*CLOSE map'S CURRENT ROW OF nCols TILES (FIRST ROW SETS THE MAP WIDTH, SHORTER ROWS ARE PADDED WITH EMPTY TILES)*/
+void endTileMapRow(TileMap* map, int nCols)
+{
+	if(map->rows == 0)
+		map->cols = nCols;
+
+	for(; nCols < map->cols; nCols++)
+		addTileMapTile(map, nCols, EMPTY);
+
+	map->rows++;
+}
+
+/*DROP map'S TILES AND CLIPS (THEIR MEMORY GOES BACK WITH levelArena)*/
+void freeTileMap(TileMap* map)
+{
+	if(tileWave.canvas.texture == map->sheet)
+		freeSineWave(&tileWave);
+
+	map->tiles = NULL;
+	map->tileClips = NULL;
+	map->size = 0;
+	map->capacity = 0;
+	map->cols = 0;
+	map->rows = 0;
+}
+
+/*GET map GRID CELLS (x,y = FIRST COLUMN/ROW, w,h = NUMBER OF COLUMNS/ROWS) OVERLAPPING area, FALSE IF NONE*/
+bool getTileMapCells(TileMap map, SDL_Rect area, SDL_Rect* cells)
+{
+	int firstCol, firstRow, lastCol, lastRow;
+
+	if(map.cols <= 0 || map.rows <= 0 || map.tileW <= 0 || map.tileH <= 0 || area.w <= 0 || area.h <= 0)
+		return false;
+
+	firstCol = area.x < 0 ? 0 : area.x / map.tileW;
+	firstRow = area.y < 0 ? 0 : area.y / map.tileH;
+	lastCol = (area.x + area.w - 1) / map.tileW;
+	lastRow = (area.y + area.h - 1) / map.tileH;
+
+	if(area.x + area.w <= 0 || area.y + area.h <= 0 || firstCol >= map.cols || firstRow >= map.rows)
+		return false;
+
+	if(lastCol >= map.cols)
+		lastCol = map.cols - 1;
+
+	if(lastRow >= map.rows)
+		lastRow = map.rows - 1;
+
+	*cells = (SDL_Rect){firstCol, firstRow, lastCol - firstCol + 1, lastRow - firstRow + 1};
+
+	return true;
+}
+
+/*LOAD NEW TILE BASED ON TILEMAP type*/
+Tile loadTile(int type, SDL_Rect renderRect, bool solid, bool visible)
+{
+	Tile tile;
+
+	tile = (Tile){.x = renderRect.x, .y = renderRect.y, .w = renderRect.w, .h = renderRect.h};
+
+	tile.type = type;
+	tile.renderRect = renderRect;
+	tile.collider = renderRect;
+
+	tile.solid = solid;
+	tile.visible = visible;
+
+	return tile;
+}
+
+/*RENDER texture SCALED BY scaleRect AND clip FROM IT IF NECESSARY (RELATIVE TO camera IF NOT NULL)*/
+void render(Texture* texture, int x, int y, SDL_Rect* clip, SDL_Rect* scaleRect, double angle, SDL_Point* center, SDL_RendererFlip flip, SDL_Rect* camera)
+{
+	SDL_Rect renderSpace = {x, y, texture->w, texture->h};
+
+	if(clip != NULL){
+		renderSpace.w = clip->w;
+		renderSpace.h = clip->h;
+	}
+
+	if(scaleRect != NULL){ //prioritize scaleRect
+		renderSpace.w = scaleRect->w;
+		renderSpace.h = scaleRect->h;
+	}
+
+	if(camera != NULL){
+		renderSpace.x -= camera->x;
+		renderSpace.y -= camera->y;
+	}
+
+	drawTexture(texture, clip, renderSpace, angle, center, flip);
+	perf.drawCalls++;
+}
+
+/*LEVEL SPACE RECT sprite MAY DRAW TO (THE SQUARE ITS FRAME SWEEPS AROUND ITS CENTER IF IT IS TURNED)*/
+SDL_Rect getSpriteBounds(Sprite sprite)
+{
+	int cx, cy, rx, ry, r;
+
+	if(sprite.angle == 0)
+		return (SDL_Rect){sprite.x, sprite.y, sprite.w, sprite.h};
+
+	cx = sprite.center != NULL ? sprite.center->x : sprite.w/2;
+	cy = sprite.center != NULL ? sprite.center->y : sprite.h/2;
+	rx = SDL_max(cx, sprite.w - cx);
+	ry = SDL_max(cy, sprite.h - cy);
+	r = (int)ceil(sqrt((double)rx*rx + (double)ry*ry));
+
+	return (SDL_Rect){sprite.x + cx - r, sprite.y + cy - r, 2*r, 2*r};
+}
+
+/*CHECK sprite IS AT LEAST PARTLY INSIDE camera (ALWAYS IF camera IS NULL)*/
+bool spriteVisible(Sprite sprite, SDL_Rect* camera)
+{
+	return camera == NULL || checkCollision(getSpriteBounds(sprite), *camera);
+}
+
+/*RENDER SPRITE (SCALED BY sprite.scaleRect IF NOT NULL, RELATIVE TO CAMERA IF NOT NULL, NOTHING IF IT IS OUTSIDE IT)*/
+void renderSprite(Sprite sprite, SDL_Rect* camera)
+{
+	SDL_Rect *frame, size;
+	SDL_Point center;
+	int offX, offY;
+
+	if(!spriteVisible(sprite, camera))
+		return;
+
+	if(sprite.frames == NULL){
+		render(sprite.sheet, sprite.x, sprite.y, sprite.renderRect, sprite.scaleRect, sprite.angle, sprite.center, sprite.flip, camera);
+		return;
+	}
+
+	//trimmed clip: draw it where it sat inside its frame (mirrored with the flip), scaled like the whole frame and turning around the frame's center
+	frame = &sprite.frames[sprite.renderRect - sprite.clips];
+	offX = (sprite.flip & SDL_FLIP_HORIZONTAL) ? frame->w - frame->x - sprite.renderRect->w : frame->x;
+	offY = (sprite.flip & SDL_FLIP_VERTICAL) ? frame->h - frame->y - sprite.renderRect->h : frame->y;
+
+	offX = offX * sprite.w / frame->w;
+	offY = offY * sprite.h / frame->h;
+	size = (SDL_Rect){0, 0, sprite.renderRect->w * sprite.w / frame->w, sprite.renderRect->h * sprite.h / frame->h};
+
+	if(sprite.center != NULL)
+		center = (SDL_Point){sprite.center->x - offX, sprite.center->y - offY};
+	else
+		center = (SDL_Point){sprite.w/2 - offX, sprite.h/2 - offY};
+
+	render(sprite.sheet, sprite.x + offX, sprite.y + offY, sprite.renderRect, &size, sprite.angle, &center, sprite.flip, camera);
+}
+
+/*RENDER LEVEL TILE BASED ON INTERNAL POSITION*/
+void renderTile(TileMap map, int index, SDL_Rect* camera)
+{
+	Tile tile = map.tiles[index];
+	render(map.sheet, tile.x, tile.y, &map.tileClips[tile.type], NULL, 0, NULL, SDL_FLIP_NONE, camera);
+}
+
+/*RENDER TILE MAP (ONLY GRID CELLS UNDER camera ARE VISITED)*/
+void renderTileMap(TileMap map, SDL_Rect* camera)
+{
+	SDL_Rect cells;
+	int i, col, row;
+
+	if(!getTileMapCells(map, *camera, &cells))
+		return;
+
+	for(row = cells.y; row < cells.y + cells.h; row++)
+	{
+		for(col = cells.x, i = (row * map.cols) + col; col < cells.x + cells.w && i < map.size; col++, i++)
+		{
+			if(map.tiles[i].visible && checkCollision(map.tiles[i].collider, *camera)){ //visible and inside camera view
+				renderTile(map, i, camera);
+			}
+		}
+	}
+}
+
+/*LOAD NEW SPRITE AND SET RENDER RECT TO FIRST AVAILABLE CLIP (SET scaleRect TO NULL AND EMPTY collider BY DEFAULT)*/
+Sprite loadSprite(int nClips, Texture* sheet, int x, int y, double angle, SDL_Point* center, SDL_RendererFlip flip, void (*collisionHandler)(void*))
+{
+	Sprite sprite;
+
+	sprite.nClips = nClips > 0 ? nClips : 1;
+		
+	sprite.clips = (SDL_Rect*)arenaCalloc(&levelArena, sprite.nClips, sizeof(SDL_Rect));
+	sprite.renderRect = &sprite.clips[0];
+
+	sprite.sheet = sheet;
+	
+	sprite.w = sprite.renderRect->w;
+	sprite.h = sprite.renderRect->h;
+
+	sprite.x = x;
+	sprite.y = y;
+
+	sprite.velX = 0;
+	sprite.velY = 0;
+
+	sprite.angle = angle;
+	sprite.center = center;
+	sprite.flip = flip;
+	sprite.frame = 0;
+	sprite.scaleRect = NULL;
+	sprite.frames = NULL;
+
+	sprite.collider = (SDL_Rect){0, 0, 0, 0};
+	sprite.circleCollider.r = 0;
+	sprite.boxColliders = NULL;
+	sprite.nBoxColliders = 0;
+
+	sprite.collisionHandler = collisionHandler;
+
+	return sprite;
+}
+
+/*GIVE sprite A SET OF n INNER BOX COLLIDERS (FROM colliderSetPool, levelArena IF ABOVE MAX_BOX_COLLIDERS) TO BE FILLED BY THE CALLER*/
+bool setBoxColliders(Sprite* sprite, int n)
+{
+	if(n <= MAX_BOX_COLLIDERS)
+		sprite->boxColliders = (SDL_Rect*)poolAlloc(&colliderSetPool);
+	else
+		sprite->boxColliders = (SDL_Rect*)arenaAlloc(&levelArena, sizeof(SDL_Rect) * n);
+
+	sprite->nBoxColliders = sprite->boxColliders != NULL ? n : 0;
+
+	return sprite->boxColliders != NULL;
+}
+
+/*SET A DEFAULT COLLIDER FOR sprite BASED ON ITS SIZE*/
+void setDefaultCollider(Sprite *sprite)
+{
+	sprite->collider = (SDL_Rect){sprite->x, sprite->y, sprite->w, sprite->h};
+}
+
+/*LOAD NEW TEXTBOX RENDER OBJECT WITH DEFAULT PROPERTIES*/
+Textbox loadTextBox(const char *defaultText, SDL_Color textColor)
+{
+	Textbox textbox;
+	Sprite sprite;
+	int textLen = strlen(defaultText);
+
+	textbox.x = 0, textbox.y = 0;
+	textbox.w = SHEET_STANDARD_SPRITE_SIZE+100, textbox.h = SHEET_STANDARD_SPRITE_SIZE/2;
+
+	textLen = utf8Fit(defaultText, textLen, TEXT_BOX_BUFFER_SIZE-1);
+
+	sprite = loadSprite(1, getTexture(&resources, textBoxSheet), textbox.x, textbox.y, 0, NULL, SDL_FLIP_NONE, NULL);
+	addClip(&sprite, 0, (SDL_Rect){120, 150, 780, 190}, true);
+	setScaleRect(&sprite, textbox.w, textbox.h);
+
+	textbox.sprite = sprite;
+
+	strncpy(textbox.textBuffer, defaultText, textLen);
+	textbox.textBuffer[textLen] = '\0';
+	textbox.textColor = textColor;
+	SDL_zero(textbox.layout);
+	layoutTextBox(&textbox);
+
+	return textbox;
+}
+
+/*DETECT COLLISION BETWEEN BOX A & B*/
+bool checkCollision(SDL_Rect a, SDL_Rect b)
+{
+	if(a.x + a.w <= b.x)
+		return false;
+	else if(a.x >= b.x + b.w)
+		return false;
+	else if(a.y + a.h <= b.y)
+		return false;
+	else if(a.y >= b.y + b.h)
+		return false;
+	else
+		return true; //COLLISION
+}
+
+/*DETECT FIRST COLLISION POINT BETWEEN BOX COLLIDER SET A & BOX COLLIDER SET B*/
+bool checkInnerBoxesCollisions(SDL_Rect* boxCollidersA, int nBoxesA, SDL_Rect* boxCollidersB, int nBoxesB){
+	int i, j;
+
+	if(boxCollidersA == NULL || boxCollidersB == NULL)
+		return false;
+
+	for(i = 0; i < nBoxesA; i++){
+		for(j = 0; j < nBoxesB; j++){
+			if(checkCollision(boxCollidersA[i], boxCollidersB[j])){ //BOX LEVEL COLLISION
+				return true;
+			}
+		}
+	}
+
+	//NO COLLISIONS REPORTED
+	return false;
+}
+
+/*DETECT COLLISION BETWEEN SPRITES A & B CIRCULAR COLLIDERS (IF ANY)*/
+bool checkCircularCollision(Sprite a, Sprite b)
+{
+	if(a.circleCollider.r != 0 && b.circleCollider.r != 0) //A & B CIRCULAR COLLIDERS EXIST
+	{
+		float radiiSumSquared = a.circleCollider.r + b.circleCollider.r;
+		radiiSumSquared *= radiiSumSquared;
+
+		if(distanceSquared(a.circleCollider.x, a.circleCollider.y, b.circleCollider.x, b.circleCollider.y) < radiiSumSquared){
+			return true;
+		}
+	}
+	else if((a.circleCollider.r != 0 && b.circleCollider.r == 0) || (a.circleCollider.r == 0 && b.circleCollider.r != 0)) //A OR B CIRCULAR COLLIDER EXISTS (CIRCLE VS RECT COLLISION)
+	{
+		int cX, cY;
+		SDL_Rect boxCollider = a.circleCollider.r != 0 ? b.collider : a.collider;
+		Circle circleCollider = a.circleCollider.r != 0 ? a.circleCollider : b.circleCollider;
+
+		if(circleCollider.x < boxCollider.x){
+			cX = boxCollider.x;
+		}
+		else if(circleCollider.x > boxCollider.x + boxCollider.w){
+			cX = boxCollider.x + boxCollider.w;
+		}
+		else{
+			cX = circleCollider.x;
+		}
+
+		if(circleCollider.y < boxCollider.y){
+			cY = boxCollider.y;
+		}
+		else if(circleCollider.y > boxCollider.y + boxCollider.h){
+			cY = boxCollider.y + boxCollider.h;
+		}
+		else{
+			cY = circleCollider.y;
+		}
+
+		if(distanceSquared(circleCollider.x, circleCollider.y, cX, cY) < (circleCollider.r * circleCollider.r)){
+			return true;
+		}
+	}
+
+	//else NO CIRCULAR COLLIDERS EXIST/NO CIRCULAR COLLISIONS DETECTED
+	return false;
+}
+
+/*CHECK COLLISION AGAINST LEVEL BOUNDS*/
+bool checkLevelBoundsCollision(Sprite sprite)
+{
+	return sprite.collider.x < 0 || sprite.collider.x + sprite.collider.w > levelWidth || sprite.collider.y < 0 || sprite.collider.y + sprite.collider.h > levelHeight;
+}
+
+/*CHECK COLLISIONS AGAINST LEVEL TILES MAP (ONLY GRID CELLS UNDER sprite'S COLLIDER ARE VISITED)*/
+bool checkTileMapCollisions(Sprite sprite)
+{
+	SDL_Rect cells;
+	int i, col, row;
+
+	if(!getTileMapCells(map, sprite.collider, &cells))
+		return false;
+
+	for(row = cells.y; row < cells.y + cells.h; row++){
+		for(col = cells.x, i = (row * map.cols) + col; col < cells.x + cells.w && i < map.size; col++, i++){
+			if(map.tiles[i].solid && checkCollision(sprite.collider, map.tiles[i].collider)){
+				if(sprite.collisionHandler != NULL)
+					sprite.collisionHandler(&map.tiles[i]);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/*SHIFT SPRITE'S INNER BOX COLLIDERS BY VELOCITY X & Y*/
+void shiftBoxColliders(Sprite* sprite, int velX, int velY){
+	int i;
+
+	for(i = 0; i < sprite->nBoxColliders; i++){
+		sprite->boxColliders[i].x += velX;
+		sprite->boxColliders[i].y += velY;
+	}
+}
+
+/*MOVE SPRITE IF NOT COLLIDING AGAINST spritesColliding OR LEVEL BOUNDS BASED ON ITS POSITION AND VELOCITY (IF APPLICABLE), SEND COLLISION TO collisionHandler IF NECESSARY*/
+void move(Sprite* sprite, Sprite** spritesColliding, int nSpritesColliding)
+{
+	bool collision = false;
+	int i, collidingIndex = -1;
+
+	if(hasColliders(*sprite)) //CHECK FOR COLLISIONS
+	{
+		moveAllColliders(sprite, sprite->velX, sprite->velY);
+		collision = checkLevelBoundsCollision(*sprite) || checkTileMapCollisions(*sprite); //VS LEVEL BOUNDS && LEVEL TILES CHECK
+
+		for(i = 0; i < nSpritesColliding && !collision; i++){  //VS OTHER COLLIDERS
+			if(spritesColliding[i] == NULL || spritesColliding[i] == sprite) continue; //SKIP NULL OR CALLER SPRITES 
+
+			collision = checkCircularCollision(*sprite, *spritesColliding[i]) || //CIRCULAR COLLIDERS CHECK
+						(checkCollision(sprite->collider, spritesColliding[i]->collider) && //OUTER BOX COLLISIONS CHECK
+						(sprite->nBoxColliders == 0 || spritesColliding[i]->nBoxColliders == 0 || 
+						checkInnerBoxesCollisions(sprite->boxColliders, sprite->nBoxColliders, spritesColliding[i]->boxColliders, spritesColliding[i]->nBoxColliders))); //INNER BOXES PER-PIXEL COLLISIONS CHECK
+		}
+
+		collidingIndex = i-1;
+	}
+
+	if(!collision){
+		//MOVE SPRITE
+		sprite->x += sprite->velX;
+		sprite->y += sprite->velY;
+	}
+	else{
+		//COLLISION HANDLER CALL
+		if(sprite->collisionHandler != NULL && spritesColliding != NULL && collidingIndex >= 0)
+			sprite->collisionHandler(spritesColliding[collidingIndex]);
+		//MOVE COLLIDERS BACK
+		moveAllColliders(sprite, -sprite->velX, -sprite->velY);
+	}
+}
+
+/*MOVE sprite AND ITS INTERNAL COLLIDERS TO ABSOLUTE pos (NO COLLISION CHECKING)*/
+void moveTo(Sprite* sprite, SDL_Point pos)
+{
+	moveAllColliders(sprite, pos.x - sprite->x, pos.y - sprite->y);
+	sprite->x = pos.x;
+	sprite->y = pos.y;
+}
+
+/*MOVE ALL APPLICABLE sprite COLLIDERS BY VELOCITY X & Y*/
+void moveAllColliders(Sprite* sprite, int velX, int velY)
+{
+	if(sprite->collider.w != 0 || sprite->collider.h != 0){
+		sprite->collider.x += velX;
+		sprite->collider.y += velY;
+	}
+	
+	if(sprite->boxColliders != NULL && sprite->nBoxColliders != 0){
+		shiftBoxColliders(sprite, velX, velY);
+	}
+
+	if(sprite->circleCollider.r != 0){
+		sprite->circleCollider.x += velX;
+		sprite->circleCollider.y += velY;
+	}
+}
+
+/*QUEUE ALL sprite'S AVAILABLE COLLIDERS ON THE DEBUG OVERLAY RELATIVE TO camera IF NOT NULL (ONLY THOSE INSIDE IT) BY SHADES OF
+SPECIFIED color, DRAWN BY THE NEXT flushDebugDraw*/
+void renderColliders(Sprite sprite, SDL_Rect* camera, SDL_Color color)
+{
+	SDL_Rect boxCollider;
+	Circle circleCollider;
+	SDL_Point cameraOffset = {0,0};
+	int i;
+
+	if(camera != NULL){
+		cameraOffset.x = camera->x;
+		cameraOffset.y = camera->y;
+	}
+
+	if((sprite.collider.w != 0 || sprite.collider.h != 0) && (camera == NULL || checkCollision(sprite.collider, *camera))){
+		boxCollider = sprite.collider;
+		boxCollider.x -= cameraOffset.x;
+		boxCollider.y -= cameraOffset.y;
+		debugRect(boxCollider, (SDL_Color){color.r, color.g, color.b, 30});
+	}
+
+	for(i = 0; i < sprite.nBoxColliders; i++){
+		if(camera != NULL && !checkCollision(sprite.boxColliders[i], *camera))
+			continue;
+
+		boxCollider = sprite.boxColliders[i];
+		boxCollider.x -= cameraOffset.x;
+		boxCollider.y -= cameraOffset.y;
+		debugRect(boxCollider, (SDL_Color){color.r, color.g, color.b, 150});
+	}
+	
+	circleCollider = sprite.circleCollider;
+	if(circleCollider.r != 0 && (camera == NULL ||
+		checkCollision((SDL_Rect){circleCollider.x - circleCollider.r, circleCollider.y - circleCollider.r, 2*circleCollider.r + 1, 2*circleCollider.r + 1}, *camera))){
+		circleCollider.x -= cameraOffset.x;
+		circleCollider.y -= cameraOffset.y;
+		debugCircle(circleCollider, (SDL_Color){color.r, color.g, color.b, 255});
+		debugLine((SDL_Point){circleCollider.x, circleCollider.y}, (SDL_Point){circleCollider.x + circleCollider.r, circleCollider.y}, (SDL_Color){color.r, color.g, color.b, 255});
+	}
+}
+
+/*CHANGE sprite ANIMATION RECT BASED ON INTERNAL FRAME COUNT & delayFactor*/
+void animate(Sprite* sprite, int delayFactor)
+{
+	int currentClipIndex;
+
+	//kept counting while it wasn't animated (animateVisible): back into the cycle, which resets at nClips*nClips*delayFactor
+	if(sprite->frame > sprite->nClips*sprite->nClips*delayFactor)
+		sprite->frame %= sprite->nClips*sprite->nClips*delayFactor;
+
+	currentClipIndex = sprite->frame / (sprite->nClips*delayFactor);
+
+	if(currentClipIndex >= sprite->nClips){
+		sprite->frame = 0;
+		currentClipIndex = sprite->nClips - 1;
+	}
+
+	setRenderRect(sprite, currentClipIndex);
+}
+
+/*ANIMATE sprite ONLY WHILE IT IS INSIDE camera, OFF-SCREEN ITS frame JUST KEEPS COUNTING UNTIL IT SHOWS UP AGAIN*/
+void animateVisible(Sprite* sprite, int delayFactor, SDL_Rect* camera)
+{
+	if(spriteVisible(*sprite, camera))
+		animate(sprite, delayFactor);
+}
+
+/*SET sprite CURRENT RENDER RECT AND UPDATE INTERNAL SIZE*/
+void setRenderRect(Sprite* sprite, int index)
+{
+	if(index < 0 || index >= sprite->nClips)
+		return;
+	
+	sprite->renderRect = &sprite->clips[index];
+	updateSpriteSize(sprite);
+}
+
+/*DELETE GIVEN SPRITE (CLIPS AND SCALE RECT GO BACK WITH levelArena, BOX COLLIDERS ARE RETURNED TO colliderSetPool)*/
+void freeSprite(Sprite* sprite)
+{
+	if(sprite->boxColliders != NULL && sprite->nBoxColliders > 0 && sprite->nBoxColliders <= MAX_BOX_COLLIDERS)
+		poolRelease(&colliderSetPool, sprite->boxColliders);
+	sprite->boxColliders = NULL;
+	sprite->nBoxColliders = 0;
+
+	sprite->clips = NULL;
+	sprite->scaleRect = NULL;
+	sprite->frames = NULL;
+	sprite->renderRect = NULL;
+
+	sprite->sheet = NULL;
+}
+
+/*PRINT SDL ERRS*/
+void print_err(const char* msg)
+{
+	printf("%s, %s\n", msg, SDL_GetError());
+}
+
+/*GET SQUARED DISTANCE BETWEN POINTS (x1, y1) and (x2, y2)*/
+int distanceSquared(int x1, int y1, int x2, int y2)
+{
+	int deltaX = x1 - x2;
+	int deltaY = y1 - y2;
+
+	return (deltaX * deltaX) + (deltaY * deltaY);
+}
+
+/*CHECK FOR ACTIVE COLLIDERS IN sprite*/
+bool hasColliders(Sprite sprite)
+{
+	return sprite.collider.w != 0 || sprite.collider.h != 0 || (sprite.boxColliders != NULL && sprite.nBoxColliders != 0) || sprite.circleCollider.r != 0;
+}
+
+/*CHECK textbox IS AT LEAST PARTLY INSIDE camera (ALWAYS IF NULL) HOWEVER MANY LINES IT GROWS UPWARDS, WITHOUT LAYING OUT ITS TEXT*/
+bool textBoxVisible(Textbox* textbox, SDL_Rect* camera)
+{
+	TTF_Font *font;
+	int growth;
+
+	if(camera == NULL)
+		return true;
+
+	font = getFont(&resources, textBoxFont);
+	growth = font != NULL ? TTF_FontHeight(font) * (TEXT_BOX_MAX_LINES - 1) : 0;
+
+	return checkCollision((SDL_Rect){textbox->x, textbox->y - growth, textbox->w, textbox->h + growth}, *camera);
+}
+
+/*RENDER AND RESIZE textbox AND ITS COMPONENTS BASED ON INTERNAL TEXT BUFFER (GROWING UPWARDS ONE LINE HEIGHT PER WRAPPED LINE),
+NOTHING (NOT EVEN THE TEXT LAYOUT) IF IT IS OUTSIDE camera*/
+void renderTextBox(Textbox* textbox)
+{
+	int i, lineHeightOffset;
+	const char *allocSite;
+
+	if(!textBoxVisible(textbox, camera))
+		return;
+
+	allocSite = perfAllocSite("renderTextBox");
+
+	layoutTextBox(textbox);
+	lineHeightOffset = textbox->layout.lineHeight * (textbox->layout.nLines - 1);
+
+	textbox->y -= lineHeightOffset;
+	textbox->h += lineHeightOffset;
+
+	textbox->sprite.x = textbox->x;
+	textbox->sprite.y = textbox->y;
+
+	setScaleRect(&textbox->sprite, textbox->sprite.w, textbox->h);
+
+	renderSprite(textbox->sprite, camera);
+
+	for(i = 0; i < textbox->layout.nLines; i++)
+		render(&textbox->layout.lines[i], textbox->x+TEXT_BOX_PADDING, textbox->y+TEXT_BOX_PADDING+(i*textbox->layout.lineHeight), NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
+
+	perfAllocSite(allocSite);
+}
+
+/*WRAP textbox TEXT TO ITS WIDTH AND RENDER ONE TEXTURE PER LINE, UNLESS THE CACHED LAYOUT ALREADY MATCHES TEXT, COLOR AND WIDTH*/
+void layoutTextBox(Textbox* textbox)
+{
+	TextLayout *layout = &textbox->layout;
+	TTF_Font *font = getFont(&resources, textBoxFont);
+	char line[TEXT_BOX_BUFFER_SIZE];
+	int starts[TEXT_BOX_MAX_LINES], lens[TEXT_BOX_MAX_LINES];
+	int i, nLines, wrapWidth = textbox->w - 2*TEXT_BOX_PADDING;
+
+	if(font == NULL){ //stale or failed font handle: nothing to draw the text with, leave the layout empty
+		for(i = 0; i < layout->nLines; i++)
+			setTextureSurface(&layout->lines[i], NULL);
+
+		layout->nLines = 0;
+		layout->width = layout->lineHeight = layout->lastLineWidth = 0;
+		return;
+	}
+
+	if(layout->nLines > 0 && layout->wrapWidth == wrapWidth && strcmp(layout->text, textbox->textBuffer) == 0 &&
+		layout->color.r == textbox->textColor.r && layout->color.g == textbox->textColor.g &&
+		layout->color.b == textbox->textColor.b && layout->color.a == textbox->textColor.a)
+		return;
+
+	nLines = wrapText(font, textbox->textBuffer, wrapWidth, starts, lens, TEXT_BOX_MAX_LINES);
+
+	//line textures are replaced in place, their SDL textures swapped wherever the render commands get replayed
+	for(i = nLines; i < layout->nLines; i++)
+		setTextureSurface(&layout->lines[i], NULL);
+
+	layout->nLines = nLines;
+	layout->width = layout->lineHeight = 0;
+
+	for(i = 0; i < layout->nLines; i++)
+	{
+		SDL_memcpy(line, textbox->textBuffer + starts[i], lens[i]);
+		line[lens[i]] = '\0';
+
+		setTextureSurface(&layout->lines[i], renderTextSurface(line, textbox->textColor, font));
+		layout->width = SDL_max(layout->width, layout->lines[i].w);
+		layout->lineHeight = SDL_max(layout->lineHeight, layout->lines[i].h);
+	}
+
+	//empty lines still render a blank glyph
+	layout->lastLineWidth = lens[layout->nLines-1] > 0 ? layout->lines[layout->nLines-1].w : 0;
+
+	strcpy(layout->text, textbox->textBuffer);
+	layout->color = textbox->textColor;
+	layout->wrapWidth = wrapWidth;
+}
+
+/*DESTROY layout'S LINE TEXTURES (ALSO LINES DROPPED BY A LAYOUT WHOSE COMMANDS WERE NEVER REPLAYED) AND EMPTY IT*/
+void freeTextLayout(TextLayout* layout)
+{
+	int i;
+
+	for(i = 0; i < TEXT_BOX_MAX_LINES; i++){
+		if(layout->lines[i].texture != NULL)
+			SDL_DestroyTexture(layout->lines[i].texture);
+		layout->lines[i].texture = NULL;
+	}
+
+	layout->nLines = 0;
+	layout->width = layout->lineHeight = layout->lastLineWidth = 0;
+}
+
+/*SPLIT text INTO AT MOST maxLines LINES NO WIDER THAN wrapWidth PIXELS IN font, BREAKING AT '\n', AFTER THE LAST WORD THAT FITS
+ *OR (SINGLE LONG WORDS) BETWEEN CODEPOINTS, NEVER INSIDE ONE. LINE i IS lens[i] BYTES FROM starts[i], RETURN LINES (AT LEAST 1, NONE WITHOUT A font)*/
+int wrapText(TTF_Font* font, const char* text, int wrapWidth, int* starts, int* lens, int maxLines)
+{
+	char line[TEXT_BOX_BUFFER_SIZE];
+	int n = 0, start = 0, end, next, space, w, h;
+
+	if(font == NULL)
+		return 0;
+
+	while(n < maxLines)
+	{
+		space = -1;
+
+		for(end = start; text[end] != '\0' && text[end] != '\n'; end = next)
+		{
+			next = utf8Next(text, end);
+			if(next - start >= TEXT_BOX_BUFFER_SIZE)
+				break;
+
+			SDL_memcpy(line, text + start, next - start);
+			line[next - start] = '\0';
+
+			w = 0;
+			if(TTF_SizeUTF8(font, line, &w, &h) == 0 && w > wrapWidth && end > start){
+				if(space > start && text[end] != ' ') //overflowing on a space still breaks after the word
+					end = space;
+				break;
+			}
+
+			if(text[end] == ' ')
+				space = end;
+		}
+
+		starts[n] = start;
+		lens[n] = end - start;
+		n++;
+
+		if(text[end] == '\0')
+			break;
+
+		if(text[end] == '\n'){
+			start = end + 1;
+		}
+		else{ //wrapped lines don't start with the spaces they broke at
+			for(start = end; text[start] == ' '; start++);
+			if(text[start] == '\0')
+				break;
+		}
+	}
+
+	return n;
+}
+
+/*BYTE INDEX OF THE CODEPOINT AFTER THE ONE STARTING AT text[i] (STRAY CONTINUATION BYTES COUNT AS ONE EACH)*/
+int utf8Next(const char* text, int i)
+{
+	if(text[i] == '\0')
+		return i;
+
+	for(i++; (text[i] & 0xC0) == 0x80; i++);
+
+	return i;
+}
+
+/*BYTE INDEX OF THE CODEPOINT BEFORE text[i]*/
+int utf8Prev(const char* text, int i)
+{
+	if(i <= 0)
+		return 0;
+
+	for(i--; i > 0 && (text[i] & 0xC0) == 0x80; i--);
+
+	return i;
+}
+
+/*LONGEST PREFIX OF THE len BYTES OF text THAT FITS maxBytes WITHOUT CUTTING A CODEPOINT*/
+int utf8Fit(const char* text, int len, int maxBytes)
+{
+	if(len <= maxBytes)
+		return len;
+
+	for(len = maxBytes; len > 0 && (text[len] & 0xC0) == 0x80; len--);
+
+	return len;
+}
+
+/*DRAW THE TILE SHEET'S SINE WAVE AT startPeriod (ONLY ITS BAND OF ROWS IS REDRAWN AND UPLOADED, NOTHING IF THE PHASE IS THE SAME)*/
+void addSineWaveTexture(TileMap* map, int startPeriod)
+{
+	SDL_Surface *surface;
+	SDL_Rect band;
+	Uint32 phase;
+	int x, y, top, middle;
+
+	if(tileWave.canvas.texture != map->sheet && !initSineWave(&tileWave, map->sheet, getTexturePixels(&resources, tileSheet), green))
+		return;
+
+	if(startPeriod == tileWave.period)
+		return;
+
+	surface = tileWave.canvas.surface;
+	middle = surface->h / 2;
+	band = (SDL_Rect){0, middle - (SINE_WAVE_AMPLITUDE - 1), surface->w, 2 * (SINE_WAVE_AMPLITUDE - 1) + SINE_WAVE_THICKNESS};
+
+	copyPixelCanvas(&tileWave.canvas, tileWave.original, band); //erases the previous wave
+
+	for(x = 0; x < surface->w; x++)
+	{
+		phase = (Uint32)(((Uint32)((x + startPeriod) / SINE_WAVE_STEP) * tileWave.phaseStep) >> 32) & (SINE_WAVE_LUT_SIZE - 1);
+		top = middle - tileWave.offsets[phase];
+
+		for(y = SDL_max(top, 0); y < top + SINE_WAVE_THICKNESS && y < surface->h; y++)
+			((Uint32*)((Uint8*)surface->pixels + y * surface->pitch))[x] = tileWave.color;
+	}
+
+	flushPixelCanvas(&tileWave.canvas);
+	tileWave.period = startPeriod;
+}
+
+/*SET wave UP ON PIXEL STREAMING texture FROM ITS ORIGINAL pixels (32 BITS PER PIXEL, KEPT BY THE CALLER), DRAWN IN color*/
+bool initSineWave(SineWave* wave, Texture* texture, SDL_Surface* pixels, SDL_Color color)
+{
+	int i;
+
+	freeSineWave(wave);
+
+	if(pixels == NULL || pixels->format->BytesPerPixel != 4 || !createPixelCanvas(&wave->canvas, texture, pixels))
+		return false;
+
+	wave->original = pixels;
+	wave->color = SDL_MapRGB(wave->canvas.surface->format, color.r, color.g, color.b);
+	wave->phaseStep = (Uint64)(SINE_WAVE_LUT_SIZE / (2 * M_PI) * 4294967296.0);
+
+	//entries sampled in the middle of the phases they cover
+	for(i = 0; i < SINE_WAVE_LUT_SIZE; i++)
+		wave->offsets[i] = (Sint8)(sin((i + 0.5) * 2 * M_PI / SINE_WAVE_LUT_SIZE) * SINE_WAVE_AMPLITUDE);
+
+	return true;
+}
+
+/*FREE wave'S CANVAS (THE TEXTURE KEEPS THE LAST WAVE DRAWN)*/
+void freeSineWave(SineWave* wave)
+{
+	freePixelCanvas(&wave->canvas);
+	wave->original = NULL;
+	wave->period = -1;
+}
+
+/*RENDER PRINTABLE ASCII GLYPHS OF font ONCE INTO A SINGLE WHITE SHEET (TINTED BY COLOR MOD AT RENDER TIME)*/
+bool loadGlyphCache(GlyphCache* cache, TTF_Font* font)
+{
+	SDL_Surface *glyphs[HUD_N_GLYPHS], *sheetSurface;
+	SDL_Color white = {255, 255, 255, 255};
+	int i, minX, maxX, minY, maxY, x = 0, w = 0, h = 0;
+
+	for(i = 0; i < HUD_N_GLYPHS; i++)
+	{
+		glyphs[i] = TTF_RenderGlyph_Blended(font, HUD_FIRST_GLYPH + i, white);
+
+		if(TTF_GlyphMetrics(font, HUD_FIRST_GLYPH + i, &minX, &maxX, &minY, &maxY, &cache->advances[i]) != 0)
+			cache->advances[i] = glyphs[i] != NULL ? glyphs[i]->w : 0;
+
+		if(glyphs[i] != NULL){
+			w += glyphs[i]->w;
+			h = glyphs[i]->h > h ? glyphs[i]->h : h;
+		}
+	}
+
+	sheetSurface = SDL_CreateRGBSurfaceWithFormat(0, w > 0 ? w : 1, h > 0 ? h : 1, 32, SDL_PIXELFORMAT_RGBA32);
+
+	for(i = 0; i < HUD_N_GLYPHS; i++)
+	{
+		if(glyphs[i] == NULL){
+			cache->clips[i] = (SDL_Rect){0, 0, 0, 0};
+			continue;
+		}
+
+		cache->clips[i] = (SDL_Rect){x, 0, glyphs[i]->w, glyphs[i]->h};
+		x += glyphs[i]->w;
+
+		if(sheetSurface != NULL){
+			SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(glyphs[i], NULL, sheetSurface, &cache->clips[i]);
+		}
+
+		SDL_FreeSurface(glyphs[i]);
+	}
+
+	if(sheetSurface == NULL){
+		print_err("Could not create glyph sheet surface");
+		return false;
+	}
+
+	cache->sheet = (Texture){SDL_CreateTextureFromSurface(renderer, sheetSurface), "", sheetSurface->w, sheetSurface->h, false, NULL, 0};
+	cache->lineHeight = TTF_FontLineSkip(font);
+	SDL_FreeSurface(sheetSurface);
+
+	if(cache->sheet.texture == NULL){
+		print_err("Unable to load glyph sheet texture");
+		return false;
+	}
+
+	return true;
+}
+
+/*RENDER text FROM CACHED GLYPHS AT SCREEN POSITION (x,y) TINTED BY color, RETURN RENDERED WIDTH*/
+int renderGlyphText(GlyphCache* cache, const char* text, int x, int y, SDL_Color color)
+{
+	SDL_Rect dst;
+	int glyph, startX = x;
+
+	drawTextureColorMod(&cache->sheet, color);
+
+	for(; *text != '\0'; text++)
+	{
+		glyph = (unsigned char)*text - HUD_FIRST_GLYPH;
+
+		if(glyph < 0 || glyph >= HUD_N_GLYPHS)
+			glyph = '?' - HUD_FIRST_GLYPH;
+
+		dst = (SDL_Rect){x, y, cache->clips[glyph].w, cache->clips[glyph].h};
+		drawTexture(&cache->sheet, &cache->clips[glyph], dst, 0, NULL, SDL_FLIP_NONE);
+		x += cache->advances[glyph];
+	}
+
+	return x - startX;
+}
+
+/*DROP ALL LEVEL LIFETIME DATA, KEEPING levelArena'S FIRST BLOCK FOR THE NEXT LEVEL*/
+void resetLevelMemory()
+{
+	poolReset(&colliderSetPool);
+	arenaReset(&levelArena);
+}
+
+/*RELEASE ALL LEVEL LIFETIME DATA (SPRITE CLIPS, SCALE RECTS, COLLIDER SETS, TILE MAP) AND THE FRAME SCRATCH ARENA AT ONCE*/
+void freeLevelMemory()
+{
+	poolReset(&colliderSetPool);
+	arenaFree(&levelArena);
+	arenaFree(&frameArena);
+}
@@ -0,0 +1,237 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include <string.h>
+#include "SDL2/SDL.h" 
+#include "SDL2/SDL_image.h"
+#include "SDL2/SDL_ttf.h"
+#include "alloc.h"
+
+#define LEVEL_WIDTH 1980
+#define LEVEL_HEIGHT 990
+
+#define SCREEN_WIDTH 600
+#define SCREEN_HEIGHT 600
+
+#define SHEET_STANDARD_SPRITE_SIZE 194
+
+#define TILE_MAP_READ_CHUNK 16384
+#define MAX_BOX_COLLIDERS 8
+
+#define TEXT_BOX_BUFFER_SIZE 20
+#define TEXT_BOX_MAX_LINES 8   //wrapped lines kept per textbox, the rest of the text is not shown
+#define TEXT_BOX_PADDING 10
+
+#define SINE_WAVE_LUT_SIZE 1024   //phases per 2*PI, power of two
+#define SINE_WAVE_AMPLITUDE 5
+#define SINE_WAVE_THICKNESS 5
+#define SINE_WAVE_STEP 5          //columns sharing a phase
+
+#define HUD_FIRST_GLYPH 32
+#define HUD_N_GLYPHS 95
+
+typedef struct{
+    SDL_Texture *texture;
+    const char *filename;
+	int w;
+	int h;
+	bool pixelstream;
+	void *pixels;
+	int pitch;
+} Texture;
+
+//resources.h handles: slot in the low 16 bits, slot generation above, 0 when nothing is held. a released handle
+//stops resolving even if its slot is reused, so stale handles get NULL instead of another resource
+typedef struct{ Uint32 id; } TextureHandle;
+typedef struct{ Uint32 id; } FontHandle;
+typedef struct{ Uint32 id; } SoundHandle;
+
+typedef struct{
+	int x, y;
+	int r;
+} Circle;
+
+typedef struct Sprite{
+    SDL_Rect *clips;
+	SDL_Rect *renderRect;
+	SDL_Rect collider;
+	SDL_Rect *boxColliders;
+	Circle circleCollider;
+	Texture *sheet;
+	SDL_Rect *scaleRect;
+	SDL_Rect *frames;       //per clip: untrimmed size and where the clip sits inside it (atlas clips), NULL: clips are whole frames
+	SDL_Point *center;
+	SDL_RendererFlip flip;
+	int nClips;
+	int nBoxColliders;
+	int x, y, w, h;
+	int velX, velY;
+	int frame;
+	double angle;
+	void (*collisionHandler)(void*);
+} Sprite;
+
+//wrapped lines of a textbox rendered once, rebuilt only when its text, color or wrap width change
+typedef struct{
+	Texture lines[TEXT_BOX_MAX_LINES];
+	int nLines;             //0: not built yet
+	int width;              //widest line
+	int lineHeight;
+	int lastLineWidth;      //where a cursor after the text goes
+	char text[TEXT_BOX_BUFFER_SIZE];
+	SDL_Color color;
+	int wrapWidth;
+} TextLayout;
+
+typedef struct{
+	Sprite sprite;
+	TextLayout layout;
+	SDL_Color textColor;
+	char textBuffer[TEXT_BOX_BUFFER_SIZE];
+	int x, y, w, h;
+} Textbox;
+
+typedef struct{
+	SDL_Rect boxes[MAX_BOX_COLLIDERS];
+} ColliderSet;
+
+typedef struct{
+	int type;
+	SDL_Rect renderRect;
+	SDL_Rect collider;
+	bool solid;
+	bool visible;
+	int x, y, w, h;
+} Tile;
+
+typedef struct{
+	Tile *tiles;
+	int size;
+	int capacity;
+	int cols, rows;
+	int tileW, tileH;
+	Texture *sheet;
+	SDL_Rect *tileClips;
+	int nTileTypes;
+} TileMap;
+
+typedef struct{
+	Texture sheet;
+	SDL_Rect clips[HUD_N_GLYPHS];
+	int advances[HUD_N_GLYPHS];
+	int lineHeight;
+} GlyphCache;
+
+//CPU copy of a pixel streaming texture, drawn into directly. flushPixelCanvas uploads only the bounding rect of what was
+//marked since the last flush (SDL_UpdateTexture), the rest of the texture is never locked or sent again
+typedef struct{
+	Texture *texture;
+	SDL_Surface *surface;   //same size and pixel format as texture
+	SDL_Rect dirty;         //empty: texture is up to date
+} PixelCanvas;
+
+//wave drawn across the tile sheet: a band of rows restored from the original pixels and redrawn when the phase changes
+typedef struct{
+	PixelCanvas canvas;
+	SDL_Surface *original;              //resources' CPU copy of the sheet
+	Uint32 color;                       //in the canvas format
+	int period;                         //startPeriod drawn last, -1: none
+	Uint64 phaseStep;                   //LUT entries per radian, 32.32 fixed point
+	Sint8 offsets[SINE_WAVE_LUT_SIZE];  //rows the wave sits above the sheet's middle, per phase
+} SineWave;
+
+enum TileTypeEnum
+{
+	UNDEFINED = -1,
+	EMPTY,
+	STANDARD_BLOCK,
+	N_TILE_TYPES
+};
+
+SDL_Surface* loadSurface(const char* path);
+SDL_Surface* loadPixelSurface(const char* path);
+Texture loadTexture(const char* path, SDL_Color* colorKey);
+Texture loadPixelTexture(const char* path);
+Texture createSurfaceTexture(SDL_Surface* surface, const char* path, SDL_Color* colorKey);
+Texture createPixelTexture(SDL_Surface* surface, const char* path);
+SDL_Surface* renderTextSurface(const char* text, SDL_Color color, TTF_Font* font);
+Texture loadRenderedText(const char* text, SDL_Color color, TTF_Font* font);
+Tile loadTile(int type, SDL_Rect renderRect, bool solid, bool visible);
+TileMap loadTileMap(int size, const char *tileFileName, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes);
+TileMap createTileMap(int size, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes);
+void addTileMapTile(TileMap* map, int col, int type);
+void endTileMapRow(TileMap* map, int nCols);
+void freeTileMap(TileMap* map);
+bool getTileMapCells(TileMap map, SDL_Rect area, SDL_Rect* cells);
+void render(Texture* texture, int x, int y, SDL_Rect* clip, SDL_Rect* scaleRect, double angle, SDL_Point* center, SDL_RendererFlip flip, SDL_Rect* camera);
+bool checkCollision(SDL_Rect a, SDL_Rect b);
+bool checkInnerBoxesCollisions(SDL_Rect* boxCollidersA, int nBoxesA, SDL_Rect* boxCollidersB, int nBoxesB);
+void shiftBoxColliders(Sprite* sprite, int velX, int velY);
+bool checkCircularCollision(Sprite a, Sprite b);
+bool checkLevelBoundsCollision(Sprite sprite);
+bool checkTileMapCollisions(Sprite sprite);
+bool lockPixelTexture(Texture* texture);
+bool unlockPixelTexture(Texture* texture);
+bool createPixelCanvas(PixelCanvas* canvas, Texture* texture, SDL_Surface* pixels);
+void markPixelCanvas(PixelCanvas* canvas, SDL_Rect rect);
+void copyPixelCanvas(PixelCanvas* canvas, SDL_Surface* source, SDL_Rect rect);
+bool flushPixelCanvas(PixelCanvas* canvas);
+void freePixelCanvas(PixelCanvas* canvas);
+
+Sprite loadSprite(int nClips, Texture* sheet, int x, int y, double angle, SDL_Point* center, SDL_RendererFlip flip, void (*collisionHandler)(void*));
+Textbox loadTextBox(const char* defaultText, SDL_Color textColor);
+bool setBoxColliders(Sprite* sprite, int n);
+void setDefaultCollider(Sprite* sprite);
+void addClip(Sprite* sprite, int index, SDL_Rect clip, bool setRender);
+void setScaleRect(Sprite* sprite, int w, int h);
+void setClipFrame(Sprite* sprite, int index, SDL_Rect frame);
+void setRenderRect(Sprite* sprite, int index);
+void updateSpriteSize(Sprite* sprite);
+
+void move(Sprite* sprite, Sprite** spritesColliding, int nSpritesColliding);
+void moveTo(Sprite* sprite, SDL_Point pos);
+void moveAllColliders(Sprite* sprite, int velX, int velY);
+void animate(Sprite* sprite, int delayFactor);
+void animateVisible(Sprite* sprite, int delayFactor, SDL_Rect* camera);
+SDL_Rect getSpriteBounds(Sprite sprite);
+bool spriteVisible(Sprite sprite, SDL_Rect* camera);
+void renderSprite(Sprite sprite, SDL_Rect* camera);
+void renderTile(TileMap map, int index, SDL_Rect* camera);
+void renderTileMap(TileMap map, SDL_Rect* camera);
+void renderColliders(Sprite sprite, SDL_Rect* camera, SDL_Color color);
+void freeSprite(Sprite* sprite);
+void resetLevelMemory();
+void freeLevelMemory();
+
+bool textBoxVisible(Textbox* textbox, SDL_Rect* camera);
+void renderTextBox(Textbox* textbox);
+void layoutTextBox(Textbox* textbox);
+void freeTextLayout(TextLayout* layout);
+int wrapText(TTF_Font* font, const char* text, int wrapWidth, int* starts, int* lens, int maxLines);
+int utf8Next(const char* text, int i);
+int utf8Prev(const char* text, int i);
+int utf8Fit(const char* text, int len, int maxBytes);
+void addSineWaveTexture(TileMap* map, int startPeriod);
+bool initSineWave(SineWave* wave, Texture* texture, SDL_Surface* pixels, SDL_Color color);
+void freeSineWave(SineWave* wave);
+bool loadGlyphCache(GlyphCache* cache, TTF_Font* font);
+int renderGlyphText(GlyphCache* cache, const char* text, int x, int y, SDL_Color color);
+void print_err(const char* msg);
+int distanceSquared(int x1, int y1, int x2, int y2);
+bool hasColliders(Sprite sprite);
+
+extern SDL_Window *window;
+extern SDL_Renderer *renderer;
+extern SDL_Rect *camera;
+extern TextureHandle textBoxSheet, tileSheet; //tileSheet keeps its original pixels (getTexturePixels) for redrawing
+extern TileMap map;
+extern SineWave tileWave;
+extern int levelWidth, levelHeight;
+extern Pool colliderSetPool;
+extern FontHandle textBoxFont;
+extern SDL_Color black, yellow, green, lightBlack;
+
+#endif
@@ -0,0 +1,284 @@
+#include "levelgen.h"
+
+bool generateArena(LevelSpec spec, char* row, LevelRowHandler rowHandler, void* data);
+bool generateMaze(LevelSpec spec, char* row, LevelRowHandler rowHandler, void* data);
+int findLevelSet(int* parent, int set);
+bool writeLevelRow(const char* row, int cols, void* data);
+bool addTileMapRow(const char* row, int cols, void* data);
+
+/*NEXT PSEUDO RANDOM NUMBER FROM state (SPLITMIX64, SAME SEQUENCE ON EVERY PLATFORM UNLIKE rand())*/
+Uint64 levelRandom(Uint64* state)
+{
+	Uint64 z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+/*GENERATE LEVEL DESCRIBED BY spec, HANDING EACH ROW OF TILE CHARS TO rowHandler (ONLY ONE ROW IS KEPT IN MEMORY)*/
+bool generateLevel(LevelSpec spec, LevelRowHandler rowHandler, void* data)
+{
+	char *row;
+	bool success;
+
+	if(spec.cols <= 0 || spec.rows <= 0 || spec.kind < 0 || spec.kind >= N_LEVEL_KINDS){
+		print_err("Invalid level spec");
+		return false;
+	}
+
+	row = (char*)SDL_malloc(spec.cols + 1);
+	if(row == NULL){
+		print_err("Could not allocate level row");
+		return false;
+	}
+	row[spec.cols] = '\0';
+
+	if(spec.kind == LEVEL_ARENA)
+		success = generateArena(spec, row, rowHandler, data);
+	else
+		success = generateMaze(spec, row, rowHandler, data);
+
+	SDL_free(row);
+
+	return success;
+}
+
+/*OPEN ARENA: WALLED BORDER, INNER TILES ARE WALLS WITH wallPercent CHANCE*/
+bool generateArena(LevelSpec spec, char* row, LevelRowHandler rowHandler, void* data)
+{
+	Uint64 state = spec.seed;
+	int x, y;
+
+	for(y = 0; y < spec.rows; y++)
+	{
+		for(x = 0; x < spec.cols; x++){
+			if(x == 0 || y == 0 || x == spec.cols-1 || y == spec.rows-1 || (int)(levelRandom(&state) % 100) < spec.wallPercent)
+				row[x] = LEVEL_WALL_CHAR;
+			else
+				row[x] = LEVEL_FLOOR_CHAR;
+		}
+
+		if(!rowHandler(row, spec.cols, data))
+			return false;
+	}
+
+	return true;
+}
+
+/*MAZE WITH CELLS ON ODD TILES, BUILT ROW BY ROW (ELLER'S ALGORITHM) SO MEMORY ONLY GROWS WITH spec.cols.
+ *WALLS THE MAZE WOULD KEEP ARE OPENED WITH (100 - wallPercent) CHANCE, ADDING LOOPS*/
+bool generateMaze(LevelSpec spec, char* row, LevelRowHandler rowHandler, void* data)
+{
+	Uint64 state = spec.seed;
+	int nCellCols = (spec.cols - 1) / 2, nCellRows = (spec.rows - 1) / 2;
+	int *sets, *parent, *remap, *lastCell;
+	bool *right, *down, *hasDown, lastRow, join, success = true;
+	int cx, cy, y, a, b, nextSet;
+
+	SDL_memset(row, LEVEL_WALL_CHAR, spec.cols);
+
+	if(nCellCols < 1 || nCellRows < 1){ //too small for a single cell, solid block
+		for(y = 0; y < spec.rows && success; y++)
+			success = rowHandler(row, spec.cols, data);
+		return success;
+	}
+
+	//set labels stay below 2*nCellCols: at most nCellCols carried down plus nCellCols new ones per row
+	sets = (int*)SDL_malloc(sizeof(int) * 7 * nCellCols);
+	right = (bool*)SDL_malloc(sizeof(bool) * 4 * nCellCols);
+	if(sets == NULL || right == NULL){
+		print_err("Could not allocate maze rows");
+		SDL_free(sets);
+		SDL_free(right);
+		return false;
+	}
+	parent = sets + nCellCols;
+	remap = parent + 2 * nCellCols;
+	lastCell = remap + 2 * nCellCols;
+	down = right + nCellCols;
+	hasDown = down + nCellCols;
+
+	for(cx = 0; cx < nCellCols; cx++)
+		sets[cx] = -1;
+	nextSet = 0;
+
+	success = rowHandler(row, spec.cols, data); //top wall
+
+	for(cy = 0; cy < nCellRows && success; cy++)
+	{
+		lastRow = cy == nCellRows - 1;
+
+		for(cx = 0; cx < 2 * nCellCols; cx++)
+			parent[cx] = cx;
+
+		for(cx = 0; cx < nCellCols; cx++){
+			if(sets[cx] < 0)
+				sets[cx] = nextSet++;
+		}
+
+		//join right neighbours of different sets (always on the last row so the maze stays connected)
+		for(cx = 0; cx < nCellCols; cx++)
+		{
+			right[cx] = false;
+			if(cx == nCellCols - 1)
+				continue;
+
+			a = findLevelSet(parent, sets[cx]);
+			b = findLevelSet(parent, sets[cx+1]);
+			join = a != b && (lastRow || levelRandom(&state) % 2 == 0);
+
+			if(!join && (int)(levelRandom(&state) % 100) >= spec.wallPercent)
+				join = true;
+
+			if(join){
+				right[cx] = true;
+				if(a != b)
+					parent[b] = a;
+			}
+		}
+
+		for(cx = 0; cx < nCellCols; cx++)
+			sets[cx] = findLevelSet(parent, sets[cx]);
+
+		//carry every set at least once into the next row
+		if(!lastRow)
+		{
+			for(cx = 0; cx < 2 * nCellCols; cx++)
+				hasDown[cx] = false;
+
+			for(cx = 0; cx < nCellCols; cx++){
+				down[cx] = levelRandom(&state) % 2 == 0;
+				lastCell[sets[cx]] = cx;
+				if(down[cx])
+					hasDown[sets[cx]] = true;
+			}
+
+			for(cx = 0; cx < nCellCols; cx++){
+				if(!hasDown[sets[cx]] && lastCell[sets[cx]] == cx)
+					down[cx] = true;
+				else if(!down[cx] && (int)(levelRandom(&state) % 100) >= spec.wallPercent)
+					down[cx] = true;
+			}
+		}
+
+		//cell row
+		SDL_memset(row, LEVEL_WALL_CHAR, spec.cols);
+		for(cx = 0; cx < nCellCols; cx++){
+			row[1 + 2*cx] = LEVEL_FLOOR_CHAR;
+			if(right[cx])
+				row[2 + 2*cx] = LEVEL_FLOOR_CHAR;
+		}
+		success = rowHandler(row, spec.cols, data);
+
+		//passages down (bottom wall after the last row)
+		SDL_memset(row, LEVEL_WALL_CHAR, spec.cols);
+		for(cx = 0; cx < nCellCols && !lastRow; cx++){
+			if(down[cx])
+				row[1 + 2*cx] = LEVEL_FLOOR_CHAR;
+		}
+		success = success && rowHandler(row, spec.cols, data);
+
+		//relabel carried sets from 0, cells not carried start a new set
+		if(!lastRow)
+		{
+			for(cx = 0; cx < 2 * nCellCols; cx++)
+				remap[cx] = -1;
+
+			nextSet = 0;
+			for(cx = 0; cx < nCellCols; cx++){
+				if(!down[cx]){
+					sets[cx] = -1;
+					continue;
+				}
+				if(remap[sets[cx]] < 0)
+					remap[sets[cx]] = nextSet++;
+				sets[cx] = remap[sets[cx]];
+			}
+		}
+	}
+
+	//even row count leaves one extra wall row
+	SDL_memset(row, LEVEL_WALL_CHAR, spec.cols);
+	for(y = 1 + 2 * nCellRows; y < spec.rows && success; y++)
+		success = rowHandler(row, spec.cols, data);
+
+	SDL_free(sets);
+	SDL_free(right);
+
+	return success;
+}
+
+/*ROOT OF set IN THE CURRENT MAZE ROW (PATH HALVING)*/
+int findLevelSet(int* parent, int set)
+{
+	while(parent[set] != set){
+		parent[set] = parent[parent[set]];
+		set = parent[set];
+	}
+
+	return set;
+}
+
+/*WRITE LEVEL DESCRIBED BY spec TO path IN THE loadTileMap FORMAT (ONE ROW PER LINE)*/
+bool generateLevelFile(LevelSpec spec, const char* path)
+{
+	SDL_RWops *file = SDL_RWFromFile(path, "w");
+	bool success;
+
+	if(file == NULL){
+		print_err("Could not open level file for writing");
+		return false;
+	}
+
+	success = generateLevel(spec, writeLevelRow, file);
+
+	if(SDL_RWclose(file) != 0)
+		success = false;
+
+	return success;
+}
+
+bool writeLevelRow(const char* row, int cols, void* data)
+{
+	SDL_RWops *file = (SDL_RWops*)data;
+
+	return SDL_RWwrite(file, row, 1, cols) == (size_t)cols && SDL_RWwrite(file, "\n", 1, 1) == 1;
+}
+
+/*BUILD TILE MAP DESCRIBED BY spec DIRECTLY IN MEMORY (SAME TILES AS loadTileMap ON ITS generateLevelFile OUTPUT)*/
+TileMap generateTileMap(LevelSpec spec, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes)
+{
+	TileMap map = createTileMap(spec.cols * spec.rows, tileSheet, tileClips, nTileTypes);
+
+	if(map.capacity > 0)
+		generateLevel(spec, addTileMapRow, &map);
+
+	return map;
+}
+
+bool addTileMapRow(const char* row, int cols, void* data)
+{
+	TileMap *map = (TileMap*)data;
+	int x;
+
+	for(x = 0; x < cols; x++)
+		addTileMapTile(map, x, row[x] - '0');
+
+	endTileMapRow(map, cols);
+
+	return true;
+}
+
+/*LEVEL KIND NAMED name ("maze" OR "arena"), N_LEVEL_KINDS IF UNKNOWN*/
+LevelKindEnum levelKindFromName(const char* name)
+{
+	if(SDL_strcmp(name, "maze") == 0)
+		return LEVEL_MAZE;
+
+	if(SDL_strcmp(name, "arena") == 0)
+		return LEVEL_ARENA;
+
+	return N_LEVEL_KINDS;
+}
@@ -0,0 +1,30 @@
+#ifndef LEVELGEN_H
+#define LEVELGEN_H
+
+#include "engine.h"
+
+#define LEVEL_WALL_CHAR '1'
+#define LEVEL_FLOOR_CHAR '0'
+
+typedef enum{
+	LEVEL_MAZE,
+	LEVEL_ARENA,
+	N_LEVEL_KINDS
+} LevelKindEnum;
+
+typedef struct{
+	LevelKindEnum kind;
+	int cols, rows;    //size in tiles
+	int wallPercent;   //maze: chance (0-100) a wall the maze would keep stays closed (100 = perfect maze), arena: chance an inner tile is a wall
+	Uint64 seed;
+} LevelSpec;
+
+typedef bool (*LevelRowHandler)(const char* row, int cols, void* data);
+
+Uint64 levelRandom(Uint64* state);
+bool generateLevel(LevelSpec spec, LevelRowHandler rowHandler, void* data);
+bool generateLevelFile(LevelSpec spec, const char* path);
+TileMap generateTileMap(LevelSpec spec, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes);
+LevelKindEnum levelKindFromName(const char* name);
+
+#endif
@@ -1,110 +1,70 @@
-#include <stdio.h>
-#include <stdbool.h>
-#include <math.h>
-#include <string.h>
 #include <time.h>
-#include "SDL2/SDL.h" 
-#include "SDL2/SDL_image.h"
-#include "SDL2/SDL_ttf.h"
+#include "engine.h"
+#include "perf.h"
+#include "levelgen.h"
+#include "ringbuffer.h"
+#include "wavstream.h"
+#include "waveform.h"
+#include "mixer.h"
+#include "audioconvert.h"
+#include "adpcm.h"
+#include "savefile.h"
+#include "assetloader.h"
+#include "resources.h"
+#include "atlas.h"
+#include "commandbuffer.h"
+#include "debugdraw.h"
+#include "resolution.h"
+#include "dirtyrect.h"
 #include "SDL2/SDL_mixer.h"
 
-#define LEVEL_WIDTH 1980
-#define LEVEL_HEIGHT 990
-
-#define SCREEN_WIDTH 600
-#define SCREEN_HEIGHT 600
-
 #define DELAY_MS 2000
 
-#define SHEET_PATH "imgs/sheet.png"
+#define ATLAS_PATH "imgs/atlas.txt"     //make atlas
+#define SPRITES_PATH "imgs/sprites.txt" //the same clips on their source images
 #define TILE_SHEET_PATH "imgs/tiles.png"
 #define BACKGROUND_PATH "imgs/back.png"
 #define TEXT_BOX_PATH "imgs/txtbox.png"
-#define RECORDER_BUTTON_PATH "imgs/recorder_button.png"
-#define SOUND_WAVE_PATH "imgs/sound_wave.png"
-#define SPARKLES_PATH "imgs/sparkles_mini.png"
-#define POWER_PELLET_PATH "imgs/power.png"
 #define TITLE_FONT_PATH "fonts/pac.ttf"
 #define TEXT_BOX_FONT_PATH "fonts/slkscr.ttf"
 #define WAKA_PATH "sounds/waka.wav"
 #define SAVE_FILE_PATH "data/pac_dialog_sf.txt"
 #define TILE_MAP_FILE "data/level.map"
-#define SAVE_FILE_DELIMITER '\n'
 #define SAVED_PROMPT_STR "SAVED!"
 #define MAX_RECORDING_SECONDS 3
+#define STREAM_RECORDING_SECONDS 0 //--record-to default length limit, 0: until the button is pressed again
+#define AUDIO_RING_CALLBACKS 8 //audio callbacks worth of data buffered between the audio and game threads
+#define AUDIO_CONVERT_CHUNK 4096 //bytes converted per step between the audio rings and the clip
+#define AUDIO_CLIP_CHUNK_FRAMES 1024 //clip frames decoded per step when feeding the playback ring
+#define WAVE_RING_PEAKS 1024    //streamed recording peaks buffered between the writer and game threads
+#define WAVE_VIEW_WIDTH 200
+#define WAVE_VIEW_HEIGHT 80
+#define WAVE_DEFAULT_SECONDS 2.0
+#define WAVE_MIN_SECONDS 0.05
+#define WAVE_MAX_SECONDS 3600.0
+#define WAVE_ZOOM_STEP 1.5
 
-#define SHEET_INITIAL_POS_X 76
-#define SHEET_INITIAL_POS_Y 14
-#define SHEET_STANDARD_SPRITE_SIZE 194
 #define TILE_MAP_SIZE ((LEVEL_WIDTH/90) * (LEVEL_HEIGHT/90))
 
 #define PAC_SPEED 10
-#define TEXT_BOX_BUFFER_SIZE 20
 #define TITLE_FONT_SIZE 48
 #define TEXT_BOX_FONT_SIZE 36
-#define TEXT_BOX_MAX_LINE_SIZE 10
 #define AUDIO_DEVICE_NAME_SIZE 30
 #define N_SPARKLES_PARTICLES 40
 #define POWER_UP_SECONDS 10
 
-typedef struct{
-    SDL_Texture *texture;
-    const char *filename;
-	int w;
-	int h;
-	bool pixelstream;
-	void *pixels;
-	int pitch;
-} Texture;
-
-typedef struct{
-	int x, y;
-	int r;
-} Circle;
-
-typedef struct Sprite{
-    SDL_Rect *clips;
-	SDL_Rect *renderRect;
-	SDL_Rect collider;
-	SDL_Rect *boxColliders;
-	Circle circleCollider;
-	Texture *sheet;
-	SDL_Rect *scaleRect;
-	SDL_Point *center;
-	SDL_RendererFlip flip;
-	int nClips;
-	int nBoxColliders;
-	int x, y, w, h;
-	int velX, velY;
-	int frame;
-	double angle;
-	void (*collisionHandler)(void*);
-} Sprite;
-
-typedef struct{
-	Sprite sprite;
-	Texture textTexture;
-	SDL_Color textColor;
-	char textBuffer[TEXT_BOX_BUFFER_SIZE];
-	int x, y, w, h;
-} Textbox;
+#define HUD_FONT_SIZE 14
+#define HUD_REFRESH_MS 250
+#define HUD_N_LINES 6
+#define HUD_LINE_SIZE 72
+#define HUD_GRAPH_WIDTH 240
+#define HUD_GRAPH_HEIGHT 60
+#define HUD_GRAPH_MAX_MS 50
 
-typedef struct{
-	int type;
-	SDL_Rect renderRect;
-	SDL_Rect collider;
-	bool solid;
-	bool visible;
-	int x, y, w, h;
-} Tile;
+#define FRAME_MAX_EVENTS 64 //events handed to one simulated frame, the rest wait in SDL's queue for the next
 
-typedef struct{
-	Tile *tiles;
-	int size;
-	Texture *sheet;
-	SDL_Rect *tileClips;
-	int nTileTypes;
-} TileMap;
+#define STRESS_SPAWN_TRIES 100
+#define STRESS_DEFAULT_SEED 1
 
 typedef enum
 {
@@ -120,14 +80,43 @@ typedef struct{
 	int playbackId;
 	SDL_AudioSpec recordingSpec;
 	SDL_AudioSpec playbackSpec;
-	Uint8 *audioBuffer;
-	int audiobufferSize;
-	int bufferCurrentPos;
-	int bufferMaxPos;
+	AdpcmClip clip;          //in memory recording, IMA-ADPCM encoded as it is captured
+	AdpcmEncoder clipEncoder; //game thread only
+	AdpcmDecoder clipDecoder; //game thread only
+	SDL_AudioSpec clipSpec;  //S16 at the recording rate, mono unless --stereo-clips
+	Uint32 clipMaxFrames;
+	Sint16 clipSamples[AUDIO_CLIP_CHUNK_FRAMES * ADPCM_MAX_CHANNELS]; //decoded, waiting for the playback ring
+	Uint32 clipSamplesPos, clipSamplesLen; //frames
+	const char *streamPath;  //record to/play from this WAV file instead of clip
+	Uint32 streamMaxBytes;   //0: no limit
+	RingBuffer captureRing;  //recording callback -> game thread
+	RingBuffer playbackRing; //game thread -> playback callback
+	RingBuffer peakRing;     //writer thread -> game thread, waveform peaks of streamed recordings
+	AudioConverter clipConverter;     //recordingSpec -> clipSpec, game thread only
+	AudioConverter playbackConverter; //clipSpec -> playbackSpec, game thread only
+	PeakAccumulator waveAccumulator;
+	PeakPyramid waveform;    //game thread only
 	bool available;
 	AudioDeviceStatesEnum state;
 } AudioDevice;
 
+//what the main thread hands the next simulated frame: SDL's event queue and keyboard state belong to it
+typedef struct{
+	SDL_Event events[FRAME_MAX_EVENTS];
+	int nEvents;
+	Uint8 keys[SDL_NUM_SCANCODES]; //keyboard state when the events were polled
+	bool quit;
+} FrameInput;
+
+typedef struct{
+	int nGhosts;            //total ghosts, at least N_GHOSTS (extras clone BLINKY/INKY)
+	bool generatedLevel;    //play on level instead of TILE_MAP_FILE
+	LevelSpec level;
+	Uint32 statsIntervalMs; //0: no frame stats log
+	int maxFrames;          //0: run until quit
+	bool ghostVoices;       //every ghost loops a positional waka on the sfx mixer
+} StressOptions;
+
 enum PacPositionsEnum
 {
 	PAC_CLOSED,
@@ -172,107 +161,98 @@ enum GhostFamilyEnum
 	N_GHOSTS
 };
 
-enum TileTypeEnum
-{
-	UNDEFINED = -1,
-	EMPTY,
-	STANDARD_BLOCK,
-	N_TILE_TYPES
-};
-
+bool parseArgs(int argc, char** argv);
 bool init();
+void pollFrameInput();
+bool simulateFrame(void* data);
 bool loadMedia();
-void close();
-
-SDL_Surface* loadSurface(const char* path);
-SDL_Surface* loadPixelSurface(const char* path);
-Texture loadTexture(const char* path, SDL_Color* colorKey);
-Texture loadPixelTexture(const char* path);
-Texture loadRenderedText(const char* text, SDL_Color color, TTF_Font* font);
-Tile loadTile(int type, SDL_Rect renderRect, bool solid, bool visible);
-TileMap loadTileMap(int size, const char *tileFileName, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes);
-void render(Texture texture, int x, int y, SDL_Rect* clip, SDL_Rect* scaleRect, double angle, SDL_Point* center, SDL_RendererFlip flip, SDL_Rect* camera);
-bool checkCollision(SDL_Rect a, SDL_Rect b);
-bool checkInnerBoxesCollisions(SDL_Rect* boxCollidersA, int nBoxesA, SDL_Rect* boxCollidersB, int nBoxesB);
-void shiftBoxColliders(Sprite* sprite, int velX, int velY);
-bool checkCircularCollision(Sprite a, Sprite b);
-bool checkLevelBoundsCollision(Sprite sprite);
-bool checkTileMapCollisions(Sprite sprite);
-bool lockPixelTexture(Texture* texture);
-bool unlockPixelTexture(Texture* texture);
-
-Sprite loadSprite(int nClips, Texture* sheet, int x, int y, double angle, SDL_Point* center, SDL_RendererFlip flip, void (*collisionHandler)(void*));
-Textbox loadTextBox(const char* defaultText, SDL_Color textColor);
+bool loadStressGhosts();
+SDL_Point findFreeSpot(Sprite sprite, Uint64* rngState);
+void logStressStats(Uint32 elapsedMs);
+void closeGame();
+
 AudioDevice loadAudioDevice(const char* recName, const char* playbackName);
 Sprite loadSparklesSprite(SDL_Point initialPosition);
-void setDefaultCollider(Sprite* sprite);
 void loadSavedText();
-void addClip(Sprite* sprite, int index, SDL_Rect clip, bool setRender);
-void setScaleRect(Sprite* sprite, int w, int h);
-void setRenderRect(Sprite* sprite, int index);
-void updateSpriteSize(Sprite* sprite);
-
-void move(Sprite* sprite, Sprite** spritesColliding, int nSpritesColliding);
-void moveTo(Sprite* sprite, SDL_Point pos);
-void moveAllColliders(Sprite* sprite, int velX, int velY);
-void animate(Sprite* sprite, int delayFactor);
-void renderSprite(Sprite sprite, SDL_Rect* camera);
-void renderTile(TileMap map, int index, SDL_Rect* camera);
-void renderTileMap(TileMap map, SDL_Rect* camera);
-void renderColliders(Sprite sprite, SDL_Rect* camera, SDL_Color color);
-void freeSprite(Sprite* sprite);
 
 void hanndlePacInput();
 void handleTextInput(SDL_Event event);
 void handleAudioInput();
+void feedAudioPlayback();
+bool encodeCapturedAudio();
+void addWaveformPeak(void* data, Peak peak);
+void queueStreamPeak(void* data, Peak peak);
+void tapStreamPeaks(void* data, const Uint8* bytes, Uint32 len);
+void drainStreamPeaks();
+void handleWaveformZoom(SDL_Event e);
 void handleWindowEvents(SDL_Event event);
-void renderTextBox(Textbox* textbox);
 void renderPacTextBoxes();
 void renderGhostsTextBoxes();
 void renderSparkles();
 void switchRecorder(SDL_Event event);
 void renderPacRecorderButton();
 void renderPacSoundWave();
-void addSineWaveTexture(TileMap* map, int startPeriod);
 void randomizeGhostsVelocity();
 void centerCamera();
-void print_err(const char* msg);
-int distanceSquared(int x1, int y1, int x2, int y2);
-bool hasColliders(Sprite sprite);
+void updateSoundEffects();
+
+void handleDebugInput(SDL_Event event);
+void updatePerfHUDText();
+void renderPerfHUD();
 
 void defaultAudioRecordingCallback(void* userdata, Uint8* stream, int len);
 void defaultAudioPlaybackCallback(void* userdata, Uint8* stream, int len);
 void pacCollisionHandler(void* objectColliding);
 
-SDL_Window *window = NULL;
-SDL_Renderer *renderer = NULL;
-SDL_Rect *camera = NULL;
-Texture sheet, title, background, textBoxSheet, recorderButtonSheet, soundwaveSheet, sparklesSheet, powerUpSheet, tileSheet, tileSheetOrig;
-Sprite pac, ghosts[N_GHOSTS], textCursor, pacRecorder, soundwave, sparkles[N_SPARKLES_PARTICLES], powerUp;
+TextureHandle title, background, cursorSheet;
+Atlas spriteAtlas;
+Sprite pac, *ghosts = NULL, textCursor, pacRecorder, soundwave, sparkles[N_SPARKLES_PARTICLES], powerUp;
+Sprite **colliders = NULL;
+int nColliders = 0;
 Textbox pacTextBox, blinkyTextBox, inkyTextBox, savedPromptTextBox;
-TileMap map;
 AudioDevice pacAudioDevice;
-TTF_Font *titleFont = NULL, *textBoxFont = NULL;
-Mix_Chunk *waka = NULL;
-SDL_RWops *saveFile;
+WavStream pacAudioStream;
+const char *recordingPath = NULL;
+int recordingSeconds = STREAM_RECORDING_SECONDS;
+bool monoClips = true; //downmix in memory recordings, halving them again
+double waveSeconds = WAVE_DEFAULT_SECONDS; //waveform zoom: recording seconds across WAVE_VIEW_WIDTH
+FontHandle titleFont, hudFont;
+Mixer sfxMixer;
+SoundHandle waka;
+VoiceHandle pacVoice = -1, *ghostVoices = NULL;
+SaveFile saveFile;
+SaveSyncPolicy saveSync = {SAVE_SYNC_INTERVAL, SAVE_DEFAULT_SYNC_MS};
 bool textSaved = false;
-SDL_Color black = {0, 0, 0, 0};
-SDL_Color yellow = {255, 255, 0, 0};
-SDL_Color green = {25, 102, 25, 0};
-SDL_Color lightBlack = {80, 80, 80, 0};
+GlyphCache hudGlyphs;
+bool hudVisible = false;
+char hudLines[HUD_N_LINES][HUD_LINE_SIZE];
+Uint32 hudRefreshTicks = 0;
+double hudCostMs = 0;
+StressOptions stress = {N_GHOSTS, false, {LEVEL_MAZE, 0, 0, 100, STRESS_DEFAULT_SEED}, 0, 0, false};
+bool singleThread = false; //--single-thread: simulate and draw on the main thread, one frame after the other
+FrameInput frameInput;     //written by the main thread only while the simulation is idle
+int gframe = 0;
+Uint32 stime = 0, statsTicks = 0;
+bool powered = false;
+int poweredStartTime = 0;
+DynamicResolution resolution;
+bool fixedResolution = false; //--fixed-res: always draw the scene at the window's resolution
+int targetFps = 60;
+DirtyRegions dirtyRegions;
+bool dirtyRects = false; //--dirty-rects: redraw only what changed into a kept target (software renderers)
 
 int main(int argc, char** argv)
 {
-	bool quit = false;
-	SDL_Event event;
-	int gframe = 0;
-	//int fps = 0;
-	Uint32 stime = 0, time = 0;
-	//int backgroundOffset = 0;
-	bool powered = false;
-	int poweredStartTime = 0;
-
-	camera = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect));
+	FramePipeline pipeline;
+	bool running = true;
+
+	perfInstallAllocHooks(); //before SDL allocates anything
+
+	if(!parseArgs(argc, argv)){
+		return 1;
+	}
+
+	camera = (SDL_Rect*)arenaAlloc(&levelArena, sizeof(SDL_Rect));
 	*camera = (SDL_Rect){0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
 
 	if(!init()){
@@ -284,115 +264,277 @@ int main(int argc, char** argv)
 		}
 		else
 		{
+			printResourceReport(&resources, stdout);
+
 			stime = SDL_GetTicks();
+			statsTicks = stime;
 
-			while(!quit)
+			//frame N+1 is simulated while frame N is replayed and presented, the vsync wait no longer eats simulation time
+			if(!singleThread && SDL_GetCPUCount() > 1 && startFramePipeline(&pipeline, simulateFrame, NULL))
 			{
-				while(SDL_PollEvent(&event) != 0)
+				perfSetFrameThread(SDL_GetThreadID(pipeline.thread));
+
+				while(syncFramePipeline(&pipeline))
 				{
-					switch(event.type)
-					{
-					case SDL_QUIT:
-						quit = true;
-						break;
-					default:
-						handleWindowEvents(event);
-						handleTextInput(event);
-						switchRecorder(event);
-						break;
-					}
+					pollFrameInput();
+					swapFramePipeline(&pipeline);
+					SDL_RenderPresent(renderer);
+				}
+
+				stopFramePipeline(&pipeline);
+				perfSetFrameThread(SDL_ThreadID());
+			}
+			else
+			{
+				while(running)
+				{
+					perfAllocSite("frame:events");
+					pollFrameInput();
+					running = simulateFrame(NULL);
+
+					perfAllocSite("frame:present");
+					SDL_RenderPresent(renderer);
 				}
+			}
+
+			perfAllocSite(NULL);
+		}
+	}
+
+	if(stress.statsIntervalMs > 0 && perf.count > 0){
+		logStressStats(SDL_GetTicks() - stime);
+	}
 
-				handleAudioInput();
-				hanndlePacInput();
-				randomizeGhostsVelocity();
-				centerCamera();
+	if(perf.allocCheck){
+		perfPrintAllocSites(&perf, stderr);
+	}
 
-				SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-				SDL_RenderClear(renderer);
+	closeGame();
+	return 0;   
+}
 
-				/*if(Mix_Playing(-1) == 0){
-					Mix_PlayChannel(-1, waka, 0);
-				}*/
+/*COLLECT THE EVENTS AND KEYBOARD STATE FOR THE NEXT SIMULATED FRAME (MAIN THREAD, WHILE THE SIMULATION IS IDLE)*/
+void pollFrameInput()
+{
+	SDL_Event event;
 
-				Sprite* colliders[3];
-				colliders[0] = &pac;
-				colliders[1] = &ghosts[BLINKY];
-				colliders[2] = &ghosts[INKY];
+	frameInput.nEvents = 0;
 
-				move(&pac, colliders, 3);
-				animate(&pac, 2);
+	while(frameInput.nEvents < FRAME_MAX_EVENTS && SDL_PollEvent(&event) != 0)
+	{
+		if(event.type == SDL_QUIT)
+			frameInput.quit = true;
+		else
+			frameInput.events[frameInput.nEvents++] = event;
+	}
 
-				move(&ghosts[BLINKY], colliders, 3);
-				move(&ghosts[INKY], colliders, 3);
+	SDL_memcpy(frameInput.keys, SDL_GetKeyboardState(NULL), sizeof(frameInput.keys));
+}
 
-				pac.frame++;
-				gframe++;
+/*UPDATE THE GAME FROM frameInput AND RECORD ITS DRAWING (ON THE SIMULATION THREAD UNLESS --single-thread), FALSE TO QUIT*/
+bool simulateFrame(void* data)
+{
+	bool quit = frameInput.quit;
+	Uint32 time;
+	int i;
 
-				time = (SDL_GetTicks() - stime) / 1000;
-				/*if(time > 0)
-					fps = gframe / time;*/
+	perfFrameTick(&perf);
+	arenaReset(&frameArena); //previous frame's scratch data
 
-				//printf("animation frame = %i, elapsed time = %i, frames = %i, fps = %i, ticks = %i\n", pac.frame, time, gframe, fps, SDL_GetTicks());
+	if(perf.count > 0){
+		updateDynamicResolution(&resolution, perf.frameMs[(perf.head - 1 + PERF_HISTORY_SIZE) % PERF_HISTORY_SIZE]);
+	}
 
-				/*--backgroundOffset;
-				if(backgroundOffset < -background.w){
-					backgroundOffset = 0;
-				}*/
+	if(stress.statsIntervalMs > 0 && SDL_GetTicks() - statsTicks >= stress.statsIntervalMs){
+		logStressStats(SDL_GetTicks() - stime);
+		statsTicks = SDL_GetTicks();
+	}
 
-				/*render(background, backgroundOffset, 0, NULL, 0, NULL, SDL_FLIP_NONE, camera);
-				render(background, backgroundOffset + background.w-1, 0, NULL, 0, NULL, SDL_FLIP_NONE, camera);*/
-				render(background, 0, 0, NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
-				renderTileMap(map, camera);
-				render(title, 0, 0, NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
-				
-				renderPacTextBoxes();
-				renderGhostsTextBoxes();
-				renderPacRecorderButton();
+	if(stress.maxFrames > 0 && gframe >= stress.maxFrames){
+		quit = true;
+	}
 
-				if(!powered && checkCollision(pac.collider, powerUp.collider)){
-					powered = true;
-					poweredStartTime = time;
-				}
+	perfAllocSite("frame:events");
+	for(i = 0; i < frameInput.nEvents; i++)
+	{
+		handleWindowEvents(frameInput.events[i]);
+		handleDebugInput(frameInput.events[i]);
+		handleTextInput(frameInput.events[i]);
+		switchRecorder(frameInput.events[i]);
+		handleWaveformZoom(frameInput.events[i]);
+	}
 
-				if(!powered){
-					renderSprite(powerUp, camera);
-				}
-				else{
-					renderSparkles();
+	perfAllocSite("frame:update");
+	handleAudioInput();
+	hanndlePacInput();
+	randomizeGhostsVelocity();
+	centerCamera();
+	updateSoundEffects();
 
-					if((time-poweredStartTime) > POWER_UP_SECONDS){
-						powered = false;
+	perfAllocSite("frame:render");
+	beginScaledScene(&resolution, camera);
+	beginDirtyScene(&dirtyRegions);
+	drawClear(black);
 
-						moveTo(&powerUp, (SDL_Point){rand()%LEVEL_WIDTH - 200, rand()%LEVEL_HEIGHT - 200});
+	move(&pac, colliders, nColliders);
+	animate(&pac, 2);
 
-						/*powerUp.x = rand()%LEVEL_WIDTH;
-						powerUp.y = rand()%LEVEL_HEIGHT;
-						powerUp.collider.x = powerUp.x;
-						powerUp.collider.y = powerUp.y;*/
-					}
-					
-				}
+	for(i = 0; i < stress.nGhosts; i++){
+		move(&ghosts[i], colliders, nColliders);
+	}
 
-				renderSprite(ghosts[BLINKY], camera);
-				renderSprite(ghosts[INKY], camera);
-				renderSprite(pac, camera);
+	pac.frame++;
+	gframe++;
 
-				renderColliders(pac, camera, (SDL_Color){0, 255, 0});
-				renderColliders(ghosts[BLINKY], camera, (SDL_Color){0, 255, 0});
-				renderColliders(ghosts[INKY], camera, (SDL_Color){0, 255, 0});
+	time = (SDL_GetTicks() - stime) / 1000;
 
-				/*SDL_RenderDrawLine(renderer, pac.circleCollider.x, pac.circleCollider.y, pac.circleCollider.x + pac.circleCollider.r * cos(45*3.14/180), pac.circleCollider.y - pac.circleCollider.r * sin(45*3.14/180));
-				SDL_RenderDrawLine(renderer, pac.circleCollider.x, pac.circleCollider.y + pac.circleCollider.r, pac.circleCollider.x, pac.circleCollider.y - pac.circleCollider.r);
-				SDL_RenderDrawLine(renderer, pac.circleCollider.x - pac.circleCollider.r, pac.circleCollider.y, pac.circleCollider.x + pac.circleCollider.r, pac.circleCollider.y);*/
+	/*--backgroundOffset;
+	if(backgroundOffset < -background.w){
+		backgroundOffset = 0;
+	}*/
 
-				SDL_RenderPresent(renderer);
-			}
+	/*render(background, backgroundOffset, 0, NULL, 0, NULL, SDL_FLIP_NONE, camera);
+	render(background, backgroundOffset + background.w-1, 0, NULL, 0, NULL, SDL_FLIP_NONE, camera);*/
+	render(getTexture(&resources, background), 0, 0, NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
+	renderTileMap(map, camera);
+	render(getTexture(&resources, title), 0, 0, NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
+	
+	renderPacTextBoxes();
+	renderGhostsTextBoxes();
+	renderPacRecorderButton();
+	renderPacSoundWave();
+
+	if(!powered && checkCollision(pac.collider, powerUp.collider)){
+		powered = true;
+		poweredStartTime = time;
+	}
+
+	if(!powered){
+		renderSprite(powerUp, camera);
+	}
+	else{
+		renderSparkles();
+
+		if((time-poweredStartTime) > POWER_UP_SECONDS){
+			powered = false;
+
+			moveTo(&powerUp, (SDL_Point){rand()%levelWidth - 200, rand()%levelHeight - 200});
+
+			/*powerUp.x = rand()%LEVEL_WIDTH;
+			powerUp.y = rand()%LEVEL_HEIGHT;
+			powerUp.collider.x = powerUp.x;
+			powerUp.collider.y = powerUp.y;*/
 		}
+		
 	}
 
-	close();
-	return 0;   
+	for(i = 0; i < stress.nGhosts; i++){
+		renderSprite(ghosts[i], camera);
+	}
+	renderSprite(pac, camera);
+
+	renderColliders(pac, camera, (SDL_Color){0, 255, 0});
+	for(i = 0; i < stress.nGhosts; i++){
+		renderColliders(ghosts[i], camera, (SDL_Color){0, 255, 0});
+	}
+	endDirtyScene(&dirtyRegions, camera);
+	endScaledScene(&resolution, camera);
+
+	//overlays go over the finished scene, at the window's resolution
+	flushDebugDraw();
+
+	/*SDL_RenderDrawLine(renderer, pac.circleCollider.x, pac.circleCollider.y, pac.circleCollider.x + pac.circleCollider.r * cos(45*3.14/180), pac.circleCollider.y - pac.circleCollider.r * sin(45*3.14/180));
+	SDL_RenderDrawLine(renderer, pac.circleCollider.x, pac.circleCollider.y + pac.circleCollider.r, pac.circleCollider.x, pac.circleCollider.y - pac.circleCollider.r);
+	SDL_RenderDrawLine(renderer, pac.circleCollider.x - pac.circleCollider.r, pac.circleCollider.y, pac.circleCollider.x + pac.circleCollider.r, pac.circleCollider.y);*/
+
+	renderPerfHUD();
+
+	return !quit;
+}
+
+/*PARSE COMMAND LINE STRESS OPTIONS INTO stress, PRINT USAGE AND RETURN FALSE IF INVALID*/
+bool parseArgs(int argc, char** argv)
+{
+	int i;
+	bool valid = true;
+
+	for(i = 1; i < argc && valid; i++)
+	{
+		if(strcmp(argv[i], "--ghosts") == 0 && i+1 < argc){
+			stress.nGhosts = SDL_atoi(argv[++i]);
+			valid = stress.nGhosts >= N_GHOSTS;
+			if(stress.statsIntervalMs == 0)
+				stress.statsIntervalMs = PERF_WINDOW_MS;
+		}
+		else if(strcmp(argv[i], "--level") == 0 && i+1 < argc){
+			stress.generatedLevel = true;
+			stress.level.kind = levelKindFromName(argv[++i]);
+			valid = stress.level.kind != N_LEVEL_KINDS;
+		}
+		else if(strcmp(argv[i], "--level-size") == 0 && i+1 < argc){
+			valid = sscanf(argv[++i], "%dx%d", &stress.level.cols, &stress.level.rows) == 2 && stress.level.cols > 0 && stress.level.rows > 0;
+		}
+		else if(strcmp(argv[i], "--walls") == 0 && i+1 < argc){
+			stress.level.wallPercent = SDL_atoi(argv[++i]);
+			valid = stress.level.wallPercent >= 0 && stress.level.wallPercent <= 100;
+		}
+		else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc){
+			stress.level.seed = SDL_strtoull(argv[++i], NULL, 10);
+		}
+		else if(strcmp(argv[i], "--stats-ms") == 0 && i+1 < argc){
+			stress.statsIntervalMs = SDL_atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--frames") == 0 && i+1 < argc){
+			stress.maxFrames = SDL_atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--ghost-voices") == 0){
+			stress.ghostVoices = true;
+		}
+		else if(strcmp(argv[i], "--record-to") == 0 && i+1 < argc){
+			recordingPath = argv[++i];
+		}
+		else if(strcmp(argv[i], "--record-seconds") == 0 && i+1 < argc){
+			recordingSeconds = SDL_atoi(argv[++i]);
+			valid = recordingSeconds >= 0;
+		}
+		else if(strcmp(argv[i], "--save-sync") == 0 && i+1 < argc){
+			valid = parseSaveSyncPolicy(argv[++i], &saveSync);
+		}
+		else if(strcmp(argv[i], "--stereo-clips") == 0){
+			monoClips = false;
+		}
+		else if(strcmp(argv[i], "--alloc-check") == 0){
+			perf.allocCheck = true;
+		}
+		else if(strcmp(argv[i], "--single-thread") == 0){
+			singleThread = true;
+		}
+		else if(strcmp(argv[i], "--target-fps") == 0 && i+1 < argc){
+			targetFps = SDL_atoi(argv[++i]);
+			valid = targetFps > 0;
+		}
+		else if(strcmp(argv[i], "--fixed-res") == 0){
+			fixedResolution = true;
+		}
+		else if(strcmp(argv[i], "--dirty-rects") == 0){
+			dirtyRects = true;
+		}
+		else{
+			valid = false;
+		}
+	}
+
+	if(!valid){
+		fprintf(stderr, "usage: %s [--ghosts N>=%d] [--level maze|arena] [--level-size COLSxROWS] [--walls 0-100] [--seed N] [--stats-ms MS] [--frames N] [--ghost-voices] [--record-to FILE.wav] [--record-seconds N] [--stereo-clips] [--save-sync none|interval:MS|lines:N] [--alloc-check] [--single-thread] [--target-fps N] [--fixed-res] [--dirty-rects]\n", argv[0], N_GHOSTS);
+		return false;
+	}
+
+	if(stress.generatedLevel && (stress.level.cols == 0 || stress.level.rows == 0)){ //default to the stock level size
+		stress.level.cols = LEVEL_WIDTH / 90;
+		stress.level.rows = LEVEL_HEIGHT / 90;
+	}
+
+	return true;
 }
 
 /*INIT SDL*/
@@ -443,6 +585,10 @@ bool init()
 				}
 
 				SDL_StartTextInput();
+
+				//both draw the scene into a target of their own, kept pixels can't be scaled
+				initDirtyRegions(&dirtyRegions, dirtyRects);
+				initDynamicResolution(&resolution, 1000.0f / targetFps, !fixedResolution && !dirtyRegions.enabled);
 			}
 		}
 	}
@@ -452,52 +598,81 @@ bool init()
 
 bool loadMedia()
 {
-	int x, y;
-
-	sheet = loadTexture(SHEET_PATH, &black);
-	textBoxSheet = loadTexture(TEXT_BOX_PATH, NULL);
-	background = loadTexture(BACKGROUND_PATH, NULL);
-	recorderButtonSheet = loadTexture(RECORDER_BUTTON_PATH, NULL);
-	soundwaveSheet = loadTexture(SOUND_WAVE_PATH, NULL);
-	sparklesSheet = loadTexture(SPARKLES_PATH, NULL);
-	powerUpSheet = loadTexture(POWER_PELLET_PATH, NULL);
-	tileSheet = loadPixelTexture(TILE_SHEET_PATH);
-	tileSheetOrig = loadPixelTexture(TILE_SHEET_PATH);
-
-	if(sheet.texture == NULL || background.texture == NULL || textBoxSheet.texture == NULL || recorderButtonSheet.texture == NULL){
+	int x;
+	int mixFreq, mixChannels;
+	Uint16 mixFormat;
+	AssetLoader assets;
+	Texture *tiles;
+
+	//the mixer converts sounds while they load, so it has to be up before the workers start
+	Mix_QuerySpec(&mixFreq, &mixFormat, &mixChannels);
+	if(initMixer(&sfxMixer, mixFreq, mixFormat, mixChannels)){
+		Mix_SetPostMix(mixerCallback, &sfxMixer);
+	}
+
+	//******SPRITE CLIPS, PACKED INTO ONE PAGE IF THE ATLAS WAS BUILT
+	if(!readAtlas(&spriteAtlas, ATLAS_PATH)){
+		printf("[atlas] %s, drawing sprites from their source images\n", SDL_GetError());
+		if(!readAtlas(&spriteAtlas, SPRITES_PATH)){
+			print_err("Could not read sprite clips");
+			return false;
+		}
+	}
+
+	//******DECODE EVERY FILE IN PARALLEL, UPLOAD TEXTURES HERE ON THE RENDER THREAD (WHAT resources ALREADY HOLDS IS ONLY SHARED)
+	initAssetLoader(&assets);
+	queuePixelImage(&assets, TILE_SHEET_PATH, SDL_GetWindowPixelFormat(window), &tileSheet);
+	queueAtlas(&assets, &spriteAtlas);
+	queueImage(&assets, BACKGROUND_PATH, NULL, &background);
+	queueImage(&assets, TEXT_BOX_PATH, NULL, &textBoxSheet);
+	queueFont(&assets, TITLE_FONT_PATH, TITLE_FONT_SIZE, &titleFont);
+	queueFont(&assets, TEXT_BOX_FONT_PATH, TEXT_BOX_FONT_SIZE, &textBoxFont);
+	queueFont(&assets, TEXT_BOX_FONT_PATH, HUD_FONT_SIZE, &hudFont);
+	if(sfxMixer.ready)
+		queueSound(&assets, &sfxMixer, WAKA_PATH, &waka);
+
+	startAssetLoader(&assets);
+	waitAssetLoader(&assets);
+	finishAssetLoader(&assets, stdout);
+
+	if(sfxMixer.ready && waka.id == 0){
+		return false;
+	}
+
+	tiles = getTexture(&resources, tileSheet);
+
+	if(!atlasLoaded(&spriteAtlas) || background.id == 0 || textBoxSheet.id == 0 || tiles == NULL){
 		return false;
 	}
 	else{
+		//******LEVEL TILES
+		SDL_Rect tileClips[] = {(SDL_Rect){0, 0, tiles->w, tiles->h}, (SDL_Rect){0, 0, tiles->w, tiles->h}};
+
+		if(stress.generatedLevel){
+			map = generateTileMap(stress.level, tiles, tileClips, N_TILE_TYPES);
+			levelWidth = map.cols * map.tileW;
+			levelHeight = map.rows * map.tileH;
+		}
+		else{
+			map = loadTileMap(TILE_MAP_SIZE, TILE_MAP_FILE, tiles, tileClips, N_TILE_TYPES);
+		}
+		addSineWaveTexture(&map, 0);
+
 		//******PAC SPRITE
-		pac = loadSprite(N_PAC_POSITIONS, &sheet, LEVEL_WIDTH/2, LEVEL_HEIGHT/2, 0, NULL, SDL_FLIP_NONE, pacCollisionHandler);
-		
-		x = SHEET_INITIAL_POS_X;
-		y = SHEET_INITIAL_POS_Y;
-		addClip(&pac, PAC_CLOSED, (SDL_Rect){
-			x, y, 
-			SHEET_STANDARD_SPRITE_SIZE, SHEET_STANDARD_SPRITE_SIZE},
-			true
-		);
-		
-		x += SHEET_STANDARD_SPRITE_SIZE + 45;
-		addClip(&pac, PAC_HALF_OPENED, (SDL_Rect){
-			x, y, 
-			SHEET_STANDARD_SPRITE_SIZE - 14, SHEET_STANDARD_SPRITE_SIZE},
-			false
-		);
-
-		x += SHEET_STANDARD_SPRITE_SIZE + 28;
-		addClip(&pac, PAC_OPENED, (SDL_Rect){
-			x, y, 
-			SHEET_STANDARD_SPRITE_SIZE - 65, SHEET_STANDARD_SPRITE_SIZE},
-			false
-		);
+		pac = loadSprite(N_PAC_POSITIONS, NULL, levelWidth/2, levelHeight/2, 0, NULL, SDL_FLIP_NONE, pacCollisionHandler);
+
+		if(!addAtlasClip(&pac, PAC_CLOSED, &spriteAtlas, "pac_closed", 0, true) ||
+			!addAtlasClip(&pac, PAC_HALF_OPENED, &spriteAtlas, "pac_half_opened", 0, false) ||
+			!addAtlasClip(&pac, PAC_OPENED, &spriteAtlas, "pac_opened", 0, false)){
+			return false;
+		}
 
 		setDefaultCollider(&pac);
 
 		//PAC BOX COLLIDERS
-		pac.nBoxColliders = 5;
-		pac.boxColliders = (SDL_Rect*) SDL_malloc(sizeof(SDL_Rect) * pac.nBoxColliders);
+		if(!setBoxColliders(&pac, 5)){
+			return false;
+		}
 
 		pac.boxColliders[0] = (SDL_Rect){pac.x + 59, pac.y, 75, 15};
 		pac.boxColliders[1] = (SDL_Rect){pac.x + 14, pac.y + 25, 166, 30};
@@ -510,63 +685,66 @@ bool loadMedia()
 		pac.circleCollider.y = pac.y + 95;
 		pac.circleCollider.r = 95;*/
 
-		//******RED GHOST SPRITE
-		ghosts[BLINKY] = loadSprite(N_GHOST_POSITIONS, &sheet, SCREEN_WIDTH/2, SCREEN_HEIGHT/2, 0, NULL, SDL_FLIP_NONE, NULL);
+		//******GHOSTS
+		ghosts = (Sprite*)arenaAlloc(&levelArena, sizeof(Sprite) * stress.nGhosts);
+		colliders = (Sprite**)arenaAlloc(&levelArena, sizeof(Sprite*) * (stress.nGhosts + 1));
 
-		x += 211;
-		y -= 14;
-		addClip(&ghosts[BLINKY], GHOST_DEFAULT, (SDL_Rect){
-			x, y, 
-			SHEET_STANDARD_SPRITE_SIZE + 18, SHEET_STANDARD_SPRITE_SIZE + 14},
-			true
-		);
+		if(ghosts == NULL || colliders == NULL){
+			print_err("Could not allocate ghosts");
+			return false;
+		}
+
+		//******RED GHOST SPRITE
+		ghosts[BLINKY] = loadSprite(N_GHOST_POSITIONS, NULL, SCREEN_WIDTH/2, SCREEN_HEIGHT/2, 0, NULL, SDL_FLIP_NONE, NULL);
+		if(!addAtlasClip(&ghosts[BLINKY], GHOST_DEFAULT, &spriteAtlas, "blinky", 0, true)){
+			return false;
+		}
 
 		setDefaultCollider(&ghosts[BLINKY]);
 		ghosts[BLINKY].velX = PAC_SPEED;
 		ghosts[BLINKY].velY = 0;
 
 		//RED GHOST COLLIDERS
-		ghosts[BLINKY].nBoxColliders = 3;
-		ghosts[BLINKY].boxColliders = (SDL_Rect*) SDL_malloc(sizeof(SDL_Rect) * ghosts[BLINKY].nBoxColliders);
+		if(!setBoxColliders(&ghosts[BLINKY], 3)){
+			return false;
+		}
 
 		ghosts[BLINKY].boxColliders[0] = (SDL_Rect){ghosts[BLINKY].x + 75, ghosts[BLINKY].y, 60, 15};
 		ghosts[BLINKY].boxColliders[1] = (SDL_Rect){ghosts[BLINKY].x + 15, ghosts[BLINKY].y + 45, 180, 45};
 		ghosts[BLINKY].boxColliders[2] = (SDL_Rect){ghosts[BLINKY].x, ghosts[BLINKY].y + 90, 210, 105};
 
 		//******BLUE GHOST SPRITE
-		ghosts[INKY] = loadSprite(N_GHOST_POSITIONS, &sheet, SCREEN_WIDTH/2, SCREEN_HEIGHT-50, 0, NULL, SDL_FLIP_NONE, NULL);
-
-		x += 390;
-		y += 234;
-		addClip(&ghosts[INKY], GHOST_DEFAULT, (SDL_Rect){
-			x, y, 
-			SHEET_STANDARD_SPRITE_SIZE + 18, SHEET_STANDARD_SPRITE_SIZE + 14},
-			true
-		);
+		ghosts[INKY] = loadSprite(N_GHOST_POSITIONS, NULL, SCREEN_WIDTH/2, SCREEN_HEIGHT-50, 0, NULL, SDL_FLIP_NONE, NULL);
+		if(!addAtlasClip(&ghosts[INKY], GHOST_DEFAULT, &spriteAtlas, "inky", 0, true)){
+			return false;
+		}
 
 		//BLUE GHOST COLLIDERS
 		setDefaultCollider(&ghosts[INKY]);
 		ghosts[INKY].velX = 0;
 		ghosts[INKY].velY = PAC_SPEED;
 
-		//******RECORDER BUTTON
-		pacRecorder = loadSprite(N_RECORDER_BUTTON_RENDERS, &recorderButtonSheet, 0, 0, 0, NULL, SDL_FLIP_NONE, NULL);
-
-		x = 50;
-		y = 60;
-		addClip(&pacRecorder, OFF, (SDL_Rect){x, y, 160, 161}, true);
-		addClip(&pacRecorder, ON, (SDL_Rect){240, y, 160, 161}, false);
+		//******STRESS GHOSTS & COLLIDERS LIST
+		if(!loadStressGhosts()){
+			return false;
+		}
 
-		setScaleRect(&pacRecorder, pacRecorder.w/2, pacRecorder.h/2);
+		//******RECORDER BUTTON (HALF SIZE)
+		pacRecorder = loadSprite(N_RECORDER_BUTTON_RENDERS, NULL, 0, 0, 0, NULL, SDL_FLIP_NONE, NULL);
 
-		//******SOUND WAVE SPRITE
-		soundwave = loadSprite(N_SOUND_WAVE_RENDERS, &soundwaveSheet, 0, 0, 0, NULL, SDL_FLIP_NONE, NULL);
+		if(!addAtlasClip(&pacRecorder, OFF, &spriteAtlas, "recorder_off", 1, true) ||
+			!addAtlasClip(&pacRecorder, ON, &spriteAtlas, "recorder_on", 1, false)){
+			return false;
+		}
 
-		addClip(&soundwave, FIRST_WAVE, (SDL_Rect){261, 4, 131, 191}, true);
-		addClip(&soundwave, SECOND_WAVE, (SDL_Rect){151, 4, 131, 191}, false);
-		addClip(&soundwave, FULL_WAVE, (SDL_Rect){14, 4, 131, 191}, false);
+		//******SOUND WAVE SPRITE (HALF SIZE)
+		soundwave = loadSprite(N_SOUND_WAVE_RENDERS, NULL, 0, 0, 0, NULL, SDL_FLIP_NONE, NULL);
 
-		setScaleRect(&soundwave, soundwave.w/2, soundwave.h/2);
+		if(!addAtlasClip(&soundwave, FIRST_WAVE, &spriteAtlas, "wave_first", 1, true) ||
+			!addAtlasClip(&soundwave, SECOND_WAVE, &spriteAtlas, "wave_second", 1, false) ||
+			!addAtlasClip(&soundwave, FULL_WAVE, &spriteAtlas, "wave_full", 1, false)){
+			return false;
+		}
 
 		//******SPARKLES PARTICLES
 		int i;
@@ -574,25 +752,28 @@ bool loadMedia()
 			sparkles[i] = loadSparklesSprite((SDL_Point){0, 0});
 
 		//******POWER UP
-		powerUp = loadSprite(1, &powerUpSheet, rand()%LEVEL_WIDTH, rand()%LEVEL_HEIGHT, 0, NULL, SDL_FLIP_NONE, NULL);
-		addClip(&powerUp, 0, (SDL_Rect){0, 0, powerUpSheet.w, powerUpSheet.h}, true);
+		powerUp = loadSprite(1, NULL, rand()%levelWidth, rand()%levelHeight, 0, NULL, SDL_FLIP_NONE, NULL);
+		if(!addAtlasClip(&powerUp, 0, &spriteAtlas, "power_up", 0, true)){
+			return false;
+		}
 		setDefaultCollider(&powerUp);
-
-		//******LEVEL TILES
-		SDL_Rect tileClips[] = {(SDL_Rect){0, 0, tileSheet.w, tileSheet.h}, (SDL_Rect){0, 0, tileSheet.w, tileSheet.h}};
-		map = loadTileMap(TILE_MAP_SIZE, TILE_MAP_FILE, &tileSheet, tileClips, N_TILE_TYPES);
-		addSineWaveTexture(&map, 0);
 	}
 
 	//******FONT & TEXT TEXTURES
-	titleFont = TTF_OpenFont(TITLE_FONT_PATH, TITLE_FONT_SIZE);
-	textBoxFont = TTF_OpenFont(TEXT_BOX_FONT_PATH, TEXT_BOX_FONT_SIZE);
-
-	if(titleFont == NULL || textBoxFont == NULL){
+	if(titleFont.id == 0 || textBoxFont.id == 0 || hudFont.id == 0){
 		return false;
 	}
 	else{
-		title = loadRenderedText("pacman", yellow, titleFont);
+		title = addTexture(&resources, NULL, NULL, loadRenderedText("pacman", yellow, getFont(&resources, titleFont)), NULL);
+		if(title.id == 0){
+			print_err("Could not render title");
+			return false;
+		}
+
+		//PERF HUD GLYPHS
+		if(!loadGlyphCache(&hudGlyphs, getFont(&resources, hudFont))){
+			return false;
+		}
 
 		//******TEXT BOXES
 		//PAC TEXT BOX
@@ -600,7 +781,7 @@ bool loadMedia()
 
 		//"SAVED" TEXT BOX
 		savedPromptTextBox = loadTextBox(SAVED_PROMPT_STR, green);
-		setScaleRect(&savedPromptTextBox.sprite, savedPromptTextBox.textTexture.w + 20, savedPromptTextBox.sprite.h);
+		setScaleRect(&savedPromptTextBox.sprite, savedPromptTextBox.layout.width + 2*TEXT_BOX_PADDING, savedPromptTextBox.sprite.h);
 		savedPromptTextBox.sprite.flip = SDL_FLIP_HORIZONTAL;
 
 		//BLINKY TEXT BOX
@@ -609,18 +790,24 @@ bool loadMedia()
 		inkyTextBox = loadTextBox("ronaldinho soccer", black);
 
 		//******TEXT CURSOR
-		textCursor = loadSprite(2, (Texture*)SDL_malloc(sizeof(Texture)), 0, 0, 0, NULL, SDL_FLIP_NONE, NULL);
-		*textCursor.sheet = loadRenderedText("_", black, textBoxFont);
+		cursorSheet = addTexture(&resources, NULL, NULL, loadRenderedText("_", black, getFont(&resources, textBoxFont)), NULL);
+		if(cursorSheet.id == 0){
+			return false;
+		}
+
+		textCursor = loadSprite(2, getTexture(&resources, cursorSheet), 0, 0, 0, NULL, SDL_FLIP_NONE, NULL);
 		addClip(&textCursor, 0, (SDL_Rect){0, 0, textCursor.sheet->w, textCursor.sheet->h}, true);
 		addClip(&textCursor, 1, (SDL_Rect){0, 0, 0, 0}, false);
 	}
 
 	//******AUDIO INIT
-	waka = Mix_LoadWAV(WAKA_PATH);
-
-	if(waka == NULL){
+	ghostVoices = (VoiceHandle*)arenaAlloc(&levelArena, stress.nGhosts * sizeof(VoiceHandle));
+	if(ghostVoices == NULL){
 		return false;
 	}
+	for(x = 0; x < stress.nGhosts; x++){
+		ghostVoices[x] = -1;
+	}
 
 	//RECORDING DEVICES
 	if(SDL_GetNumAudioDevices(SDL_TRUE) >= 1){
@@ -645,48 +832,84 @@ bool loadMedia()
 	}
 
 	//******SAVE FILE & RANDOM TEXTBOX PROMPT ASSIGNMENT
-	saveFile = SDL_RWFromFile(SAVE_FILE_PATH, "a+");
-	loadSavedText();
+	if(openSaveFile(&saveFile, SAVE_FILE_PATH, saveSync))
+		loadSavedText();
 
 	return true;
 }
 
-/*ADD SPECIFIED clip TO GIVEN sprite ON index (IN nClips RANGE), SET AS CURRENT RENDER IF setRender*/
-void addClip(Sprite* sprite, int index, SDL_Rect clip, bool setRender)
+/*CLONE BLINKY/INKY UP TO stress.nGhosts GHOSTS SHARING THEIR CLIPS (BOX COLLIDERS FROM colliderSetPool), SPREAD OVER FREE
+ *LEVEL SPOTS FROM stress.level.seed (SAME LAYOUT EVERY RUN), AND BUILD THE colliders LIST MOVED AGAINST EVERY FRAME*/
+bool loadStressGhosts()
 {
-	if(index < 0 || index >= sprite->nClips)
-		return;
-	
-	sprite->clips[index] = clip;
+	Uint64 rngState = stress.level.seed;
+	int i;
+	Sprite *model;
+
+	for(i = N_GHOSTS; i < stress.nGhosts; i++)
+	{
+		model = &ghosts[i % N_GHOSTS];
+		ghosts[i] = *model; //shares model clips
+
+		if(model->nBoxColliders > 0){
+			if(!setBoxColliders(&ghosts[i], model->nBoxColliders)){
+				print_err("Could not allocate ghost colliders");
+				return false;
+			}
+			SDL_memcpy(ghosts[i].boxColliders, model->boxColliders, sizeof(SDL_Rect) * model->nBoxColliders);
+		}
+
+		if(levelRandom(&rngState) % 2){
+			ghosts[i].velX *= -1;
+			ghosts[i].velY *= -1;
+		}
+
+		moveTo(&ghosts[i], findFreeSpot(ghosts[i], &rngState));
+	}
 
-	if(setRender){
-		sprite->renderRect = &sprite->clips[index];
-		updateSpriteSize(sprite);
+	//generated levels may wall in the stock spawn points
+	if(stress.generatedLevel){
+		moveTo(&pac, findFreeSpot(pac, &rngState));
+		for(i = 0; i < N_GHOSTS; i++)
+			moveTo(&ghosts[i], findFreeSpot(ghosts[i], &rngState));
 	}
+
+	colliders[0] = &pac;
+	for(i = 0; i < stress.nGhosts; i++)
+		colliders[i+1] = &ghosts[i];
+	nColliders = stress.nGhosts + 1;
+
+	return true;
 }
 
-/*SET sprite'S SCALE RECT TO SIZE (w,h) (CREATE NEW IF NULL) AND UPDATE sprite INTERNAL SIZE*/
-void setScaleRect(Sprite* sprite, int w, int h)
+/*RANDOM POSITION WHERE sprite'S COLLIDERS ARE INSIDE THE LEVEL AND CLEAR OF SOLID TILES (CURRENT POSITION IF NONE FOUND)*/
+SDL_Point findFreeSpot(Sprite sprite, Uint64* rngState)
 {
-	if(sprite->scaleRect == NULL){
-		sprite->scaleRect = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect));
+	SDL_Point spot = {sprite.x, sprite.y};
+	int i;
+
+	sprite.boxColliders = NULL; //probe with the outer collider only, the copy shares the caller's box colliders
+	sprite.nBoxColliders = 0;
+
+	for(i = 0; i < STRESS_SPAWN_TRIES && levelWidth > sprite.w && levelHeight > sprite.h; i++)
+	{
+		moveTo(&sprite, (SDL_Point){(int)(levelRandom(rngState) % (levelWidth - sprite.w)), (int)(levelRandom(rngState) % (levelHeight - sprite.h))});
+
+		if(!checkLevelBoundsCollision(sprite) && !checkTileMapCollisions(sprite)){
+			spot = (SDL_Point){sprite.x, sprite.y};
+			break;
+		}
 	}
 
-	*sprite->scaleRect = (SDL_Rect){0, 0, w, h};
-	updateSpriteSize(sprite);
+	return spot;
 }
 
-/*UPDATE sprite INTERNAL SIZE(w,h) BASED ON SCALING AND RENDERING COMPONENTS*/
-void updateSpriteSize(Sprite* sprite)
+/*LOG FRAME TIME STATS OF THE LAST PERF_WINDOW_MS FOR THE CURRENT GHOST COUNT*/
+void logStressStats(Uint32 elapsedMs)
 {
-	if(sprite->scaleRect != NULL){
-		sprite->w = sprite->scaleRect->w;
-		sprite->h = sprite->scaleRect->h;
-	}
-	else{
-		sprite->w = sprite->renderRect->w;
-		sprite->h = sprite->renderRect->h;
-	}
+	printf("[stress] t=%.1fs ghosts=%d tiles=%d voices=%d mix_us=%d ", elapsedMs / 1000.0, stress.nGhosts, map.size,
+		SDL_AtomicGet(&sfxMixer.activeVoices), SDL_AtomicGet(&sfxMixer.callbackUs));
+	perfPrintSummary(&perf, stdout);
 }
 
 /*LOAD NEW AUDIO DEVICE STREAMING ON recordingDeviceName & playbackDeviceName*/
@@ -694,6 +917,7 @@ AudioDevice loadAudioDevice(const char* recordingDeviceName, const char* playbac
 {
 	AudioDevice device;
 
+	SDL_zero(device); //closeGame frees whatever was set up
 	strncpy(device.name, recordingDeviceName, AUDIO_DEVICE_NAME_SIZE);
 	device.available = true;
 
@@ -725,11 +949,35 @@ AudioDevice loadAudioDevice(const char* recordingDeviceName, const char* playbac
 		int bytesPerSample = device.recordingSpec.channels * (SDL_AUDIO_BITSIZE(device.recordingSpec.format) / 8);
 		int bytesPerSecond = device.recordingSpec.freq * bytesPerSample;
 
-		device.audiobufferSize = (MAX_RECORDING_SECONDS+1) * bytesPerSecond;
-		device.bufferMaxPos = MAX_RECORDING_SECONDS * bytesPerSecond;
+		device.streamPath = recordingPath;
+
+		//in memory recordings are kept as S16 IMA-ADPCM, 4 bits per sample
+		device.clipSpec = device.recordingSpec;
+		device.clipSpec.format = AUDIO_S16SYS;
+		device.clipSpec.channels = monoClips ? 1 : SDL_min(device.recordingSpec.channels, ADPCM_MAX_CHANNELS);
+		device.clipMaxFrames = MAX_RECORDING_SECONDS * device.recordingSpec.freq;
 
-		device.audioBuffer = (Uint8*)SDL_calloc(device.audiobufferSize, sizeof(Uint8));
-		device.bufferCurrentPos = 0;
+		if(device.streamPath != NULL){ //streamed to disk: memory stays at the two rings whatever the length
+			device.streamMaxBytes = (Uint32)SDL_min((Uint64)recordingSeconds * bytesPerSecond, 0xFFFFFFFFu);
+		}
+		else{
+			device.streamMaxBytes = 0;
+			if(!initAudioConverter(&device.clipConverter, &device.recordingSpec, &device.clipSpec)){
+				strcpy(device.name, "Bad recording format :(");
+				device.available = false;
+			}
+		}
+
+		if((device.streamPath == NULL && !initAdpcmClip(&device.clip, device.clipSpec.channels, device.clipSpec.freq, device.clipMaxFrames)) ||
+			!initRingBuffer(&device.captureRing, device.recordingSpec.size * AUDIO_RING_CALLBACKS) ||
+			!initRingBuffer(&device.playbackRing, device.playbackSpec.size * AUDIO_RING_CALLBACKS) ||
+			!initRingBuffer(&device.peakRing, WAVE_RING_PEAKS * sizeof(Peak))){
+			strcpy(device.name, "No audio memory :(");
+			device.available = false;
+		}
+
+		//the devices may have negotiated different rates, channels or formats
+		initAudioConverter(&device.playbackConverter, &device.clipSpec, &device.playbackSpec);
 	}
 
 	device.state = PAUSED;
@@ -737,18 +985,19 @@ AudioDevice loadAudioDevice(const char* recordingDeviceName, const char* playbac
 	return device;
 }
 
-/*DEFAULT RECORDING CALLBACK FOR AudioDevices*/
+/*DEFAULT RECORDING CALLBACK FOR AudioDevices: QUEUE CAPTURED BYTES FOR THE GAME THREAD (DROPPED AND COUNTED IF FULL)*/
 void defaultAudioRecordingCallback(void* userdata, Uint8* stream, int len)
 {
-	SDL_memcpy(&pacAudioDevice.audioBuffer[pacAudioDevice.bufferCurrentPos], stream, len);
-	pacAudioDevice.bufferCurrentPos += len;
+	ringBufferWrite(&pacAudioDevice.captureRing, stream, len);
 }
 
-/*DEFAULT PLAYBACK CALLBACK FOR AudioDevices*/
+/*DEFAULT PLAYBACK CALLBACK FOR AudioDevices: PLAY BYTES QUEUED BY THE GAME THREAD, SILENCE IF IT FELL BEHIND*/
 void defaultAudioPlaybackCallback(void* userdata, Uint8* stream, int len)
 {
-	SDL_memcpy(stream, &pacAudioDevice.audioBuffer[pacAudioDevice.bufferCurrentPos], len);
-	pacAudioDevice.bufferCurrentPos += len;
+	Uint32 read = ringBufferRead(&pacAudioDevice.playbackRing, stream, len);
+
+	if(read < (Uint32)len)
+		SDL_memset(stream + read, pacAudioDevice.playbackSpec.silence, len - read);
 }
 
 /*COLLISION HANDLER TO PACMAN'S SPRITE*/
@@ -784,85 +1033,74 @@ void pacCollisionHandler(void* objectColliding)
 	}
 }
 
-/*LOAD SAVED TEXT FOR RANDOM TEXT PROMTS*/
+/*LOAD SAVED TEXT FOR RANDOM TEXT PROMTS (DISTINCT LINES, UNIFORMLY DRAWN THROUGH THE SAVE FILE INDEX)*/
 void loadSavedText()
 {
-	char textLine[TEXT_BOX_BUFFER_SIZE] = "";
-	int fileSize = SDL_RWsize(saveFile), totalRead = 0, lineRead = 0, byteRead = 1;
-	int promptsSet = 0, nPrompts;
 	char *textPromts[] = {pacTextBox.textBuffer, blinkyTextBox.textBuffer, inkyTextBox.textBuffer};
+	Uint64 rngState = (Uint64)time(NULL) ^ SDL_GetPerformanceCounter();
 
-	nPrompts = sizeof(textPromts) / sizeof(char*);
-
-	if(fileSize <= 0){
-		return; //no saved data
-	}
-
-	while(promptsSet < nPrompts && totalRead < fileSize && byteRead != 0)
-	{
-		byteRead = SDL_RWread(saveFile, textLine+lineRead, 1, 1);
-		totalRead += byteRead;
-		lineRead += byteRead;
-
-		if(byteRead && (lineRead == TEXT_BOX_BUFFER_SIZE || textLine[lineRead-1] == SAVE_FILE_DELIMITER)){ //end of line
-			if(rand()%fileSize<totalRead){ //rand select
-				strncpy(textPromts[promptsSet], textLine, lineRead);
-				textPromts[promptsSet++][lineRead-1] = '\0';
-			}
-			lineRead = 0;
-		}
-	}
+	sampleSavedLines(&saveFile, textPromts, sizeof(textPromts) / sizeof(char*), TEXT_BOX_BUFFER_SIZE, &rngState);
 }
 
 /*CLOSE AND EXIT SDL & SUBSYSTEMS*/
-void close()
+void closeGame()
 {
-	SDL_DestroyTexture(sheet.texture);
-	sheet.texture = NULL;
+	//every texture, font and sound goes back to resources, which reports whatever is still held as leaked
+	releaseAtlas(&spriteAtlas);
+	releaseTexture(&resources, &background);
+	releaseTexture(&resources, &title);
+	releaseTexture(&resources, &cursorSheet);
+	releaseTexture(&resources, &textBoxSheet);
+	releaseTexture(&resources, &tileSheet);
+
+	SDL_DestroyTexture(hudGlyphs.sheet.texture);
+	hudGlyphs.sheet.texture = NULL;
+	freeDebugDraw();
+	freeDynamicResolution(&resolution);
+	freeDirtyRegions(&dirtyRegions);
 
-	SDL_DestroyTexture(background.texture);
-	background.texture = NULL;
+	releaseFont(&resources, &titleFont);
+	releaseFont(&resources, &textBoxFont);
+	releaseFont(&resources, &hudFont);
 
-	SDL_DestroyTexture(title.texture);
-	title.texture = NULL;
+	freeTextLayout(&pacTextBox.layout);
+	freeTextLayout(&savedPromptTextBox.layout);
+	freeTextLayout(&blinkyTextBox.layout);
+	freeTextLayout(&inkyTextBox.layout);
+
+	Mix_SetPostMix(NULL, NULL); //unhook before the voices' sounds go away
+	closeMixer(&sfxMixer);
+	releaseSound(&resources, &waka);
+
+	closeResourceManager(&resources, stdout);
 
 	SDL_DestroyRenderer(renderer);
 	renderer = NULL;
 
-	Mix_FreeChunk(waka);
-	waka = NULL;
-
 	SDL_DestroyWindow(window);
 	window = NULL;
 
-	SDL_RWclose(saveFile);
-	saveFile = NULL;
-
-	SDL_DestroyTexture(map.sheet->texture);
-	SDL_free(map.tiles);
-	SDL_free(map.tileClips);
-	map.tiles = NULL;
-	map.tileClips = NULL;
-
-
-	freeSprite(&pac);
-	freeSprite(&ghosts[BLINKY]);
-	freeSprite(&ghosts[INKY]);
-	freeSprite(&pacTextBox.sprite);
-	freeSprite(&savedPromptTextBox.sprite);
-	freeSprite(&pacRecorder);
-	freeSprite(&soundwave);
-
-	int i;
-	for(i = 0; i < N_SPARKLES_PARTICLES; i++){
-		freeSprite(&sparkles[i]);
-	}
-
-	if(pacAudioDevice.audioBuffer != NULL)
-    {
-        SDL_free(pacAudioDevice.audioBuffer);
-        pacAudioDevice.audioBuffer = NULL;
-    }
+	closeSaveFile(&saveFile);
+
+	//sprite clips, scale rects, collider sets, ghosts, tile map, camera: all level memory at once
+	freeLevelMemory();
+	freeTileMap(&map);
+	ghosts = NULL;
+	colliders = NULL;
+	ghostVoices = NULL;
+	camera = NULL;
+
+	SDL_CloseAudioDevice(pacAudioDevice.recordingId); //callbacks stop before their rings go away
+	SDL_CloseAudioDevice(pacAudioDevice.playbackId);
+	stopWavWriter(&pacAudioStream); //no-op unless quitting mid stream
+	stopWavReader(&pacAudioStream);
+	freeRingBuffer(&pacAudioDevice.captureRing);
+	freeRingBuffer(&pacAudioDevice.playbackRing);
+	freeRingBuffer(&pacAudioDevice.peakRing);
+	freePeakPyramid(&pacAudioDevice.waveform);
+	freeAudioConverter(&pacAudioDevice.clipConverter);
+	freeAudioConverter(&pacAudioDevice.playbackConverter);
+	freeAdpcmClip(&pacAudioDevice.clip);
 
 	IMG_Quit();
 	TTF_Quit();
@@ -871,649 +1109,23 @@ void close()
 	SDL_Quit();
 }
 
-/*LOAD SDL SURFACE FROM PATH*/
-SDL_Surface* loadSurface(const char* path)
-{
-	SDL_Surface *surface = IMG_Load(path);
-
-	if(surface == NULL){
-		print_err("Could not load surface");
-	}
-
-	return surface;
-}
 
-/*LOAD SDL SURFACE FROM PATH WITH PIXEL STREAMING PROPERTIES*/
-SDL_Surface* loadPixelSurface(const char* path)
+/*HANDLE PLAYER INPUT FOR PAC-MAN*/
+void hanndlePacInput()
 {
-	SDL_Surface *surface = loadSurface(path);
-	SDL_Surface *formattedSurface = SDL_ConvertSurfaceFormat(surface, SDL_GetWindowPixelFormat(window), 0);
+	const Uint8 *currentKeyStates = frameInput.keys;
 
-	if(formattedSurface == NULL){
-		print_err("Could not load formatted surface for pixel streaming");
-	}
-
-	SDL_FreeSurface(surface);
-
-	return formattedSurface;
-}
-
-/*LOAD SDL TEXTURE FROM PATH AND COLOR KEY IF NECESSARY*/
-Texture loadTexture(const char* path, SDL_Color* colorKey)
-{
-	SDL_Texture *loadedTexture = NULL;
-	SDL_Surface *loadedSurface = loadSurface(path);
-	Texture texture;
-
-	if(loadedSurface == NULL){
-		print_err("Could not load surface for texture");
-	}
-	else
-	{
-		if(colorKey != NULL){
-			SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, colorKey->r, colorKey->g, colorKey->b));
-		}
-
-		loadedTexture = SDL_CreateTextureFromSurface(renderer, loadedSurface);
-
-		if(loadedTexture == NULL){
-			print_err("Unable to load texture from surface");
-		}
-		else{
-			texture = (Texture){loadedTexture, path, loadedSurface->w, loadedSurface->h, false, NULL, 0};
-		}
-	}
-
-	SDL_FreeSurface(loadedSurface);
-
-	return texture;
-}
-
-/*LOAD SDL TEXTURE FROM PATH WITH PIXEL STREAMING PROPERTIES*/
-Texture loadPixelTexture(const char* path)
-{
-	SDL_Texture *loadedTexture = NULL;
-	SDL_Surface *loadedSurface = loadPixelSurface(path);
-	Texture texture;
-
-	if(loadedSurface == NULL){
-		print_err("Could not load surface for pixel streaming texture");
-	}
-	else
-	{
-		loadedTexture = SDL_CreateTexture(renderer, SDL_GetWindowPixelFormat(window), SDL_TEXTUREACCESS_STREAMING, loadedSurface->w, loadedSurface->h);
-
-		if(loadedTexture == NULL){
-			print_err("Unable to load pixel streaming texture from surface");
-		}
-		else
-		{
-			SDL_LockTexture(loadedTexture, NULL, &texture.pixels, &texture.pitch);
-			SDL_memcpy(texture.pixels, loadedSurface->pixels, loadedSurface->pitch * loadedSurface->h);
-			SDL_UnlockTexture(loadedTexture);
-			texture.pixels = NULL;
-
-			texture = (Texture){loadedTexture, path, loadedSurface->w, loadedSurface->h, true, texture.pixels, texture.pitch};
-		}
-	}
-
-	SDL_FreeSurface(loadedSurface);
-
-	return texture;
-}
-
-/*LOCK VALID PIXEL-STREAMING texture*/
-bool lockPixelTexture(Texture* texture)
-{
-	if(!texture->pixelstream){
-		print_err("No pixel-streaming texture provided for locking");
-		return false;
-	}
-
-	if(texture->pixels != NULL){
-		print_err("Texture is already locked/pixels in use");
-		return false;
-	}
-
-	if(SDL_LockTexture(texture->texture, NULL, &texture->pixels, &texture->pitch) != 0){
-		print_err("Unable to lock texture");
-		return false;
-	}
-	
-	return true;
-}
-
-/*UNLOCK VALID PIXEL-STREAMING texture*/
-bool unlockPixelTexture(Texture* texture)
-{
-	if(!texture->pixelstream){
-		print_err("No pixel-streaming texture provided for unlocking");
-		return false;
-	}
-
-	if(texture->pixels == NULL){
-		print_err("Texture is already unlocked/pixels not set");
-		return false;
-	}
-
-	SDL_UnlockTexture(texture->texture);
-	texture->pixels = NULL;
-	texture->pitch = 0;
-
-	return true;
-}
-
-/*LOAD SDL TTF TEXTURE WITH GIVEN TEXT, COLOR AND FONT*/
-Texture loadRenderedText(const char *text, SDL_Color color, TTF_Font* font)
-{
-	SDL_Texture *loadedTTFTexture = NULL;
-	SDL_Surface *loadedTTFSurface = NULL;
-	Texture ttfText;
-
-	if(strlen(text) == 0) //empty texture on empty string
-		loadedTTFSurface = TTF_RenderText_Solid(font, " ", color);
-	else
-		loadedTTFSurface = TTF_RenderText_Solid(font, text, color);
-
-	if(loadedTTFSurface == NULL){
-		print_err("Could not load TTF surface");
-	}
-	else
-	{
-		loadedTTFTexture = SDL_CreateTextureFromSurface(renderer, loadedTTFSurface);
-
-		if(loadedTTFTexture == NULL){
-			print_err("Unable to load TTF texture from surface");
-		}
-		else{
-			ttfText = (Texture){loadedTTFTexture, "", loadedTTFSurface->w, loadedTTFSurface->h, false, NULL, 0};
-		}
-	}
-
-	SDL_FreeSurface(loadedTTFSurface);
-	loadedTTFSurface = NULL;
-
-	return ttfText;
-}
-
-/*LOAD NEW TILE MAP FROM tileFileName WITH UP TO size TILES DEFINED BY nTileTypes AND tileSheet */
-TileMap loadTileMap(int size, const char *tileFileName, Texture* tileSheet, SDL_Rect* tileClips, int nTileTypes)
-{
-	TileMap map;
-	Tile currentTile;
-	SDL_RWops *tileFile = SDL_RWFromFile(tileFileName, "r");
-	int type;
-	int i = 0;
-	int x = 0, y = 0;
-	char byte[1];
-
-	map.tiles = (Tile*)SDL_malloc(sizeof(Tile) * size);
-	map.tileClips = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect) * nTileTypes);
-
-	SDL_memcpy(map.tileClips, tileClips, sizeof(SDL_Rect) * nTileTypes);
-
-	map.size = size;
-	map.sheet = tileSheet;
-	map.nTileTypes = nTileTypes;
-
-	if(tileFile != NULL)
-	{
-		while(i < size && SDL_RWread(tileFile, byte, 1, 1))
-		{
-			if(byte[0] == '\n' || byte[0] == '\r')
-				continue;
-
-			type = SDL_atoi(byte);
-
-			if(type > 0 && type < nTileTypes){
-				currentTile = loadTile(type, (SDL_Rect){x, y, tileClips[type].w, tileClips[type].h}, true, true);
-			}
-			else if(type == 0){
-				currentTile = loadTile(EMPTY, (SDL_Rect){x, y, tileClips[type].w, tileClips[type].w}, false, false);
-			}
-			else{
-				currentTile = loadTile(UNDEFINED, (SDL_Rect){0, 0, 0, 0}, false, false);
-			}
-
-			if(x + currentTile.w >= LEVEL_WIDTH){
-				x = 0;
-				y += currentTile.h;
-			}
-			else{
-				x += currentTile.w;
-			}
-
-			map.tiles[i++] = currentTile;
-		}
-	}
-
-	SDL_RWclose(tileFile);
-
-	return map;
-}
-
-/*LOAD NEW TILE BASED ON TILEMAP type*/
-Tile loadTile(int type, SDL_Rect renderRect, bool solid, bool visible)
-{
-	Tile tile;
-
-	tile = (Tile){.x = renderRect.x, .y = renderRect.y, .w = renderRect.w, .h = renderRect.h};
-
-	tile.type = type;
-	tile.renderRect = renderRect;
-	tile.collider = renderRect;
-
-	tile.solid = solid;
-	tile.visible = visible;
-
-	return tile;
-}
-
-/*RENDER texture SCALED BY scaleRect AND clip FROM IT IF NECESSARY (RELATIVE TO camera IF NOT NULL)*/
-void render(Texture texture, int x, int y, SDL_Rect* clip, SDL_Rect* scaleRect, double angle, SDL_Point* center, SDL_RendererFlip flip, SDL_Rect* camera)
-{
-	SDL_Rect renderSpace = {x, y, texture.w, texture.h};
-
-	if(clip != NULL){
-		renderSpace.w = clip->w;
-		renderSpace.h = clip->h;
-	}
-
-	if(scaleRect != NULL){ //prioritize scaleRect
-		renderSpace.w = scaleRect->w;
-		renderSpace.h = scaleRect->h;
-	}
-
-	if(camera != NULL){
-		renderSpace.x -= camera->x;
-		renderSpace.y -= camera->y;
-	}
-
-	SDL_RenderCopyEx(renderer, texture.texture, clip, &renderSpace, angle, center, flip);
-}
-
-/*RENDER SPRITE (SCALED BY sprite.scaleRect IF NOT NULL, RELATIVE TO CAMERA IF NOT NULL)*/
-void renderSprite(Sprite sprite, SDL_Rect* camera)
-{
-	render(*sprite.sheet, sprite.x, sprite.y, sprite.renderRect, sprite.scaleRect, sprite.angle, sprite.center, sprite.flip, camera);
-}
-
-/*RENDER LEVEL TILE BASED ON INTERNAL POSITION*/
-void renderTile(TileMap map, int index, SDL_Rect* camera)
-{
-	Tile tile = map.tiles[index];
-	render(*map.sheet, tile.x, tile.y, &map.tileClips[tile.type], NULL, 0, NULL, SDL_FLIP_NONE, camera);
-}
-
-/*RENDER FULL TILE MAP*/
-void renderTileMap(TileMap map, SDL_Rect* camera)
-{
-	int i;
-
-	for(i = 0; i < TILE_MAP_SIZE; i++)
-	{
-		if(map.tiles[i].visible && checkCollision(map.tiles[i].collider, *camera)){ //visible and inside camera view
-			renderTile(map, i, camera);
-		}
-	}
-}
-
-/*LOAD NEW SPRITE AND SET RENDER RECT TO FIRST AVAILABLE CLIP (SET scaleRect TO NULL AND EMPTY collider BY DEFAULT)*/
-Sprite loadSprite(int nClips, Texture* sheet, int x, int y, double angle, SDL_Point* center, SDL_RendererFlip flip, void (*collisionHandler)(void*))
-{
-	Sprite sprite;
-
-	sprite.nClips = nClips > 0 ? nClips : 1;
-		
-	sprite.clips = (SDL_Rect*)SDL_malloc(sizeof(SDL_Rect) * sprite.nClips);
-	sprite.renderRect = &sprite.clips[0];
-
-	sprite.sheet = sheet;
-	
-	sprite.w = sprite.renderRect->w;
-	sprite.h = sprite.renderRect->h;
-
-	sprite.x = x;
-	sprite.y = y;
-
-	sprite.velX = 0;
-	sprite.velY = 0;
-
-	sprite.angle = angle;
-	sprite.center = center;
-	sprite.flip = flip;
-	sprite.frame = 0;
-	sprite.scaleRect = NULL;
-
-	sprite.collider = (SDL_Rect){0, 0, 0, 0};
-	sprite.circleCollider.r = 0;
-	sprite.nBoxColliders = 0;
-
-	sprite.collisionHandler = collisionHandler;
-
-	return sprite;
-}
-
-/*SET A DEFAULT COLLIDER FOR sprite BASED ON ITS SIZE*/
-void setDefaultCollider(Sprite *sprite)
-{
-	sprite->collider = (SDL_Rect){sprite->x, sprite->y, sprite->w, sprite->h};
-}
-
-
-/*LOAD NEW TEXTBOX RENDER OBJECT WITH DEFAULT PROPERTIES*/
-Textbox loadTextBox(const char *defaultText, SDL_Color textColor)
-{
-	Textbox textbox;
-	Sprite sprite;
-	int textLen = strlen(defaultText);
-
-	textbox.x = 0, textbox.y = 0;
-	textbox.w = SHEET_STANDARD_SPRITE_SIZE+100, textbox.h = SHEET_STANDARD_SPRITE_SIZE/2;
-
-	if(textLen > TEXT_BOX_BUFFER_SIZE)
-		textLen = TEXT_BOX_BUFFER_SIZE;
-
-	sprite = loadSprite(1, &textBoxSheet, textbox.x, textbox.y, 0, NULL, SDL_FLIP_NONE, NULL);
-	addClip(&sprite, 0, (SDL_Rect){120, 150, 780, 190}, true);
-	setScaleRect(&sprite, textbox.w, textbox.h);
-
-	textbox.sprite = sprite;
-
-	strncpy(textbox.textBuffer, defaultText, textLen);
-	textbox.textBuffer[textLen] = '\0';
-	textbox.textColor = textColor;
-	textbox.textTexture = loadRenderedText(textbox.textBuffer, textbox.textColor, textBoxFont);
-
-	return textbox;
-}
-
-/*DETECT COLLISION BETWEEN BOX A & B*/
-bool checkCollision(SDL_Rect a, SDL_Rect b)
-{
-	if(a.x + a.w <= b.x)
-		return false;
-	else if(a.x >= b.x + b.w)
-		return false;
-	else if(a.y + a.h <= b.y)
-		return false;
-	else if(a.y >= b.y + b.h)
-		return false;
-	else
-		return true; //COLLISION
-}
-
-/*DETECT FIRST COLLISION POINT BETWEEN BOX COLLIDER SET A & BOX COLLIDER SET B*/
-bool checkInnerBoxesCollisions(SDL_Rect* boxCollidersA, int nBoxesA, SDL_Rect* boxCollidersB, int nBoxesB){
-	int i, j;
-
-	if(boxCollidersA == NULL || boxCollidersB == NULL)
-		return false;
-
-	for(i = 0; i < nBoxesA; i++){
-		for(j = 0; j < nBoxesB; j++){
-			if(checkCollision(boxCollidersA[i], boxCollidersB[j])){ //BOX LEVEL COLLISION
-				return true;
-			}
-		}
-	}
-
-	//NO COLLISIONS REPORTED
-	return false;
-}
-
-/*DETECT COLLISION BETWEEN SPRITES A & B CIRCULAR COLLIDERS (IF ANY)*/
-bool checkCircularCollision(Sprite a, Sprite b)
-{
-	if(a.circleCollider.r != 0 && b.circleCollider.r != 0) //A & B CIRCULAR COLLIDERS EXIST
-	{
-		float radiiSumSquared = a.circleCollider.r + b.circleCollider.r;
-		radiiSumSquared *= radiiSumSquared;
-
-		if(distanceSquared(a.circleCollider.x, a.circleCollider.y, b.circleCollider.x, b.circleCollider.y) < radiiSumSquared){
-			return true;
-		}
-	}
-	else if((a.circleCollider.r != 0 && b.circleCollider.r == 0) || (a.circleCollider.r == 0 && b.circleCollider.r != 0)) //A OR B CIRCULAR COLLIDER EXISTS (CIRCLE VS RECT COLLISION)
-	{
-		int cX, cY;
-		SDL_Rect boxCollider = a.circleCollider.r != 0 ? b.collider : a.collider;
-		Circle circleCollider = a.circleCollider.r != 0 ? a.circleCollider : b.circleCollider;
-
-		if(circleCollider.x < boxCollider.x){
-			cX = boxCollider.x;
-		}
-		else if(circleCollider.x > boxCollider.x + boxCollider.w){
-			cX = boxCollider.x + boxCollider.w;
-		}
-		else{
-			cX = circleCollider.x;
-		}
-
-		if(circleCollider.y < boxCollider.y){
-			cY = boxCollider.y;
-		}
-		else if(circleCollider.y > boxCollider.y + boxCollider.h){
-			cY = boxCollider.y + boxCollider.h;
-		}
-		else{
-			cY = circleCollider.y;
-		}
-
-		if(distanceSquared(circleCollider.x, circleCollider.y, cX, cY) < (circleCollider.r * circleCollider.r)){
-			return true;
-		}
-	}
-
-	//else NO CIRCULAR COLLIDERS EXIST/NO CIRCULAR COLLISIONS DETECTED
-	return false;
-}
-
-/*CHECK COLLISION AGAINST LEVEL BOUNDS*/
-bool checkLevelBoundsCollision(Sprite sprite)
-{
-	return sprite.collider.x < 0 || sprite.collider.x + sprite.collider.w > LEVEL_WIDTH || sprite.collider.y < 0 || sprite.collider.y + sprite.collider.h > LEVEL_HEIGHT;
-}
-
-/*CHECK COLLISIONS AGAINST LEVEL TILES MAP*/
-bool checkTileMapCollisions(Sprite sprite)
-{
-	int i;
-
-	for(i = 0; i < TILE_MAP_SIZE; i++){
-		if(map.tiles[i].solid && checkCollision(sprite.collider, map.tiles[i].collider)){
-			if(sprite.collisionHandler != NULL)
-				sprite.collisionHandler(&map.tiles[i]);
-			return true;
-		}
-	}
-
-	return false;
-}
-
-/*SHIFT SPRITE'S INNER BOX COLLIDERS BY VELOCITY X & Y*/
-void shiftBoxColliders(Sprite* sprite, int velX, int velY){
-	int i;
-
-	for(i = 0; i < sprite->nBoxColliders; i++){
-		sprite->boxColliders[i].x += velX;
-		sprite->boxColliders[i].y += velY;
-	}
-}
-
-/*MOVE SPRITE IF NOT COLLIDING AGAINST spritesColliding OR LEVEL BOUNDS BASED ON ITS POSITION AND VELOCITY (IF APPLICABLE), SEND COLLISION TO collisionHandler IF NECESSARY*/
-void move(Sprite* sprite, Sprite** spritesColliding, int nSpritesColliding)
-{
-	bool collision = false;
-	int i, collidingIndex = -1;
-
-	if(hasColliders(*sprite)) //CHECK FOR COLLISIONS
-	{
-		moveAllColliders(sprite, sprite->velX, sprite->velY);
-		collision = checkLevelBoundsCollision(*sprite) || checkTileMapCollisions(*sprite); //VS LEVEL BOUNDS && LEVEL TILES CHECK
-
-		for(i = 0; i < nSpritesColliding && !collision; i++){  //VS OTHER COLLIDERS
-			if(spritesColliding[i] == NULL || spritesColliding[i] == sprite) continue; //SKIP NULL OR CALLER SPRITES 
-
-			collision = checkCircularCollision(*sprite, *spritesColliding[i]) || //CIRCULAR COLLIDERS CHECK
-						(checkCollision(sprite->collider, spritesColliding[i]->collider) && //OUTER BOX COLLISIONS CHECK
-						(sprite->nBoxColliders == 0 || spritesColliding[i]->nBoxColliders == 0 || 
-						checkInnerBoxesCollisions(sprite->boxColliders, sprite->nBoxColliders, spritesColliding[i]->boxColliders, spritesColliding[i]->nBoxColliders))); //INNER BOXES PER-PIXEL COLLISIONS CHECK
-		}
-
-		collidingIndex = i-1;
-	}
-
-	if(!collision){
-		//MOVE SPRITE
-		sprite->x += sprite->velX;
-		sprite->y += sprite->velY;
-	}
-	else{
-		//COLLISION HANDLER CALL
-		if(sprite->collisionHandler != NULL && spritesColliding != NULL && collidingIndex >= 0)
-			sprite->collisionHandler(spritesColliding[collidingIndex]);
-		//MOVE COLLIDERS BACK
-		moveAllColliders(sprite, -sprite->velX, -sprite->velY);
-	}
-}
-
-/*MOVE sprite AND ITS INTERNAL COLLIDERS TO ABSOLUTE pos (NO COLLISION CHECKING)*/
-void moveTo(Sprite* sprite, SDL_Point pos)
-{
-	moveAllColliders(sprite, pos.x - sprite->x, pos.y - sprite->y);
-	sprite->x = pos.x;
-	sprite->y = pos.y;
-}
-
-/*MOVE ALL APPLICABLE sprite COLLIDERS BY VELOCITY X & Y*/
-void moveAllColliders(Sprite* sprite, int velX, int velY)
-{
-	if(sprite->collider.w != 0 || sprite->collider.h != 0){
-		sprite->collider.x += velX;
-		sprite->collider.y += velY;
-	}
-	
-	if(sprite->boxColliders != NULL && sprite->nBoxColliders != 0){
-		shiftBoxColliders(sprite, velX, velY);
-	}
-
-	if(sprite->circleCollider.r != 0){
-		sprite->circleCollider.x += velX;
-		sprite->circleCollider.y += velY;
-	}
-}
-
-/*RENDER ALL sprite'S AVAILABLE COLLIDERS RELATIVE TO camera IF NOT NULL BY SHADES OF SPECIFIED color*/
-void renderColliders(Sprite sprite, SDL_Rect* camera, SDL_Color color)
-{
-	SDL_Rect boxCollider;
-	Circle circleCollider;
-	SDL_Point cameraOffset = {0,0};
-	int i;
-
-	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-
-	if(camera != NULL){
-		cameraOffset.x = camera->x;
-		cameraOffset.y = camera->y;
-	}
-
-	if(sprite.collider.w != 0 || sprite.collider.h != 0){
-		boxCollider = sprite.collider;
-		boxCollider.x -= cameraOffset.x;
-		boxCollider.y -= cameraOffset.y;
-		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 30);
-		SDL_RenderFillRect(renderer, &boxCollider);
-	}
-
-	for(i = 0; i < sprite.nBoxColliders; i++){
-		boxCollider = sprite.boxColliders[i];
-		boxCollider.x -= cameraOffset.x;
-		boxCollider.y -= cameraOffset.y;
-		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 150);
-		SDL_RenderFillRect(renderer, &boxCollider);
-	}
-	
-	if(sprite.circleCollider.r != 0){
-		circleCollider = sprite.circleCollider;
-		circleCollider.x -= cameraOffset.x;
-		circleCollider.y -= cameraOffset.y;
-		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
-		SDL_RenderDrawLine(renderer, circleCollider.x, circleCollider.y, circleCollider.x + circleCollider.r, circleCollider.y);
-	}
-}
-
-/*CHANGE sprite ANIMATION RECT BASED ON INTERNAL FRAME COUNT & delayFactor*/
-void animate(Sprite* sprite, int delayFactor)
-{
-	int currentClipIndex = sprite->frame / (sprite->nClips*delayFactor);
-
-	if(currentClipIndex >= sprite->nClips){
-		sprite->frame = 0;
-		currentClipIndex = sprite->nClips - 1;
-	}
-
-	setRenderRect(sprite, currentClipIndex);
-}
-
-/*SET sprite CURRENT RENDER RECT AND UPDATE INTERNAL SIZE*/
-void setRenderRect(Sprite* sprite, int index)
-{
-	if(index < 0 || index >= sprite->nClips)
-		return;
-	
-	sprite->renderRect = &sprite->clips[index];
-	updateSpriteSize(sprite);
-}
-
-/*DELETE GIVEN SPRITE*/
-void freeSprite(Sprite* sprite)
-{
-	SDL_free(sprite->clips);
-	sprite->clips = NULL;
-	sprite->renderRect = NULL;
-
-	sprite->sheet = NULL;
-}
-
-/*PRINT SDL ERRS*/
-void print_err(const char* msg)
-{
-	printf("%s, %s\n", msg, SDL_GetError());
-}
-
-/*GET SQUARED DISTANCE BETWEN POINTS (x1, y1) and (x2, y2)*/
-int distanceSquared(int x1, int y1, int x2, int y2)
-{
-	int deltaX = x1 - x2;
-	int deltaY = y1 - y2;
-
-	return (deltaX * deltaX) + (deltaY * deltaY);
-}
-
-/*CHECK FOR ACTIVE COLLIDERS IN sprite*/
-bool hasColliders(Sprite sprite)
-{
-	return sprite.collider.w != 0 || sprite.collider.h != 0 || (sprite.boxColliders != NULL && sprite.nBoxColliders != 0) || sprite.circleCollider.r != 0;
-}
-
-/*HANDLE PLAYER INPUT FOR PAC-MAN*/
-void hanndlePacInput()
-{
-	const Uint8 *currentKeyStates = SDL_GetKeyboardState(NULL);
-
-	if(currentKeyStates[SDL_SCANCODE_UP]){
-		pac.velY = -PAC_SPEED;
-		pac.velX = 0;
-		pac.angle = -90;
-		pac.flip = SDL_FLIP_NONE;
-	} 
-	else if(currentKeyStates[SDL_SCANCODE_DOWN]){
-		pac.velY = PAC_SPEED;
-		pac.velX = 0;
-		pac.angle = 90;
-		pac.flip = SDL_FLIP_NONE;
+	if(currentKeyStates[SDL_SCANCODE_UP]){
+		pac.velY = -PAC_SPEED;
+		pac.velX = 0;
+		pac.angle = -90;
+		pac.flip = SDL_FLIP_NONE;
+	} 
+	else if(currentKeyStates[SDL_SCANCODE_DOWN]){
+		pac.velY = PAC_SPEED;
+		pac.velX = 0;
+		pac.angle = 90;
+		pac.flip = SDL_FLIP_NONE;
 	}
 	else if(currentKeyStates[SDL_SCANCODE_LEFT]){
 		pac.velX = -PAC_SPEED;
@@ -1540,22 +1152,21 @@ void handleTextInput(SDL_Event e)
 	
 	if(e.type == SDL_KEYDOWN){
 		if(e.key.keysym.scancode == SDL_SCANCODE_BACKSPACE && textLen > 0){
-			pacTextBox.textBuffer[textLen-1] = '\0';
+			pacTextBox.textBuffer[utf8Prev(pacTextBox.textBuffer, textLen)] = '\0'; //whole codepoint
 			textSaved = false;
 		}
 
 		if(e.key.keysym.scancode == SDL_SCANCODE_RETURN && textLen > 0){
-			pacTextBox.textBuffer[textLen] = SAVE_FILE_DELIMITER; //temp line separator for save file
-			SDL_RWwrite(saveFile, pacTextBox.textBuffer, textLen+1, 1);
-			pacTextBox.textBuffer[textLen] = '\0';
+			appendSavedLine(&saveFile, pacTextBox.textBuffer, textLen);
 			textSaved = true;
 		}
 
 		return;
 	}
 
+	//only whole codepoints go in, whatever part of the input doesn't fit is dropped
 	if(e.type == SDL_TEXTINPUT && textLen < TEXT_BOX_BUFFER_SIZE-1){
-		strncat(pacTextBox.textBuffer, e.text.text, TEXT_BOX_BUFFER_SIZE-textLen);
+		strncat(pacTextBox.textBuffer, e.text.text, utf8Fit(e.text.text, strlen(e.text.text), TEXT_BOX_BUFFER_SIZE-1-textLen));
 		textSaved = false;
 		return;
 	}
@@ -1564,8 +1175,12 @@ void handleTextInput(SDL_Event e)
 /*HANDLE AUDIO RECORDING/PLAYBACK FOR PAC*/
 void handleAudioInput()
 {
+	int textLen;
+
 	if(!pacAudioDevice.available){
-		strncpy(pacTextBox.textBuffer, pacAudioDevice.name, TEXT_BOX_BUFFER_SIZE);
+		textLen = utf8Fit(pacAudioDevice.name, strlen(pacAudioDevice.name), TEXT_BOX_BUFFER_SIZE-1);
+		strncpy(pacTextBox.textBuffer, pacAudioDevice.name, textLen);
+		pacTextBox.textBuffer[textLen] = '\0';
 		return;
 	}
 
@@ -1573,22 +1188,48 @@ void handleAudioInput()
 	case PAUSED:
 		if(pacRecorder.renderRect == &pacRecorder.clips[ON]) //if switch on
 		{
-			pacAudioDevice.bufferCurrentPos = 0;
+			resetAdpcmClip(&pacAudioDevice.clip, &pacAudioDevice.clipEncoder);
+			resetAudioConverter(&pacAudioDevice.clipConverter);
+			resetRingBuffer(&pacAudioDevice.captureRing); //device paused, callback not running
+			resetRingBuffer(&pacAudioDevice.peakRing);
+			resetPeakPyramid(&pacAudioDevice.waveform);
+			initPeakAccumulator(&pacAudioDevice.waveAccumulator, &pacAudioDevice.recordingSpec);
+
+			if(pacAudioDevice.streamPath != NULL && !startWavWriter(&pacAudioStream, pacAudioDevice.streamPath, &pacAudioDevice.recordingSpec,
+				&pacAudioDevice.captureRing, tapStreamPeaks, NULL)){
+				pacRecorder.renderRect = &pacRecorder.clips[OFF];
+				break;
+			}
+
 			SDL_PauseAudioDevice(pacAudioDevice.recordingId, SDL_FALSE);
 			pacAudioDevice.state = RECORDING;
 		}
 		break;
 	case RECORDING:
-		SDL_LockAudioDevice(pacAudioDevice.recordingId);
+		if(pacAudioDevice.streamPath != NULL){
+			drainStreamPeaks();
+
+			//the writer thread drains the ring, stop on a second press or at the length limit
+			if(pacRecorder.renderRect == &pacRecorder.clips[OFF] ||
+				(pacAudioDevice.streamMaxBytes > 0 && (Uint32)SDL_AtomicGet(&pacAudioStream.bytes) >= pacAudioDevice.streamMaxBytes)){
+				SDL_PauseAudioDevice(pacAudioDevice.recordingId, SDL_TRUE);
+				stopWavWriter(&pacAudioStream);
+				drainStreamPeaks(); //the writer's last chunks
+				pacAudioDevice.state = RECORDED;
+
+				pacRecorder.renderRect = &pacRecorder.clips[OFF];
+			}
+			break;
+		}
 
-		if(pacAudioDevice.bufferCurrentPos > pacAudioDevice.bufferMaxPos){
+		//drain what the callback captured since last frame into the clip
+		if(!encodeCapturedAudio()){
 			SDL_PauseAudioDevice(pacAudioDevice.recordingId, SDL_TRUE);
+			flushAdpcmEncoder(&pacAudioDevice.clipEncoder, &pacAudioDevice.clip);
 			pacAudioDevice.state = RECORDED;
 
 			pacRecorder.renderRect = &pacRecorder.clips[OFF];
 		}
-
-		SDL_UnlockAudioDevice(pacAudioDevice.recordingId);
 		break;
 	case RECORDED:
 		if(pacRecorder.renderRect == &pacRecorder.clips[ON]){
@@ -1596,100 +1237,200 @@ void handleAudioInput()
 		}
 		else{
 			if(textSaved){ //playback along saving text XD
-				pacAudioDevice.bufferCurrentPos = 0;
+				resetRingBuffer(&pacAudioDevice.playbackRing); //device paused, callback not running
+
+				if(pacAudioDevice.streamPath != NULL){
+					if(!startWavReader(&pacAudioStream, pacAudioDevice.streamPath, &pacAudioDevice.playbackRing, &pacAudioDevice.playbackSpec)){
+						textSaved = false;
+						break;
+					}
+				}
+				else{
+					startAdpcmDecoder(&pacAudioDevice.clipDecoder);
+					pacAudioDevice.clipSamplesPos = pacAudioDevice.clipSamplesLen = 0;
+					resetAudioConverter(&pacAudioDevice.playbackConverter);
+					feedAudioPlayback();
+				}
+
 				SDL_PauseAudioDevice(pacAudioDevice.playbackId, SDL_FALSE);
 				pacAudioDevice.state = PLAYBACK;
 			}
 		}
 		break;
 	case PLAYBACK:
-		SDL_LockAudioDevice(pacAudioDevice.playbackId);
+		if(pacAudioDevice.streamPath == NULL) //streams are fed by their reader thread
+			feedAudioPlayback();
 
-		if(pacAudioDevice.bufferCurrentPos > pacAudioDevice.bufferMaxPos){
+		//everything fed and played
+		if(SDL_AtomicGet(&pacAudioDevice.playbackRing.finished) && ringBufferAvailable(&pacAudioDevice.playbackRing) == 0){
 			SDL_PauseAudioDevice(pacAudioDevice.playbackId, SDL_TRUE);
+			stopWavReader(&pacAudioStream);
 			pacAudioDevice.state = RECORDED;
 			textSaved = false;
 		}
-
-		SDL_UnlockAudioDevice(pacAudioDevice.playbackId);
-		renderPacSoundWave();
 		break;
 	}
 }
 
-/*HANDLE WINDOW FOCUS AND SIZE EVENTS*/
-void handleWindowEvents(SDL_Event e)
+/*ENCODE WHAT THE CALLBACK CAPTURED SINCE LAST FRAME INTO THE CLIP (PEAKS FROM THE RAW AUDIO), FALSE ONCE THE CLIP IS FULL*/
+bool encodeCapturedAudio()
 {
-	if(e.type == SDL_WINDOWEVENT){
-		switch(e.window.event)
+	Uint8 captured[AUDIO_CONVERT_CHUNK];
+	Sint16 samples[AUDIO_CONVERT_CHUNK / sizeof(Sint16)];
+	AudioConverter *conv = &pacAudioDevice.clipConverter;
+	AdpcmClip *clip = &pacAudioDevice.clip;
+	Uint32 read, offset, n, used, frames, left;
+
+	while(ringBufferAvailable(&pacAudioDevice.captureRing) >= (Uint32)conv->inFrameSize)
+	{
+		read = SDL_min(ringBufferAvailable(&pacAudioDevice.captureRing), (Uint32)sizeof(captured));
+		read = ringBufferRead(&pacAudioDevice.captureRing, captured, read - read % conv->inFrameSize);
+		accumulatePeaks(&pacAudioDevice.waveAccumulator, captured, read, addWaveformPeak, NULL);
+
+		for(offset = 0; offset < read; offset += used)
 		{
-		case SDL_WINDOWEVENT_SIZE_CHANGED:
-			camera->w = e.window.data1; //new width
-			camera->h = e.window.data2; //new height
-			break;
-		default:
-			break;
+			n = convertAudio(conv, captured + offset, read - offset, (Uint8*)samples, sizeof(samples), &used);
+			if(n == 0 && used == 0)
+				break;
+
+			left = pacAudioDevice.clipMaxFrames - (clip->frames + pacAudioDevice.clipEncoder.nPending);
+			frames = SDL_min(n / conv->outFrameSize, left);
+			if(encodeAdpcm(&pacAudioDevice.clipEncoder, clip, samples, frames) < n / conv->outFrameSize)
+				return false;
 		}
 	}
+
+	return clip->frames + pacAudioDevice.clipEncoder.nPending < pacAudioDevice.clipMaxFrames;
 }
 
-void switchRecorder(SDL_Event e)
+/*TOP UP THE PLAYBACK RING FROM THE CLIP, DECODED AND CONVERTED TO THE PLAYBACK SPEC A CHUNK AT A TIME, MARKING IT FINISHED ONCE THE WHOLE CLIP IS QUEUED*/
+void feedAudioPlayback()
 {
-	if(e.type == SDL_MOUSEBUTTONDOWN && pacAudioDevice.state != PLAYBACK)
-	{
-		int x, y;
+	Uint8 converted[AUDIO_CONVERT_CHUNK];
+	Uint32 space, n, used, frameBytes = pacAudioDevice.playbackConverter.inFrameSize;
 
-		SDL_GetMouseState(&x, &y);
-		x += camera->x;
-		y += camera->y;
+	while((space = ringBufferSpace(&pacAudioDevice.playbackRing)) > 0)
+	{
+		if(pacAudioDevice.clipSamplesPos == pacAudioDevice.clipSamplesLen){
+			pacAudioDevice.clipSamplesLen = decodeAdpcm(&pacAudioDevice.clipDecoder, &pacAudioDevice.clip, pacAudioDevice.clipSamples, AUDIO_CLIP_CHUNK_FRAMES);
+			pacAudioDevice.clipSamplesPos = 0;
 
-		//Recorder button pressed
-		if((x > pacRecorder.x) && (x < pacRecorder.x + pacRecorder.w) && (y > pacRecorder.y) && (y < pacRecorder.y + pacRecorder.h)){
-			setRenderRect(&pacRecorder, ON);
+			if(pacAudioDevice.clipSamplesLen == 0){ //whole clip queued
+				ringBufferFinish(&pacAudioDevice.playbackRing);
+				break;
+			}
 		}
+
+		n = convertAudio(&pacAudioDevice.playbackConverter, (Uint8*)&pacAudioDevice.clipSamples[pacAudioDevice.clipSamplesPos * pacAudioDevice.clip.channels],
+			(pacAudioDevice.clipSamplesLen - pacAudioDevice.clipSamplesPos) * frameBytes, converted, SDL_min(space, (Uint32)AUDIO_CONVERT_CHUNK), &used);
+
+		if(n == 0 && used == 0)
+			break;
+
+		pacAudioDevice.clipSamplesPos += used / frameBytes;
+		ringBufferWrite(&pacAudioDevice.playbackRing, converted, n);
 	}
 }
 
-/*RENDER AND RESIZE textbox AND ITS COMPONENTS BASED ON INTERNAL TEXT BUFFER*/
-void renderTextBox(Textbox* textbox)
+/*WAVEFORM PEAK HANDLER FOR RECORDINGS DRAINED ON THE GAME THREAD*/
+void addWaveformPeak(void* data, Peak peak)
 {
-	char line[TEXT_BOX_MAX_LINE_SIZE+1];
-	int textLen = strlen(textbox->textBuffer);
-	int nLines = (textLen/TEXT_BOX_MAX_LINE_SIZE)+1;
-	int i, lineHeightOffset = textbox->textTexture.h*(nLines-1);
+	addPeak(&pacAudioDevice.waveform, peak);
+}
 
-	textbox->y -= lineHeightOffset;
-	textbox->h += lineHeightOffset;
+/*WAVEFORM PEAK HANDLER ON THE WRITER THREAD: HAND WHOLE PEAKS TO THE GAME THREAD (DROPPED IF IT FELL BEHIND)*/
+void queueStreamPeak(void* data, Peak peak)
+{
+	if(ringBufferSpace(&pacAudioDevice.peakRing) >= sizeof(Peak))
+		ringBufferWrite(&pacAudioDevice.peakRing, &peak, sizeof(Peak));
+}
 
-	textbox->sprite.x = textbox->x;
-	textbox->sprite.y = textbox->y;
+/*WRITER THREAD TAP: SUMMARIZE EACH CHUNK STREAMED TO DISK INTO WAVEFORM PEAKS*/
+void tapStreamPeaks(void* data, const Uint8* bytes, Uint32 len)
+{
+	accumulatePeaks(&pacAudioDevice.waveAccumulator, bytes, len, queueStreamPeak, NULL);
+}
 
-	setScaleRect(&textbox->sprite, textbox->sprite.w, textbox->h);
+/*ADD THE PEAKS QUEUED BY THE WRITER THREAD TO PAC'S WAVEFORM*/
+void drainStreamPeaks()
+{
+	Peak peak;
 
-	renderSprite(textbox->sprite, camera);
+	while(ringBufferAvailable(&pacAudioDevice.peakRing) >= sizeof(Peak)){
+		ringBufferRead(&pacAudioDevice.peakRing, &peak, sizeof(Peak));
+		addPeak(&pacAudioDevice.waveform, peak);
+	}
+}
 
-	//clear text texture
-	SDL_DestroyTexture(textbox->textTexture.texture);
-	textbox->textTexture.texture = NULL;
+/*MOUSE WHEEL ZOOMS PAC'S WAVEFORM IN AND OUT*/
+void handleWaveformZoom(SDL_Event e)
+{
+	if(e.type == SDL_MOUSEWHEEL && e.wheel.y != 0){
+		waveSeconds = e.wheel.y > 0 ? waveSeconds / WAVE_ZOOM_STEP : waveSeconds * WAVE_ZOOM_STEP;
+		waveSeconds = SDL_min(SDL_max(waveSeconds, WAVE_MIN_SECONDS), WAVE_MAX_SECONDS);
+	}
+}
 
-	if(nLines == 1) //no split needed
+/*PLAY WAKA WHILE PAC MOVES (AND ON EVERY GHOST WITH --ghost-voices), KEEPING EACH VOICE'S GAIN/PAN ON ITS SPRITE RELATIVE TO THE CAMERA*/
+void updateSoundEffects()
+{
+	float gainL, gainR;
+	int i;
+
+	spatialGains(pac.x + pac.w/2, pac.y + pac.h/2, camera, &gainL, &gainR);
+	if(voicePlaying(&sfxMixer, pacVoice))
+		setVoiceGain(&sfxMixer, pacVoice, gainL, gainR);
+	else if(pac.velX != 0 || pac.velY != 0)
+		pacVoice = playSound(&sfxMixer, getSound(&resources, waka), gainL, gainR, false);
+
+	if(!stress.ghostVoices)
+		return;
+
+	for(i = 0; i < stress.nGhosts; i++)
 	{
-		textbox->textTexture = loadRenderedText(textbox->textBuffer, textbox->textColor, textBoxFont);
-		render(textbox->textTexture, textbox->x+10, textbox->y+10, NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
+		spatialGains(ghosts[i].x + ghosts[i].w/2, ghosts[i].y + ghosts[i].h/2, camera, &gainL, &gainR);
+
+		if(voicePlaying(&sfxMixer, ghostVoices[i]))
+			setVoiceGain(&sfxMixer, ghostVoices[i], gainL, gainR);
+		else
+			ghostVoices[i] = playSound(&sfxMixer, getSound(&resources, waka), gainL, gainR, true);
 	}
-	else //split buffer lines
-	{
-		for(i = 0; i < nLines; i++)
+}
+
+/*HANDLE WINDOW FOCUS AND SIZE EVENTS*/
+void handleWindowEvents(SDL_Event e)
+{
+	if(e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET){
+		invalidateDirtyRegions(&dirtyRegions); //the kept scene is gone
+	}
+
+	if(e.type == SDL_WINDOWEVENT){
+		switch(e.window.event)
 		{
-			strncpy(line, textbox->textBuffer+(i*TEXT_BOX_MAX_LINE_SIZE), TEXT_BOX_MAX_LINE_SIZE);
-			line[TEXT_BOX_MAX_LINE_SIZE] = '\0';
+		case SDL_WINDOWEVENT_SIZE_CHANGED:
+			camera->w = e.window.data1; //new width
+			camera->h = e.window.data2; //new height
+			break;
+		default:
+			break;
+		}
+	}
+}
 
-			//clear temp text texture each loop
-			SDL_DestroyTexture(textbox->textTexture.texture);
-			textbox->textTexture.texture = NULL;
+void switchRecorder(SDL_Event e)
+{
+	if(e.type == SDL_MOUSEBUTTONDOWN && pacAudioDevice.state != PLAYBACK)
+	{
+		int x = e.button.x + camera->x;
+		int y = e.button.y + camera->y;
 
-			textbox->textTexture = loadRenderedText(line, textbox->textColor, textBoxFont);
-			render(textbox->textTexture, textbox->x+10, textbox->y+10+(i*textbox->textTexture.h), NULL, NULL, 0, NULL, SDL_FLIP_NONE, camera);
+		//Recorder button pressed
+		if((x > pacRecorder.x) && (x < pacRecorder.x + pacRecorder.w) && (y > pacRecorder.y) && (y < pacRecorder.y + pacRecorder.h)){
+			//streamed recordings have no fixed length: pressing again stops them
+			if(pacAudioDevice.state == RECORDING && pacAudioDevice.streamPath != NULL)
+				setRenderRect(&pacRecorder, OFF);
+			else
+				setRenderRect(&pacRecorder, ON);
 		}
 	}
 }
@@ -1697,8 +1438,6 @@ void renderTextBox(Textbox* textbox)
 /*RENDER AND RESIZE PACMAN'S TEXTBOXES AND ITS COMPONENTS BASED ON INPUT BUFFER AND CURRENT SAVED TEXT STATE*/
 void renderPacTextBoxes()
 {
-	int textLen = strlen(pacTextBox.textBuffer);
-
 	pacTextBox.x = pac.x + (SHEET_STANDARD_SPRITE_SIZE/2);
 	pacTextBox.y = pac.y - (SHEET_STANDARD_SPRITE_SIZE/2);
 	pacTextBox.h = (SHEET_STANDARD_SPRITE_SIZE/2);
@@ -1706,9 +1445,10 @@ void renderPacTextBoxes()
 
 	renderTextBox(&pacTextBox);
 
-	textCursor.x = pacTextBox.x+10 + (textLen%TEXT_BOX_MAX_LINE_SIZE > 0 ? pacTextBox.textTexture.w : 0);
-	textCursor.y = (pac.y - (SHEET_STANDARD_SPRITE_SIZE/2))+11;
-	animate(&textCursor, 8);
+	//after the last wrapped line, which stays where the box started as it grows upwards
+	textCursor.x = pacTextBox.x+TEXT_BOX_PADDING + pacTextBox.layout.lastLineWidth;
+	textCursor.y = (pac.y - (SHEET_STANDARD_SPRITE_SIZE/2))+TEXT_BOX_PADDING+1;
+	animateVisible(&textCursor, 8, camera);
 	renderSprite(textCursor, camera);
 	textCursor.frame++;
 
@@ -1729,14 +1469,27 @@ void renderPacRecorderButton()
 	renderSprite(pacRecorder, camera);
 }
 
-/*RENDER PACMAN'S SOUND WAVE ANIMATION FOR SOUND PLAYBACK*/
+/*RENDER PACMAN'S RECORDING WAVEFORM WHILE RECORDING/PLAYING (LAST waveSeconds UP TO THE CURRENT POSITION), CANNED SOUND WAVE IF THERE ARE NO PEAKS*/
 void renderPacSoundWave()
 {
-	if(pacAudioDevice.state == PLAYBACK){
+	int frameBytes;
+	Uint64 end, played;
+	double frames;
+
+	if((pacAudioDevice.state == RECORDING || pacAudioDevice.state == PLAYBACK) && pacAudioDevice.waveform.frames > 0){
+		frameBytes = pacAudioDevice.playbackSpec.channels * (SDL_AUDIO_BITSIZE(pacAudioDevice.playbackSpec.format) / 8);
+		played = (Uint32)SDL_AtomicGet(&pacAudioDevice.playbackRing.tail) / frameBytes; //in playback frames, the waveform counts recording frames
+		end = pacAudioDevice.state == RECORDING ? pacAudioDevice.waveform.frames : played * pacAudioDevice.recordingSpec.freq / pacAudioDevice.playbackSpec.freq;
+		frames = waveSeconds * pacAudioDevice.recordingSpec.freq;
+
+		renderWaveform(&pacAudioDevice.waveform, (Sint64)end - (Sint64)frames, frames / WAVE_VIEW_WIDTH,
+			(SDL_Rect){pac.x + SHEET_STANDARD_SPRITE_SIZE, pac.y + (SHEET_STANDARD_SPRITE_SIZE - WAVE_VIEW_HEIGHT)/2, WAVE_VIEW_WIDTH, WAVE_VIEW_HEIGHT}, yellow, camera);
+	}
+	else if(pacAudioDevice.state == PLAYBACK){
 		soundwave.x = pac.x + SHEET_STANDARD_SPRITE_SIZE;
 		soundwave.y = pac.y + (SHEET_STANDARD_SPRITE_SIZE/2 - soundwave.h/2);
 
-		animate(&soundwave, 8);
+		animateVisible(&soundwave, 8, camera);
 		renderSprite(soundwave, camera);
 		soundwave.frame++;
 	}
@@ -1746,48 +1499,6 @@ void renderPacSoundWave()
 	}
 }
 
-/*MODIFY map'S INNER TILE SHEET TEXTURE TO INCLUDE SINE WAVE-ALIKE PIXELS*/
-void addSineWaveTexture(TileMap* map, int startPeriod)
-{
-	Texture *tileTexture = map->sheet;
-	SDL_PixelFormat *pixelFormat;
-	Uint32 *pixels, *origPixels, greenPixel;
-	int /*nPixels = 0,*/ i;
-
-	if(!lockPixelTexture(tileTexture) || !lockPixelTexture(&tileSheetOrig))
-		return;
-
-	pixelFormat = SDL_AllocFormat(SDL_GetWindowPixelFormat(window));
-	pixels = (Uint32*)tileTexture->pixels;
-	origPixels = (Uint32*)tileSheetOrig.pixels;
-	//nPixels = (tileTexture->pitch / 4) * tileTexture->h;
-	greenPixel = SDL_MapRGB(pixelFormat, green.r, green.g, green.b);
-	//int end = (tileTexture->h*(tileTexture->h/2)) + ((tileTexture->pitch / 4)*5), 
-	int x, y, j, index;
-
-	for(x = 0, i = tileTexture->h*(tileTexture->h/2); x < (tileTexture->pitch / 4); x++){
-		y = (int)(sin((double)((x + startPeriod)/5))*5) * (tileTexture->pitch / 4);
-
-		for(j = 1; j <= 13; j++){
-			index = (i-(5*(tileTexture->pitch / 4)))+(j*(tileTexture->pitch / 4));
-			pixels[index+x] = origPixels[index+x];
-		}
-
-		for(j = 0; j < 5; j++){
-			index = (i-y)+(j*(tileTexture->pitch / 4));
-			pixels[index+x] = greenPixel;
-		}
-	}
-
-	/*for(i = tileTexture->h*(tileTexture->h/2); i < end; i++){
-		pixels[i] = greenPixel;
-	}*/
-
-	unlockPixelTexture(tileTexture);
-	unlockPixelTexture(&tileSheetOrig);
-	SDL_FreeFormat(pixelFormat);
-}
-
 /*RENDER AND RESIZE GHOSTS TEXTBOXES AND ITS COMPONENTS BASED ON INPUT BUFFER*/
 void renderGhostsTextBoxes()
 {
@@ -1809,11 +1520,11 @@ Sprite loadSparklesSprite(SDL_Point initialPosition)
 {
 	Sprite spark;
 
-	spark = loadSprite(N_SPARKLES_RENDERS, &sparklesSheet, initialPosition.x, initialPosition.y, 0, NULL, SDL_FLIP_NONE, NULL);
-	
-	addClip(&spark, SMALL_SPARK, (SDL_Rect){35, 27, 10, 10}, true);
-	addClip(&spark, MEDIUM_SPARK, (SDL_Rect){68, 32, 14, 14}, false);
-	addClip(&spark, BIG_SPARK, (SDL_Rect){8, 43, 20, 20}, false);
+	spark = loadSprite(N_SPARKLES_RENDERS, NULL, initialPosition.x, initialPosition.y, 0, NULL, SDL_FLIP_NONE, NULL);
+
+	addAtlasClip(&spark, SMALL_SPARK, &spriteAtlas, "spark_small", 0, true);
+	addAtlasClip(&spark, MEDIUM_SPARK, &spriteAtlas, "spark_medium", 0, false);
+	addAtlasClip(&spark, BIG_SPARK, &spriteAtlas, "spark_big", 0, false);
 
 	spark.frame = rand()%N_SPARKLES_RENDERS;
 
@@ -1843,7 +1554,7 @@ void renderSparkles()
 			sparkles[i].frame = rand()%N_SPARKLES_RENDERS;
 		}
 		
-		animate(&sparkles[i], 2);
+		animateVisible(&sparkles[i], 2, camera);
 		sparkles[i].frame++;
 
 		renderSprite(sparkles[i], camera);
@@ -1856,7 +1567,7 @@ void randomizeGhostsVelocity()
 	int i = 0;
 	//Sprite testCollider;
 
-	for(i = 0; i < N_GHOSTS; i++)
+	for(i = 0; i < stress.nGhosts; i++)
 	{
 		/*testCollider = ghosts[i];
 		testCollider.collider.x -= 10;
@@ -1891,11 +1602,118 @@ void centerCamera()
 		camera->y = 0;
 	}
 
-	if(camera->x + camera->w > LEVEL_WIDTH){
-		camera->x = LEVEL_WIDTH - camera->w;
+	if(camera->x + camera->w > levelWidth){
+		camera->x = levelWidth - camera->w;
+	}
+
+	if(camera->y + camera->h > levelHeight){
+		camera->y = levelHeight - camera->h;
+	}
+}
+/*HANDLE DEBUG/PROFILING KEYS (F1: PERF HUD, F2: COLLIDER OVERLAY)*/
+void handleDebugInput(SDL_Event e)
+{
+	if(e.type == SDL_KEYDOWN && !e.key.repeat && e.key.keysym.scancode == SDL_SCANCODE_F1){
+		hudVisible = !hudVisible;
+		hudRefreshTicks = 0;
+	}
+
+	if(e.type == SDL_KEYDOWN && !e.key.repeat && e.key.keysym.scancode == SDL_SCANCODE_F2){
+		toggleDebugDraw();
 	}
+}
+
+/*REFORMAT PERF HUD TEXT LINES FROM CURRENT PERF WINDOW (THROTTLED TO HUD_REFRESH_MS BY CALLER)*/
+void updatePerfHUDText()
+{
+	Uint32 newestTicks;
+	double recentMs = 0;
+	int i, n, recentFrames = 0, last;
 
-	if(camera->y + camera->h > LEVEL_HEIGHT){
-		camera->y = LEVEL_HEIGHT - camera->h;
+	if(perf.count == 0)
+		return;
+
+	last = (perf.head - 1 + PERF_HISTORY_SIZE) % PERF_HISTORY_SIZE;
+	newestTicks = perf.frameTicks[last];
+
+	//current fps: frames closed during the last refresh period
+	for(n = 0; n < perf.count; n++){
+		i = (last - n + PERF_HISTORY_SIZE) % PERF_HISTORY_SIZE;
+		if(newestTicks - perf.frameTicks[i] > HUD_REFRESH_MS)
+			break;
+		recentMs += perf.frameMs[i];
+		recentFrames++;
+	}
+
+	snprintf(hudLines[0], HUD_LINE_SIZE, "FPS %.0f  AVG %.1f",
+		recentMs > 0 ? recentFrames * 1000.0 / recentMs : 0.0, perf.totalMs > 0 ? perf.count * 1000.0 / perf.totalMs : 0.0);
+	snprintf(hudLines[1], HUD_LINE_SIZE, "P50 %.1f  P95 %.1f  P99 %.1f MS",
+		perfPercentile(&perf, 0.50f), perfPercentile(&perf, 0.95f), perfPercentile(&perf, 0.99f));
+	snprintf(hudLines[2], HUD_LINE_SIZE, "DRAWS %d  UPLOADS %d  ALLOCS %d /F",
+		perf.frameDrawCalls[last], perf.frameUploads[last], perf.frameAllocations[last]);
+	snprintf(hudLines[3], HUD_LINE_SIZE, "%dS: DRAWS %d  UPL %d  ALLOC %d",
+		PERF_WINDOW_MS / 1000, perf.totalDrawCalls, perf.totalUploads, perf.totalAllocations);
+	snprintf(hudLines[4], HUD_LINE_SIZE, "HUD %.2f XRUN %d/%d MIX %dUS V%d", hudCostMs,
+		SDL_AtomicGet(&pacAudioDevice.captureRing.overruns), SDL_AtomicGet(&pacAudioDevice.playbackRing.underruns),
+		SDL_AtomicGet(&sfxMixer.callbackUs), SDL_AtomicGet(&sfxMixer.activeVoices));
+	if(dirtyRegions.enabled){
+		snprintf(hudLines[5], HUD_LINE_SIZE, "DIRTY %d RECTS  %d%% REDRAWN", dirtyRegions.nRects, dirtyRegions.redrawnPercent);
 	}
-}
\ No newline at end of file
+	else{
+		snprintf(hudLines[5], HUD_LINE_SIZE, "RES %d%% %dX%d  TARGET %d FPS%s", resolution.percent,
+			(camera->w * resolution.percent + 99) / 100, (camera->h * resolution.percent + 99) / 100, targetFps, resolution.enabled ? "" : " (FIXED)");
+	}
+}
+
+/*RENDER PERF OVERLAY (STATS TEXT FROM CACHED GLYPHS + ROLLING FRAME TIME GRAPH) IN SCREEN SPACE*/
+void renderPerfHUD()
+{
+	SDL_Point *graph = NULL, budget[2];
+	SDL_Rect panel;
+	Uint64 start;
+	float ms;
+	int i, n, index, x, y, graphBottom, budgetY;
+
+	if(!hudVisible)
+		return;
+
+	start = SDL_GetPerformanceCounter();
+
+	if(hudRefreshTicks == 0 || SDL_GetTicks() - hudRefreshTicks >= HUD_REFRESH_MS){
+		updatePerfHUDText();
+		hudRefreshTicks = SDL_GetTicks();
+	}
+
+	x = 20;
+	y = 20;
+	panel = (SDL_Rect){10, 10, HUD_GRAPH_WIDTH + 20, (HUD_N_LINES * hudGlyphs.lineHeight) + HUD_GRAPH_HEIGHT + 30};
+
+	drawFillRects(&panel, 1, (SDL_Color){0, 0, 0, 180}, SDL_BLENDMODE_BLEND);
+
+	for(i = 0; i < HUD_N_LINES; i++){
+		renderGlyphText(&hudGlyphs, hudLines[i], x, y, yellow);
+		y += hudGlyphs.lineHeight;
+	}
+
+	//frame time graph, newest sample on the right
+	graphBottom = y + 10 + HUD_GRAPH_HEIGHT;
+	n = perf.count < HUD_GRAPH_WIDTH ? perf.count : HUD_GRAPH_WIDTH;
+	graph = (SDL_Point*)arenaAlloc(&frameArena, sizeof(SDL_Point) * HUD_GRAPH_WIDTH);
+	if(graph == NULL)
+		n = 0;
+
+	for(i = 0; i < n; i++){
+		index = (perf.head - n + i + PERF_HISTORY_SIZE) % PERF_HISTORY_SIZE;
+		ms = perf.frameMs[index] < HUD_GRAPH_MAX_MS ? perf.frameMs[index] : HUD_GRAPH_MAX_MS;
+		graph[i] = (SDL_Point){x + HUD_GRAPH_WIDTH - n + i, graphBottom - (int)(ms * HUD_GRAPH_HEIGHT / HUD_GRAPH_MAX_MS)};
+	}
+
+	//60 fps budget reference line
+	budgetY = graphBottom - (int)(PERF_FRAME_BUDGET_MS * HUD_GRAPH_HEIGHT / HUD_GRAPH_MAX_MS);
+	budget[0] = (SDL_Point){x, budgetY};
+	budget[1] = (SDL_Point){x + HUD_GRAPH_WIDTH, budgetY};
+	drawLines(budget, 2, (SDL_Color){lightBlack.r, lightBlack.g, lightBlack.b, 255}, SDL_BLENDMODE_BLEND);
+	drawLines(graph, n, (SDL_Color){0, 255, 0, 255}, SDL_BLENDMODE_BLEND);
+
+	hudCostMs = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
@@ -0,0 +1,363 @@
+#include "mixer.h"
+#include "engine.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIXER_SSE2 1
+#endif
+
+bool sendMixerCommand(Mixer* mixer, MixerCommand command);
+void applyMixerCommands(Mixer* mixer);
+bool mixVoice(Voice* voice, float* mix, int frames);
+void mixKernel(float* mix, const float* samples, int frames, float gainL, float gainR);
+void writeMixS16(const float* mix, Sint16* out, int n);
+void writeMixF32(const float* mix, float* out, int n);
+
+/*PREPARE mixer FOR AN OUTPUT OF freq/format/channels (SIGNED 16 BIT OR FLOAT, MONO OR STEREO)*/
+bool initMixer(Mixer* mixer, int freq, SDL_AudioFormat format, int channels)
+{
+	int i;
+
+	SDL_zerop(mixer);
+	mixer->freq = freq;
+	mixer->format = format;
+	mixer->channels = channels;
+
+	if((format != AUDIO_S16SYS && format != AUDIO_F32SYS) || (channels != 1 && channels != 2)){
+		SDL_SetError("Unsupported mixer output format");
+		print_err("Could not initialize sound effects mixer");
+		return false;
+	}
+
+	if(!initRingBuffer(&mixer->commands, MIXER_MAX_COMMANDS * sizeof(MixerCommand))){
+		print_err("Could not allocate mixer command queue");
+		return false;
+	}
+
+	for(i = 0; i < MIXER_MAX_VOICES; i++)
+		SDL_AtomicSet(&mixer->busy[i], 0);
+
+	mixer->ready = true;
+
+	return true;
+}
+
+/*RELEASE mixer (AFTER ITS CALLBACK WAS UNHOOKED)*/
+void closeMixer(Mixer* mixer)
+{
+	freeRingBuffer(&mixer->commands);
+	mixer->ready = false;
+}
+
+/*LOAD A WAV FILE THROUGH SDL_mixer (ALREADY RESAMPLED TO THE OUTPUT RATE) AND KEEP IT AS STEREO FLOAT*/
+bool loadSound(Mixer* mixer, Sound* sound, const char* path)
+{
+	Mix_Chunk *chunk;
+	int sampleSize = SDL_AUDIO_BITSIZE(mixer->format) / 8;
+	Uint32 i;
+	Sint16 s16;
+	float left, right;
+
+	sound->samples = NULL;
+	sound->frames = 0;
+
+	if(!mixer->ready)
+		return false;
+
+	chunk = Mix_LoadWAV(path);
+	if(chunk == NULL){
+		print_err("Could not load sound");
+		return false;
+	}
+
+	sound->frames = chunk->alen / (sampleSize * mixer->channels);
+	sound->samples = (float*)SDL_malloc(sound->frames * 2 * sizeof(float));
+	if(sound->samples == NULL){
+		print_err("Could not allocate sound samples");
+		sound->frames = 0;
+		Mix_FreeChunk(chunk);
+		return false;
+	}
+
+	for(i = 0; i < sound->frames; i++)
+	{
+		if(mixer->format == AUDIO_S16SYS){
+			SDL_memcpy(&s16, chunk->abuf + (i * mixer->channels) * sizeof(Sint16), sizeof(Sint16));
+			left = s16 * (1.0f / 32768.0f);
+			if(mixer->channels == 2)
+				SDL_memcpy(&s16, chunk->abuf + (i * 2 + 1) * sizeof(Sint16), sizeof(Sint16));
+			right = s16 * (1.0f / 32768.0f);
+		}
+		else{
+			SDL_memcpy(&left, chunk->abuf + (i * mixer->channels) * sizeof(float), sizeof(float));
+			right = left;
+			if(mixer->channels == 2)
+				SDL_memcpy(&right, chunk->abuf + (i * 2 + 1) * sizeof(float), sizeof(float));
+		}
+
+		sound->samples[i * 2] = left;
+		sound->samples[i * 2 + 1] = right;
+	}
+
+	Mix_FreeChunk(chunk);
+
+	return true;
+}
+
+/*FREE sound SAMPLES (NO VOICE MAY BE PLAYING IT)*/
+void freeSound(Sound* sound)
+{
+	SDL_free(sound->samples);
+	sound->samples = NULL;
+	sound->frames = 0;
+}
+
+/*START sound ON A FREE VOICE, RETURN ITS HANDLE OR -1 IF EVERY VOICE IS BUSY*/
+VoiceHandle playSound(Mixer* mixer, const Sound* sound, float gainL, float gainR, bool loop)
+{
+	MixerCommand command;
+	int i, slot;
+
+	if(!mixer->ready || sound == NULL || sound->frames == 0) //NULL: stale resource handle
+		return -1;
+
+	for(i = 0; i < MIXER_MAX_VOICES; i++)
+	{
+		slot = (mixer->nextVoice + i) % MIXER_MAX_VOICES;
+
+		if(SDL_AtomicGet(&mixer->busy[slot]) == 0){
+			SDL_AtomicSet(&mixer->busy[slot], 1);
+			mixer->generations[slot] = (mixer->generations[slot] + 1) & MIXER_GENERATION_MASK;
+
+			command = (MixerCommand){MIXER_PLAY, slot, mixer->generations[slot], sound, gainL, gainR, loop};
+			if(!sendMixerCommand(mixer, command)){
+				SDL_AtomicSet(&mixer->busy[slot], 0);
+				return -1;
+			}
+
+			mixer->nextVoice = (slot + 1) % MIXER_MAX_VOICES;
+
+			return slot | ((int)mixer->generations[slot] << 16);
+		}
+	}
+
+	return -1;
+}
+
+/*UPDATE voice GAINS (NO-OP IF IT ALREADY ENDED)*/
+void setVoiceGain(Mixer* mixer, VoiceHandle voice, float gainL, float gainR)
+{
+	if(voicePlaying(mixer, voice))
+		sendMixerCommand(mixer, (MixerCommand){MIXER_GAIN, voice & 0xFFFF, (Uint16)((voice >> 16) & MIXER_GENERATION_MASK), NULL, gainL, gainR, false});
+}
+
+/*STOP voice AND FREE ITS SLOT (NO-OP IF IT ALREADY ENDED)*/
+void stopVoice(Mixer* mixer, VoiceHandle voice)
+{
+	if(voicePlaying(mixer, voice))
+		sendMixerCommand(mixer, (MixerCommand){MIXER_STOP, voice & 0xFFFF, (Uint16)((voice >> 16) & MIXER_GENERATION_MASK), NULL, 0, 0, false});
+}
+
+/*TRUE WHILE voice HAS NOT ENDED NOR BEEN REUSED*/
+bool voicePlaying(Mixer* mixer, VoiceHandle voice)
+{
+	int slot = voice & 0xFFFF;
+
+	return voice >= 0 && mixer->ready && slot < MIXER_MAX_VOICES && mixer->generations[slot] == ((voice >> 16) & MIXER_GENERATION_MASK) &&
+		SDL_AtomicGet(&mixer->busy[slot]) != 0;
+}
+
+/*QUEUE A WHOLE COMMAND FOR THE AUDIO THREAD, FALSE IF THE QUEUE IS FULL*/
+bool sendMixerCommand(Mixer* mixer, MixerCommand command)
+{
+	if(ringBufferSpace(&mixer->commands) < sizeof(MixerCommand))
+		return false;
+
+	ringBufferWrite(&mixer->commands, &command, sizeof(MixerCommand));
+
+	return true;
+}
+
+/*GAINS FOR A SOUND AT WORLD POINT (x, y): PANNED BY ITS SIDE OF THE camera CENTER, FADING OUT LINEARLY WITH DISTANCE*/
+void spatialGains(int x, int y, SDL_Rect* camera, float* gainL, float* gainR)
+{
+	float dx = (float)(x - (camera->x + camera->w / 2));
+	float dy = (float)(y - (camera->y + camera->h / 2));
+	float gain = 1.0f - sqrtf(dx * dx + dy * dy) / MIXER_FALLOFF_DISTANCE;
+	float pan = SDL_min(SDL_max(dx / (camera->w / 2 + 1), -1.0f), 1.0f);
+
+	gain = SDL_max(gain, 0.0f);
+
+	//equal power pan
+	*gainL = gain * cosf((pan + 1.0f) * (float)M_PI / 4.0f);
+	*gainR = gain * sinf((pan + 1.0f) * (float)M_PI / 4.0f);
+}
+
+/*SDL_mixer POST MIX HOOK (AUDIO THREAD): APPLY QUEUED COMMANDS, MIX EVERY ACTIVE VOICE AND ADD THE RESULT TO stream*/
+void SDLCALL mixerCallback(void* data, Uint8* stream, int len)
+{
+	Mixer *mixer = (Mixer*)data;
+	Uint64 start = SDL_GetPerformanceCounter();
+	int frameSize = mixer->channels * (SDL_AUDIO_BITSIZE(mixer->format) / 8);
+	int frames = len / frameSize, done, n, i, active = 0;
+
+	if(!mixer->ready)
+		return;
+
+	applyMixerCommands(mixer);
+
+	for(done = 0; done < frames; done += n)
+	{
+		n = SDL_min(frames - done, MIXER_CHUNK_FRAMES);
+		SDL_memset(mixer->mix, 0, n * 2 * sizeof(float));
+		active = 0;
+
+		for(i = 0; i < MIXER_MAX_VOICES; i++)
+		{
+			if(mixer->voices[i].sound == NULL)
+				continue;
+
+			active++;
+			if(!mixVoice(&mixer->voices[i], mixer->mix, n)){
+				mixer->voices[i].sound = NULL;
+				SDL_AtomicSet(&mixer->busy[i], 0);
+			}
+		}
+
+		if(active == 0)
+			continue;
+
+		if(mixer->channels == 1){ //fold to mono in place
+			for(i = 0; i < n; i++)
+				mixer->mix[i] = (mixer->mix[i * 2] + mixer->mix[i * 2 + 1]) * 0.5f;
+		}
+
+		if(mixer->format == AUDIO_S16SYS)
+			writeMixS16(mixer->mix, (Sint16*)(stream + done * frameSize), n * mixer->channels);
+		else
+			writeMixF32(mixer->mix, (float*)(stream + done * frameSize), n * mixer->channels);
+	}
+
+	SDL_AtomicSet(&mixer->activeVoices, active);
+	SDL_AtomicSet(&mixer->callbackUs, (int)((SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency()));
+}
+
+/*AUDIO THREAD: APPLY EVERYTHING THE GAME THREAD QUEUED SINCE THE LAST CALLBACK*/
+void applyMixerCommands(Mixer* mixer)
+{
+	MixerCommand command;
+	Voice *voice;
+
+	while(ringBufferAvailable(&mixer->commands) >= sizeof(MixerCommand))
+	{
+		ringBufferRead(&mixer->commands, &command, sizeof(MixerCommand));
+		voice = &mixer->voices[command.voice];
+
+		switch(command.type){
+		case MIXER_PLAY:
+			*voice = (Voice){command.sound, 0, command.gainL, command.gainR, command.loop, command.generation};
+			break;
+		case MIXER_GAIN:
+			if(voice->sound != NULL && voice->generation == command.generation){
+				voice->gainL = command.gainL;
+				voice->gainR = command.gainR;
+			}
+			break;
+		case MIXER_STOP:
+			if(voice->sound != NULL && voice->generation == command.generation){
+				voice->sound = NULL;
+				SDL_AtomicSet(&mixer->busy[command.voice], 0);
+			}
+			break;
+		}
+	}
+}
+
+/*ADD frames OF voice INTO mix (WRAPPING IF LOOPED), FALSE ONCE THE VOICE ENDED*/
+bool mixVoice(Voice* voice, float* mix, int frames)
+{
+	int n;
+
+	while(frames > 0)
+	{
+		n = (int)SDL_min((Uint32)frames, voice->sound->frames - voice->position);
+
+		mixKernel(mix, voice->sound->samples + voice->position * 2, n, voice->gainL, voice->gainR);
+		voice->position += n;
+		mix += n * 2;
+		frames -= n;
+
+		if(voice->position == voice->sound->frames){
+			if(!voice->loop)
+				return false;
+			voice->position = 0;
+		}
+	}
+
+	return true;
+}
+
+/*mix += samples * (gainL, gainR) OVER frames STEREO FRAMES (TWO FRAMES PER SSE OP)*/
+void mixKernel(float* mix, const float* samples, int frames, float gainL, float gainR)
+{
+	int i = 0, n = frames * 2;
+
+#ifdef MIXER_SSE2
+	__m128 gains = _mm_setr_ps(gainL, gainR, gainL, gainR);
+
+	for(; i + 4 <= n; i += 4)
+		_mm_storeu_ps(mix + i, _mm_add_ps(_mm_loadu_ps(mix + i), _mm_mul_ps(_mm_loadu_ps(samples + i), gains)));
+#endif
+
+	for(; i < n; i += 2){
+		mix[i] += samples[i] * gainL;
+		mix[i + 1] += samples[i + 1] * gainR;
+	}
+}
+
+/*ADD n MIXED SAMPLES TO A SIGNED 16 BIT STREAM, SATURATING*/
+void writeMixS16(const float* mix, Sint16* out, int n)
+{
+	int i = 0;
+	float sample;
+
+#ifdef MIXER_SSE2
+	const __m128 scale = _mm_set1_ps(32768.0f), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+	__m128i s, s0, s1;
+	__m128 f0, f1;
+
+	for(; i + 8 <= n; i += 8){
+		s = _mm_loadu_si128((const __m128i*)(out + i));
+		s0 = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16); //sign extend
+		s1 = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+		f0 = _mm_add_ps(_mm_cvtepi32_ps(s0), _mm_mul_ps(_mm_loadu_ps(mix + i), scale));
+		f1 = _mm_add_ps(_mm_cvtepi32_ps(s1), _mm_mul_ps(_mm_loadu_ps(mix + i + 4), scale));
+		f0 = _mm_min_ps(_mm_max_ps(f0, lo), hi);
+		f1 = _mm_min_ps(_mm_max_ps(f1, lo), hi);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(f0), _mm_cvtps_epi32(f1)));
+	}
+#endif
+
+	for(; i < n; i++){
+		sample = out[i] + mix[i] * 32768.0f;
+		out[i] = (Sint16)SDL_min(SDL_max(sample, -32768.0f), 32767.0f);
+	}
+}
+
+/*ADD n MIXED SAMPLES TO A FLOAT STREAM (THE DEVICE CONVERSION CLIPS)*/
+void writeMixF32(const float* mix, float* out, int n)
+{
+	int i = 0;
+
+#ifdef MIXER_SSE2
+	for(; i + 4 <= n; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(mix + i)));
+#endif
+
+	for(; i < n; i++)
+		out[i] += mix[i];
+}
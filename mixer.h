@@ -0,0 +1,76 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_mixer.h"
+#include "ringbuffer.h"
+
+#define MIXER_MAX_VOICES 512
+#define MIXER_CHUNK_FRAMES 1024       //frames mixed per pass into the float accumulator
+#define MIXER_MAX_COMMANDS 4096       //commands queued between the game and audio threads (a few frames of per voice gain updates)
+#define MIXER_FALLOFF_DISTANCE 1200.0f //world pixels from the camera center where a voice fades out
+#define MIXER_GENERATION_MASK 0x7FFF  //slot generations wrap within 15 bits so handles never reach the sign bit
+
+//sound effect decoded once to interleaved stereo float at the mixer rate
+typedef struct{
+	float *samples;
+	Uint32 frames;
+} Sound;
+
+typedef struct{
+	const Sound *sound; //NULL: free
+	Uint32 position;    //next frame to mix
+	float gainL, gainR;
+	bool loop;
+	Uint16 generation;
+} Voice;
+
+typedef enum
+{
+	MIXER_PLAY,
+	MIXER_GAIN,
+	MIXER_STOP
+} MixerCommandEnum;
+
+typedef struct{
+	MixerCommandEnum type;
+	int voice;
+	Uint16 generation;
+	const Sound *sound;
+	float gainL, gainR;
+	bool loop;
+} MixerCommand;
+
+//voice slot in the low 16 bits, slot generation (15 bits) above, -1 when no voice was started
+typedef int VoiceHandle;
+
+//software mixer run from SDL_mixer's post mix hook: the game thread only queues commands,
+//the audio thread owns the voices and mixes them in float before adding them to the output
+typedef struct{
+	Voice voices[MIXER_MAX_VOICES];           //audio thread only
+	SDL_atomic_t busy[MIXER_MAX_VOICES];      //set by the game thread on play, cleared by the audio thread when the voice ends
+	Uint16 generations[MIXER_MAX_VOICES];     //game thread only
+	int nextVoice;                            //game thread free slot search start
+	RingBuffer commands;                      //game thread -> audio thread
+	float mix[MIXER_CHUNK_FRAMES * 2];
+	int freq;
+	int channels;
+	SDL_AudioFormat format;
+	SDL_atomic_t activeVoices;                //voices mixed by the last callback
+	SDL_atomic_t callbackUs;                  //cost of the last callback
+	bool ready;
+} Mixer;
+
+bool initMixer(Mixer* mixer, int freq, SDL_AudioFormat format, int channels);
+void closeMixer(Mixer* mixer);
+bool loadSound(Mixer* mixer, Sound* sound, const char* path);
+void freeSound(Sound* sound);
+VoiceHandle playSound(Mixer* mixer, const Sound* sound, float gainL, float gainR, bool loop);
+void setVoiceGain(Mixer* mixer, VoiceHandle voice, float gainL, float gainR);
+void stopVoice(Mixer* mixer, VoiceHandle voice);
+bool voicePlaying(Mixer* mixer, VoiceHandle voice);
+void spatialGains(int x, int y, SDL_Rect* camera, float* gainL, float* gainR);
+void SDLCALL mixerCallback(void* data, Uint8* stream, int len);
+
+#endif
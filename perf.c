@@ -0,0 +1,242 @@
+#include <math.h>
+#include "perf.h"
+
+PerfStats perf;
+SDL_malloc_func perfRealMalloc = NULL;
+SDL_calloc_func perfRealCalloc = NULL;
+SDL_realloc_func perfRealRealloc = NULL;
+SDL_free_func perfRealFree = NULL;
+
+void* SDLCALL perfMalloc(size_t size);
+void* SDLCALL perfCalloc(size_t count, size_t size);
+void* SDLCALL perfRealloc(void* memory, size_t size);
+void SDLCALL perfFree(void* memory);
+
+/*CLOSE PREVIOUS FRAME SAMPLE INTO stats ROLLING WINDOW (EVICTING SAMPLES OLDER THAN PERF_WINDOW_MS) AND START TIMING A NEW FRAME*/
+void perfFrameTick(PerfStats* stats)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint32 ticks = SDL_GetTicks();
+	int allocations = SDL_GetNumAllocations();
+	int i, frameAllocations;
+
+	if(stats->frameStart != 0)
+	{
+		//evict oldest samples out of window or history capacity
+		while(stats->count > 0)
+		{
+			i = (stats->head - stats->count + PERF_HISTORY_SIZE) % PERF_HISTORY_SIZE;
+
+			if(stats->count < PERF_HISTORY_SIZE && ticks - stats->frameTicks[i] <= PERF_WINDOW_MS)
+				break;
+
+			stats->histogram[perfHistogramBucket(stats->frameMs[i])]--;
+			stats->totalMs -= stats->frameMs[i];
+			stats->totalDrawCalls -= stats->frameDrawCalls[i];
+			stats->totalUploads -= stats->frameUploads[i];
+			stats->totalAllocations -= stats->frameAllocations[i];
+			stats->totalAllocatedBytes -= stats->frameAllocatedBytes[i];
+			stats->count--;
+		}
+
+		i = stats->head;
+		stats->frameMs[i] = (float)((double)(now - stats->frameStart) * 1000.0 / SDL_GetPerformanceFrequency());
+		stats->frameTicks[i] = ticks;
+		stats->frameDrawCalls[i] = stats->drawCalls;
+		stats->frameUploads[i] = stats->textureUploads;
+		//hooks count every allocation, otherwise only the growth of live allocations is visible
+		frameAllocations = stats->allocHooks ? stats->allocations : allocations - stats->allocationsAtFrameStart;
+		stats->frameAllocations[i] = frameAllocations > 0 ? frameAllocations : 0; //frees may outnumber allocations
+		stats->frameAllocatedBytes[i] = (Uint32)stats->allocatedBytes;
+
+		stats->histogram[perfHistogramBucket(stats->frameMs[i])]++;
+		stats->totalMs += stats->frameMs[i];
+		stats->totalDrawCalls += stats->frameDrawCalls[i];
+		stats->totalUploads += stats->frameUploads[i];
+		stats->totalAllocations += stats->frameAllocations[i];
+		stats->totalAllocatedBytes += stats->frameAllocatedBytes[i];
+
+		if(stats->allocCheck && stats->frameNumber > PERF_STEADY_STATE_FRAMES && stats->frameAllocations[i] > 0)
+			perfReportFrameAllocations(stats, stderr);
+
+		stats->head = (stats->head + 1) % PERF_HISTORY_SIZE;
+		stats->count++;
+	}
+
+	stats->frameStart = now;
+	stats->frameNumber++;
+	stats->allocationsAtFrameStart = allocations;
+	stats->drawCalls = 0;
+	stats->textureUploads = 0;
+
+	stats->allocations = 0;
+	stats->allocatedBytes = 0;
+	for(i = 0; i < stats->nAllocSites; i++){
+		stats->allocSites[i].frameCount = 0;
+		stats->allocSites[i].frameBytes = 0;
+	}
+}
+
+/*GET HISTOGRAM BUCKET FOR A FRAME TIME (LAST BUCKET HOLDS EVERYTHING ABOVE RANGE)*/
+int perfHistogramBucket(float frameMs)
+{
+	int bucket = (int)(frameMs / PERF_HISTOGRAM_BUCKET_MS);
+
+	if(bucket < 0)
+		return 0;
+
+	return bucket < PERF_HISTOGRAM_BUCKETS ? bucket : PERF_HISTOGRAM_BUCKETS - 1;
+}
+
+/*GET FRAME TIME (MS) AT PERCENTILE p (0..1) OF stats WINDOW, WITH HISTOGRAM BUCKET RESOLUTION*/
+float perfPercentile(PerfStats* stats, float p)
+{
+	int i, seen = 0, target = (int)ceilf(p * stats->count);
+
+	if(stats->count == 0)
+		return 0;
+
+	if(target < 1)
+		target = 1;
+
+	for(i = 0; i < PERF_HISTOGRAM_BUCKETS; i++){
+		seen += stats->histogram[i];
+		if(seen >= target)
+			return (i + 1) * PERF_HISTOGRAM_BUCKET_MS;
+	}
+
+	return PERF_HISTOGRAM_BUCKETS * PERF_HISTOGRAM_BUCKET_MS;
+}
+
+/*PRINT ONE LINE SUMMARY OF stats WINDOW (FPS, PERCENTILES, FRAMES OVER PERF_FRAME_BUDGET_MS, PER FRAME COUNTERS) TO out*/
+void perfPrintSummary(PerfStats* stats, FILE* out)
+{
+	int i, n, overBudget = 0;
+
+	for(n = 0; n < stats->count; n++){
+		i = (stats->head - 1 - n + PERF_HISTORY_SIZE) % PERF_HISTORY_SIZE;
+		if(stats->frameMs[i] > PERF_FRAME_BUDGET_MS)
+			overBudget++;
+	}
+
+	n = stats->count > 0 ? stats->count : 1;
+
+	fprintf(out, "frames=%d fps=%.1f p50=%.1fms p95=%.1fms p99=%.1fms max=%.1fms over_budget=%.1f%% draws/f=%.1f uploads/f=%.2f allocs/f=%.2f alloc_bytes/f=%.0f\n",
+		stats->count, stats->totalMs > 0 ? stats->count * 1000.0 / stats->totalMs : 0.0,
+		perfPercentile(stats, 0.50f), perfPercentile(stats, 0.95f), perfPercentile(stats, 0.99f), perfPercentile(stats, 1.0f),
+		overBudget * 100.0 / n, (double)stats->totalDrawCalls / n, (double)stats->totalUploads / n, (double)stats->totalAllocations / n, stats->totalAllocatedBytes / n);
+	fflush(out);
+}
+
+/*ROUTE SDL_malloc & CO THROUGH COUNTING HOOKS (CALL BEFORE ANY SDL ALLOCATION, I.E. BEFORE SDL_Init)*/
+bool perfInstallAllocHooks()
+{
+	SDL_GetMemoryFunctions(&perfRealMalloc, &perfRealCalloc, &perfRealRealloc, &perfRealFree);
+
+	if(SDL_SetMemoryFunctions(perfMalloc, perfCalloc, perfRealloc, perfFree) != 0)
+		return false;
+
+	perf.frameThread = SDL_ThreadID();
+	perf.allocHooks = true;
+
+	return true;
+}
+
+/*COUNT ALLOCATIONS OF thread AS THE FRAME'S FROM NOW ON (CALL WHILE IT IS NOT RUNNING FRAMES), ANY OTHER THREAD'S ARE ONLY COUNTED*/
+void perfSetFrameThread(SDL_threadID thread)
+{
+	perf.frameThread = thread;
+}
+
+/*TAG FOLLOWING FRAME THREAD ALLOCATIONS WITH site (STRING LITERAL), RETURN PREVIOUS TAG TO RESTORE IT AFTERWARDS*/
+const char* perfAllocSite(const char* site)
+{
+	const char *previous = perf.allocSite;
+
+	perf.allocSite = site;
+
+	return previous;
+}
+
+/*ADD ONE ALLOCATION OF size BYTES TO THE CURRENT FRAME AND TO THE CURRENT SITE (OTHER THREADS ARE ONLY COUNTED)*/
+void perfCountAllocation(size_t size)
+{
+	const char *name = perf.allocSite != NULL ? perf.allocSite : PERF_UNTAGGED_SITE;
+	PerfAllocSite *site;
+	int i;
+
+	if(SDL_ThreadID() != perf.frameThread){
+		SDL_AtomicAdd(&perf.otherThreadAllocations, 1);
+		return;
+	}
+
+	perf.allocations++;
+	perf.allocatedBytes += size;
+
+	for(i = 0; i < perf.nAllocSites; i++){
+		if(perf.allocSites[i].name == name || SDL_strcmp(perf.allocSites[i].name, name) == 0)
+			break;
+	}
+
+	if(i == perf.nAllocSites){
+		if(perf.nAllocSites < PERF_MAX_ALLOC_SITES)
+			perf.allocSites[perf.nAllocSites++].name = name;
+		else
+			i = PERF_MAX_ALLOC_SITES - 1; //table full, last site collects the rest
+	}
+
+	site = &perf.allocSites[i];
+	site->frameCount++;
+	site->frameBytes += size;
+	site->totalCount++;
+	site->totalBytes += size;
+}
+
+void* SDLCALL perfMalloc(size_t size)
+{
+	perfCountAllocation(size);
+	return perfRealMalloc(size);
+}
+
+void* SDLCALL perfCalloc(size_t count, size_t size)
+{
+	perfCountAllocation(count * size);
+	return perfRealCalloc(count, size);
+}
+
+void* SDLCALL perfRealloc(void* memory, size_t size)
+{
+	perfCountAllocation(size);
+	return perfRealRealloc(memory, size);
+}
+
+void SDLCALL perfFree(void* memory)
+{
+	perfRealFree(memory);
+}
+
+/*PRINT THE CURRENT FRAME'S ALLOCATIONS PER SITE TO out (STEADY STATE FRAMES SHOULD HAVE NONE)*/
+void perfReportFrameAllocations(PerfStats* stats, FILE* out)
+{
+	int i;
+
+	fprintf(out, "[alloc] frame %d: %d allocations, %u bytes:", stats->frameNumber, stats->allocations, (unsigned)stats->allocatedBytes);
+
+	for(i = 0; i < stats->nAllocSites; i++){
+		if(stats->allocSites[i].frameCount > 0)
+			fprintf(out, " %s x%d (%u B)", stats->allocSites[i].name, stats->allocSites[i].frameCount, (unsigned)stats->allocSites[i].frameBytes);
+	}
+
+	fprintf(out, "\n");
+}
+
+/*PRINT ALLOCATION TOTALS PER SITE SINCE HOOKS WERE INSTALLED TO out*/
+void perfPrintAllocSites(PerfStats* stats, FILE* out)
+{
+	int i;
+
+	for(i = 0; i < stats->nAllocSites; i++)
+		fprintf(out, "[alloc] %-24s %8d allocations %12lu bytes\n", stats->allocSites[i].name, stats->allocSites[i].totalCount, (unsigned long)stats->allocSites[i].totalBytes);
+
+	fprintf(out, "[alloc] other threads: %d allocations\n", SDL_AtomicGet(&stats->otherThreadAllocations));
+}
@@ -0,0 +1,66 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+
+#define PERF_WINDOW_MS 5000
+#define PERF_HISTORY_SIZE 2048
+#define PERF_HISTOGRAM_BUCKETS 1000
+#define PERF_HISTOGRAM_BUCKET_MS 0.1f
+#define PERF_FRAME_BUDGET_MS (1000.0f / 60)
+#define PERF_MAX_ALLOC_SITES 32
+#define PERF_STEADY_STATE_FRAMES 120
+#define PERF_UNTAGGED_SITE "untagged"
+
+typedef struct{
+	const char *name;
+	int frameCount, totalCount;
+	size_t frameBytes, totalBytes;
+} PerfAllocSite;
+
+typedef struct{
+	float frameMs[PERF_HISTORY_SIZE];
+	Uint32 frameTicks[PERF_HISTORY_SIZE];
+	int frameDrawCalls[PERF_HISTORY_SIZE];
+	int frameUploads[PERF_HISTORY_SIZE];
+	int frameAllocations[PERF_HISTORY_SIZE];
+	Uint32 frameAllocatedBytes[PERF_HISTORY_SIZE];
+	int histogram[PERF_HISTOGRAM_BUCKETS];
+	int head, count;
+	double totalMs;
+	int totalDrawCalls, totalUploads, totalAllocations;
+	double totalAllocatedBytes;
+	Uint64 frameStart;
+	int frameNumber;
+	int allocationsAtFrameStart;
+	int drawCalls, textureUploads;
+
+	//allocation hooks (perfInstallAllocHooks), frame thread only
+	bool allocHooks;
+	bool allocCheck; //report every allocating frame after PERF_STEADY_STATE_FRAMES
+	SDL_threadID frameThread; //the one calling perfFrameTick, main thread unless perfSetFrameThread moved it
+	const char *allocSite;
+	int allocations;
+	size_t allocatedBytes;
+	PerfAllocSite allocSites[PERF_MAX_ALLOC_SITES];
+	int nAllocSites;
+	SDL_atomic_t otherThreadAllocations;
+} PerfStats;
+
+void perfFrameTick(PerfStats* stats);
+int perfHistogramBucket(float frameMs);
+float perfPercentile(PerfStats* stats, float p);
+void perfPrintSummary(PerfStats* stats, FILE* out);
+
+bool perfInstallAllocHooks();
+void perfSetFrameThread(SDL_threadID thread);
+const char* perfAllocSite(const char* site);
+void perfCountAllocation(size_t size);
+void perfReportFrameAllocations(PerfStats* stats, FILE* out);
+void perfPrintAllocSites(PerfStats* stats, FILE* out);
+
+extern PerfStats perf;
+
+#endif
@@ -0,0 +1,129 @@
+#include "pixelcache.h"
+#include "engine.h"
+
+bool readPixelCacheHeader(PixelCache* cache, Uint32* header32);
+
+/*HASH THE IMAGE AT imagePath AND MAP ITS CACHE FOR format IF ONE WAS WRITTEN FROM THE SAME BYTES, RETURN WHETHER IT WAS A HIT.
+ *ON A MISS cache STILL HOLDS THE KEY FOR writePixelCache*/
+bool openPixelCache(PixelCache* cache, const char* imagePath, Uint32 format)
+{
+	MappedFile image;
+	Uint32 header32[8];
+
+	SDL_zerop(cache);
+	cache->format = format;
+	SDL_snprintf(cache->path, sizeof(cache->path), "%s.%08X%s", imagePath, (unsigned)format, PIXEL_CACHE_SUFFIX);
+
+	if(!mapFile(&image, imagePath))
+		return false;
+
+	cache->imageHash = pixelCacheHash(image.data, image.size);
+	cache->imageSize = image.size;
+	unmapFile(&image);
+
+	if(!mapFile(&cache->file, cache->path))
+		return false;
+
+	if(!readPixelCacheHeader(cache, header32)){
+		unmapFile(&cache->file);
+		return false;
+	}
+
+	cache->surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)(cache->file.data + PIXEL_CACHE_HEADER_SIZE), (int)header32[3], (int)header32[4],
+		(int)header32[6], (int)header32[5], header32[2]);
+
+	if(cache->surface == NULL){
+		print_err("Could not wrap cached pixels");
+		unmapFile(&cache->file);
+		return false;
+	}
+
+	cache->hit = true;
+
+	return true;
+}
+
+/*WRITE surface (DECODED AFTER A MISS) AS THE CACHE FOR THE KEY openPixelCache COMPUTED, THROUGH A TEMPORARY FILE SO A
+ *CRASH NEVER LEAVES HALF A CACHE UNDER THE REAL NAME*/
+bool writePixelCache(PixelCache* cache, SDL_Surface* surface)
+{
+	Uint8 header[PIXEL_CACHE_HEADER_SIZE];
+	Uint32 values32[8] = {SDL_SwapLE32(PIXEL_CACHE_MAGIC), SDL_SwapLE32(PIXEL_CACHE_VERSION), SDL_SwapLE32(surface->format->format),
+		SDL_SwapLE32((Uint32)surface->w), SDL_SwapLE32((Uint32)surface->h), SDL_SwapLE32((Uint32)surface->pitch),
+		SDL_SwapLE32(surface->format->BitsPerPixel), 0};
+	Uint64 values64[2] = {SDL_SwapLE64(cache->imageHash), SDL_SwapLE64(cache->imageSize)};
+	size_t pixelBytes = (size_t)surface->pitch * surface->h;
+	char tmpPath[PIXEL_CACHE_PATH_SIZE + 4];
+	FILE *file;
+	bool written;
+
+	if(cache->imageSize == 0 || surface->format->palette != NULL) //image never mapped, or its palette would be lost
+		return false;
+
+	SDL_zero(header);
+	SDL_memcpy(header, values32, sizeof(values32));
+	SDL_memcpy(header + sizeof(values32), values64, sizeof(values64));
+	SDL_snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", cache->path);
+
+	file = fopen(tmpPath, "wb");
+	if(file == NULL){
+		SDL_SetError("Could not open %s", tmpPath);
+		print_err("Could not write pixel cache");
+		return false;
+	}
+
+	written = fwrite(header, 1, sizeof(header), file) == sizeof(header) && fwrite(surface->pixels, 1, pixelBytes, file) == pixelBytes;
+	written = fclose(file) == 0 && written;
+
+	remove(cache->path); //rename does not replace files on Windows
+	if(!written || rename(tmpPath, cache->path) != 0){
+		remove(tmpPath);
+		SDL_SetError("Could not write %s", cache->path);
+		print_err("Could not write pixel cache");
+		return false;
+	}
+
+	return true;
+}
+
+/*RELEASE A HIT'S SURFACE AND MAPPING, USE NO SURFACE FROM IT AFTERWARDS*/
+void closePixelCache(PixelCache* cache)
+{
+	SDL_FreeSurface(cache->surface);
+	cache->surface = NULL;
+	unmapFile(&cache->file);
+	cache->hit = false;
+}
+
+Uint64 pixelCacheHash(const Uint8* bytes, Uint64 size)
+{
+	Uint64 hash = 0xCBF29CE484222325ull, i;
+
+	for(i = 0; i < size; i++)
+		hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+
+	return hash;
+}
+
+/*CHECK THE MAPPED CACHE AGAINST THE KEY AND ITS OWN SIZE, header32 GETS THE HOST ORDER 32 BIT FIELDS*/
+bool readPixelCacheHeader(PixelCache* cache, Uint32* header32)
+{
+	Uint64 values64[2];
+	int i;
+
+	if(cache->file.size < PIXEL_CACHE_HEADER_SIZE)
+		return false;
+
+	SDL_memcpy(header32, cache->file.data, 8 * sizeof(Uint32));
+	SDL_memcpy(values64, cache->file.data + 8 * sizeof(Uint32), sizeof(values64));
+
+	for(i = 0; i < 8; i++)
+		header32[i] = SDL_SwapLE32(header32[i]);
+
+	//magic, version, format, w, h, pitch, bits per pixel
+	return header32[0] == PIXEL_CACHE_MAGIC && header32[1] == PIXEL_CACHE_VERSION &&
+		(cache->format == 0 || header32[2] == cache->format) &&
+		SDL_SwapLE64(values64[0]) == cache->imageHash && SDL_SwapLE64(values64[1]) == cache->imageSize &&
+		header32[3] > 0 && header32[4] > 0 && header32[6] > 8 && header32[5] >= header32[3] * (header32[6] / 8) &&
+		cache->file.size - PIXEL_CACHE_HEADER_SIZE >= (Uint64)header32[5] * header32[4];
+}
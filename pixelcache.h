@@ -0,0 +1,31 @@
+#ifndef PIXELCACHE_H
+#define PIXELCACHE_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "savefile.h"
+
+#define PIXEL_CACHE_PATH_SIZE 256
+#define PIXEL_CACHE_SUFFIX ".pix"      //after the image path and the target format in hex
+#define PIXEL_CACHE_MAGIC 0x43584950u  //"PIXC"
+#define PIXEL_CACHE_VERSION 1
+#define PIXEL_CACHE_HEADER_SIZE 64     //magic, version, format, w, h, pitch, bits per pixel, reserved, image hash, image size, then padding
+
+//decoded (and converted) pixels of an image kept next to it, keyed by the hash of the image file and the target format:
+//a hit maps the pixels straight into a surface for upload, a changed image no longer matches its cache and is decoded again
+typedef struct{
+	MappedFile file;        //cache file while a hit is in use
+	SDL_Surface *surface;   //hit: the mapped pixels, not copied
+	Uint32 format;          //0: whatever format the image decodes to
+	Uint64 imageHash;       //FNV-1a of the image file
+	Uint64 imageSize;
+	bool hit;
+	char path[PIXEL_CACHE_PATH_SIZE];
+} PixelCache;
+
+bool openPixelCache(PixelCache* cache, const char* imagePath, Uint32 format);
+bool writePixelCache(PixelCache* cache, SDL_Surface* surface);
+void closePixelCache(PixelCache* cache);
+Uint64 pixelCacheHash(const Uint8* bytes, Uint64 size);
+
+#endif
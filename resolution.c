@@ -0,0 +1,101 @@
+#include "resolution.h"
+#include "commandbuffer.h"
+#include "perf.h"
+
+void stepDynamicResolution(DynamicResolution* res, int percent);
+
+/*START res AT FULL RESOLUTION AIMING FOR budgetMs FRAMES (DISABLED, OR IF THE RENDERER CAN'T DRAW TO TEXTURES: ALWAYS FULL)*/
+void initDynamicResolution(DynamicResolution* res, float budgetMs, bool enabled)
+{
+	SDL_zerop(res);
+	res->percent = 100;
+	res->budgetMs = budgetMs;
+	res->averageMs = budgetMs;
+	res->backoff = 1;
+	res->enabled = enabled && SDL_RenderTargetSupported(renderer);
+}
+
+/*FEED THE LAST FRAME'S TIME, STEPPING THE SCENE RESOLUTION DOWN AFTER RESOLUTION_OVER_FRAMES SLOW FRAMES AND UP AFTER
+RESOLUTION_UNDER_FRAMES * backoff FRAMES ON BUDGET*/
+void updateDynamicResolution(DynamicResolution* res, float frameMs)
+{
+	if(!res->enabled)
+		return;
+
+	res->averageMs += (frameMs - res->averageMs) * RESOLUTION_SMOOTHING;
+
+	if(res->averageMs > res->budgetMs * RESOLUTION_OVER_RATIO)
+	{
+		res->underFrames = 0;
+		if(++res->overFrames < RESOLUTION_OVER_FRAMES || res->percent <= RESOLUTION_MIN_PERCENT)
+			return;
+
+		//the last step up didn't hold, wait longer before the next one
+		if(res->probing && res->backoff < RESOLUTION_MAX_BACKOFF)
+			res->backoff *= 2;
+
+		stepDynamicResolution(res, res->percent - RESOLUTION_STEP_PERCENT);
+		res->probing = false;
+	}
+	else if(res->averageMs <= res->budgetMs * RESOLUTION_UNDER_RATIO)
+	{
+		res->overFrames = 0;
+		res->underFrames++;
+
+		if(res->probing && res->underFrames >= RESOLUTION_UNDER_FRAMES){
+			res->probing = false;
+			res->backoff = 1;
+		}
+
+		if(res->percent < 100 && res->underFrames >= RESOLUTION_UNDER_FRAMES * res->backoff){
+			stepDynamicResolution(res, res->percent + RESOLUTION_STEP_PERCENT);
+			res->probing = true;
+		}
+	}
+	else
+	{
+		//in between: neither count carries over
+		res->overFrames = 0;
+		res->underFrames = 0;
+	}
+}
+
+/*DRAW WHAT FOLLOWS (THE SCENE, IN camera'S SCREEN SPACE) INTO THE SCALED TARGET, NOTHING TO DO AT FULL RESOLUTION*/
+void beginScaledScene(DynamicResolution* res, SDL_Rect* camera)
+{
+	if(res->percent < 100)
+		drawSetTarget(&res->target, camera->w, camera->h, res->percent / 100.0f); //full size, steps never reallocate it
+}
+
+/*BACK TO THE WINDOW, STRETCHING THE SCENE OVER IT*/
+void endScaledScene(DynamicResolution* res, SDL_Rect* camera)
+{
+	SDL_Rect scene;
+
+	if(res->percent >= 100)
+		return;
+
+	scene = (SDL_Rect){0, 0, (camera->w * res->percent + 99) / 100, (camera->h * res->percent + 99) / 100};
+
+	drawSetTarget(NULL, 0, 0, 1);
+	drawTexture(&res->target, &scene, (SDL_Rect){0, 0, camera->w, camera->h}, 0, NULL, SDL_FLIP_NONE);
+	perf.drawCalls++;
+}
+
+/*DESTROY THE TARGET (RENDERER THREAD)*/
+void freeDynamicResolution(DynamicResolution* res)
+{
+	if(res->target.texture != NULL)
+		SDL_DestroyTexture(res->target.texture);
+
+	SDL_zero(res->target);
+}
+
+/*MOVE TO percent, STARTING BOTH COUNTS AND THE AVERAGE OVER SO THE OLD RESOLUTION'S FRAMES DON'T DECIDE THE NEXT STEP*/
+void stepDynamicResolution(DynamicResolution* res, int percent)
+{
+	res->percent = SDL_clamp(percent, RESOLUTION_MIN_PERCENT, 100);
+	res->averageMs = res->budgetMs;
+	res->overFrames = 0;
+	res->underFrames = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "engine.h"
+
+#define RESOLUTION_MIN_PERCENT 50    //lowest scene resolution, percent of the window's
+#define RESOLUTION_STEP_PERCENT 10
+#define RESOLUTION_SMOOTHING 0.1f    //weight of the newest frame in the running average
+#define RESOLUTION_OVER_RATIO 1.2f   //average above budget * this is too slow
+#define RESOLUTION_UNDER_RATIO 1.05f //average at most budget * this keeps up (vsync holds frames right at the budget)
+#define RESOLUTION_OVER_FRAMES 10    //frames too slow in a row before stepping down
+#define RESOLUTION_UNDER_FRAMES 120  //frames keeping up in a row before trying a step up
+#define RESOLUTION_MAX_BACKOFF 8     //a step up that had to be taken back waits twice as long next time, up to this
+
+//scene drawn into an offscreen target whose size follows the frame times and stretched over the window. The camera
+//keeps the window's size, so gameplay and input coordinates never change, only how many pixels get filled.
+//Steps down fast when frames run late, up slowly and backs off if a step up doesn't hold (hysteresis)
+typedef struct{
+	bool enabled;
+	Texture target;      //renderer thread only
+	int percent;         //scene resolution, percent of the window's, 100 draws straight to the window
+	float budgetMs;      //target frame time
+	float averageMs;
+	int overFrames, underFrames;
+	int backoff;         //multiplier of RESOLUTION_UNDER_FRAMES before the next step up
+	bool probing;        //last change was a step up not confirmed yet
+} DynamicResolution;
+
+void initDynamicResolution(DynamicResolution* res, float budgetMs, bool enabled);
+void updateDynamicResolution(DynamicResolution* res, float frameMs);
+void beginScaledScene(DynamicResolution* res, SDL_Rect* camera);
+void endScaledScene(DynamicResolution* res, SDL_Rect* camera);
+void freeDynamicResolution(DynamicResolution* res);
+
+#endif
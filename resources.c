@@ -0,0 +1,349 @@
+#include "resources.h"
+
+void textureKey(char* key, const char* path, SDL_Color* colorKey, bool pixelstream);
+int findResource(ResourceManager* rm, ResourceEnum type, const char* key);
+Uint32 shareResource(ResourceManager* rm, int slot);
+int newResource(ResourceManager* rm, ResourceEnum type, const char* key);
+Uint32 resourceId(ResourceManager* rm, int slot);
+Resource* resolveResource(ResourceManager* rm, ResourceEnum type, Uint32 id);
+void releaseResource(ResourceManager* rm, ResourceEnum type, Uint32* id);
+void freeResource(Resource* resource);
+
+ResourceManager resources;
+
+/*NEW REFERENCE TO THE TEXTURE ALREADY LOADED FROM path WITH THE SAME COLOR KEY AND STREAMING, 0 IF THERE IS NONE*/
+TextureHandle findTexture(ResourceManager* rm, const char* path, SDL_Color* colorKey, bool pixelstream)
+{
+	char key[RESOURCE_KEY_SIZE];
+	int slot;
+
+	textureKey(key, path, colorKey, pixelstream);
+	slot = findResource(rm, RESOURCE_TEXTURE, key);
+
+	return (TextureHandle){slot >= 0 ? shareResource(rm, slot) : 0};
+}
+
+/*TAKE OVER texture (AND THE CPU pixels OF A PIXEL STREAMING ONE) AS A RESOURCE WITH ONE REFERENCE, SHARED BY LATER findTexture
+ *CALLS UNLESS path IS NULL (RENDERED TEXT AND OTHER ONE-OFFS)*/
+TextureHandle addTexture(ResourceManager* rm, const char* path, SDL_Color* colorKey, Texture texture, SDL_Surface* pixels)
+{
+	char key[RESOURCE_KEY_SIZE] = "";
+	Resource *resource;
+	Uint32 format = 0;
+	int slot;
+
+	if(path != NULL)
+		textureKey(key, path, colorKey, texture.pixelstream);
+
+	if(texture.texture == NULL || (slot = newResource(rm, RESOURCE_TEXTURE, key)) < 0){
+		SDL_DestroyTexture(texture.texture);
+		SDL_FreeSurface(pixels);
+		return (TextureHandle){0};
+	}
+
+	resource = &rm->slots[slot];
+	resource->texture = texture;
+	resource->pixels = pixels;
+
+	SDL_QueryTexture(texture.texture, &format, NULL, NULL, NULL);
+	resource->gpuBytes = (Uint64)texture.w * texture.h * (SDL_BYTESPERPIXEL(format) > 0 ? SDL_BYTESPERPIXEL(format) : 4);
+	resource->cpuBytes = pixels != NULL ? (Uint64)pixels->pitch * pixels->h : 0;
+
+	return (TextureHandle){resourceId(rm, slot)};
+}
+
+/*FIND OR LOAD A STATIC TEXTURE ON THIS THREAD*/
+TextureHandle loadTextureResource(ResourceManager* rm, const char* path, SDL_Color* colorKey)
+{
+	TextureHandle handle = findTexture(rm, path, colorKey, false);
+
+	if(handle.id != 0)
+		return handle;
+
+	return addTexture(rm, path, colorKey, loadTexture(path, colorKey), NULL);
+}
+
+/*FIND OR LOAD A PIXEL STREAMING TEXTURE ON THIS THREAD, KEEPING ITS PIXELS FOR getTexturePixels*/
+TextureHandle loadPixelTextureResource(ResourceManager* rm, const char* path)
+{
+	TextureHandle handle = findTexture(rm, path, NULL, true);
+	SDL_Surface *pixels;
+
+	if(handle.id != 0)
+		return handle;
+
+	pixels = loadPixelSurface(path);
+	if(pixels == NULL)
+		return handle;
+
+	return addTexture(rm, path, NULL, createPixelTexture(pixels, path), pixels);
+}
+
+FontHandle findFont(ResourceManager* rm, const char* path, int size)
+{
+	char key[RESOURCE_KEY_SIZE];
+	int slot;
+
+	SDL_snprintf(key, sizeof(key), "%s|%d", path, size);
+	slot = findResource(rm, RESOURCE_FONT, key);
+
+	return (FontHandle){slot >= 0 ? shareResource(rm, slot) : 0};
+}
+
+FontHandle addFont(ResourceManager* rm, const char* path, int size, TTF_Font* font)
+{
+	char key[RESOURCE_KEY_SIZE];
+	int slot;
+
+	SDL_snprintf(key, sizeof(key), "%s|%d", path, size);
+
+	if(font == NULL || (slot = newResource(rm, RESOURCE_FONT, key)) < 0){
+		TTF_CloseFont(font);
+		return (FontHandle){0};
+	}
+
+	rm->slots[slot].font = font;
+
+	return (FontHandle){resourceId(rm, slot)};
+}
+
+FontHandle loadFontResource(ResourceManager* rm, const char* path, int size)
+{
+	FontHandle handle = findFont(rm, path, size);
+	TTF_Font *font;
+
+	if(handle.id != 0)
+		return handle;
+
+	font = TTF_OpenFont(path, size);
+	if(font == NULL){
+		print_err("Could not open font");
+		return handle;
+	}
+
+	return addFont(rm, path, size, font);
+}
+
+SoundHandle findSound(ResourceManager* rm, const char* path)
+{
+	int slot = findResource(rm, RESOURCE_SOUND, path);
+
+	return (SoundHandle){slot >= 0 ? shareResource(rm, slot) : 0};
+}
+
+SoundHandle addSound(ResourceManager* rm, const char* path, Sound sound)
+{
+	int slot;
+
+	if(sound.samples == NULL || SDL_strlen(path) >= RESOURCE_KEY_SIZE || (slot = newResource(rm, RESOURCE_SOUND, path)) < 0){
+		freeSound(&sound);
+		return (SoundHandle){0};
+	}
+
+	rm->slots[slot].sound = sound;
+	rm->slots[slot].cpuBytes = (Uint64)sound.frames * 2 * sizeof(float);
+
+	return (SoundHandle){resourceId(rm, slot)};
+}
+
+Texture* getTexture(ResourceManager* rm, TextureHandle texture)
+{
+	Resource *resource = resolveResource(rm, RESOURCE_TEXTURE, texture.id);
+
+	return resource != NULL ? &resource->texture : NULL;
+}
+
+/*CPU PIXELS OF A PIXEL STREAMING TEXTURE AS FIRST LOADED (IN ITS FORMAT), NULL FOR OTHER TEXTURES*/
+SDL_Surface* getTexturePixels(ResourceManager* rm, TextureHandle texture)
+{
+	Resource *resource = resolveResource(rm, RESOURCE_TEXTURE, texture.id);
+
+	return resource != NULL ? resource->pixels : NULL;
+}
+
+TTF_Font* getFont(ResourceManager* rm, FontHandle font)
+{
+	Resource *resource = resolveResource(rm, RESOURCE_FONT, font.id);
+
+	return resource != NULL ? resource->font : NULL;
+}
+
+Sound* getSound(ResourceManager* rm, SoundHandle sound)
+{
+	Resource *resource = resolveResource(rm, RESOURCE_SOUND, sound.id);
+
+	return resource != NULL ? &resource->sound : NULL;
+}
+
+void releaseTexture(ResourceManager* rm, TextureHandle* texture)
+{
+	releaseResource(rm, RESOURCE_TEXTURE, &texture->id);
+}
+
+void releaseFont(ResourceManager* rm, FontHandle* font)
+{
+	releaseResource(rm, RESOURCE_FONT, &font->id);
+}
+
+void releaseSound(ResourceManager* rm, SoundHandle* sound)
+{
+	releaseResource(rm, RESOURCE_SOUND, &sound->id);
+}
+
+/*LIST LIVE RESOURCES WITH THEIR REFERENCES AND ESTIMATED GPU/CPU BYTES, THEN THE TOTALS*/
+void printResourceReport(ResourceManager* rm, FILE* out)
+{
+	const char *types[] = {"texture", "font", "sound"};
+	Uint64 gpuBytes = 0, cpuBytes = 0;
+	int i, live = 0;
+
+	for(i = 0; i < rm->nSlots; i++)
+	{
+		Resource *resource = &rm->slots[i];
+
+		if(resource->refs == 0)
+			continue;
+
+		fprintf(out, "[resources] %-36s %-7s refs %2d gpu %9.1fKB cpu %9.1fKB\n", resource->key[0] != '\0' ? resource->key : "(unshared)",
+			types[resource->type], resource->refs, resource->gpuBytes / 1024.0, resource->cpuBytes / 1024.0);
+
+		gpuBytes += resource->gpuBytes;
+		cpuBytes += resource->cpuBytes;
+		live++;
+	}
+
+	fprintf(out, "[resources] %d live: gpu %.1fKB cpu %.1fKB, %d loads shared\n", live, gpuBytes / 1024.0, cpuBytes / 1024.0, rm->shared);
+}
+
+/*FREE WHATEVER IS STILL REFERENCED, REPORTING IT AS LEAKED*/
+void closeResourceManager(ResourceManager* rm, FILE* out)
+{
+	int i;
+
+	for(i = 0; i < rm->nSlots; i++)
+	{
+		Resource *resource = &rm->slots[i];
+
+		if(resource->refs == 0)
+			continue;
+
+		fprintf(out, "[resources] leaked %s (%d refs)\n", resource->key[0] != '\0' ? resource->key : "(unshared)", resource->refs);
+		freeResource(resource);
+	}
+
+	SDL_zerop(rm);
+}
+
+void textureKey(char* key, const char* path, SDL_Color* colorKey, bool pixelstream)
+{
+	if(colorKey != NULL)
+		SDL_snprintf(key, RESOURCE_KEY_SIZE, "%s|%s|key%02X%02X%02X", path, pixelstream ? "stream" : "static", colorKey->r, colorKey->g, colorKey->b);
+	else
+		SDL_snprintf(key, RESOURCE_KEY_SIZE, "%s|%s", path, pixelstream ? "stream" : "static");
+}
+
+int findResource(ResourceManager* rm, ResourceEnum type, const char* key)
+{
+	int i;
+
+	if(key[0] == '\0')
+		return -1;
+
+	for(i = 0; i < rm->nSlots; i++)
+		if(rm->slots[i].refs > 0 && rm->slots[i].type == type && strcmp(rm->slots[i].key, key) == 0)
+			return i;
+
+	return -1;
+}
+
+Uint32 shareResource(ResourceManager* rm, int slot)
+{
+	rm->slots[slot].refs++;
+	rm->shared++;
+
+	return resourceId(rm, slot);
+}
+
+/*CLAIM A FREE SLOT (REUSED BEFORE NEW ONES) WITH ONE REFERENCE AND A NEW GENERATION, -1 WHEN ALL ARE TAKEN*/
+int newResource(ResourceManager* rm, ResourceEnum type, const char* key)
+{
+	Resource *resource;
+	Uint16 generation;
+	int slot;
+
+	for(slot = 0; slot < rm->nSlots && rm->slots[slot].refs > 0; slot++);
+
+	if(slot == RESOURCE_MAX){
+		SDL_SetError("More than %d resources", RESOURCE_MAX);
+		print_err("Could not add resource");
+		return -1;
+	}
+
+	if(slot == rm->nSlots)
+		rm->nSlots++;
+
+	resource = &rm->slots[slot];
+	generation = resource->generation + 1;
+	SDL_zerop(resource);
+	resource->type = type;
+	resource->refs = 1;
+	resource->generation = generation != 0 ? generation : 1; //id 0 stays "no resource"
+	SDL_strlcpy(resource->key, key, sizeof(resource->key));
+
+	return slot;
+}
+
+Uint32 resourceId(ResourceManager* rm, int slot)
+{
+	return (Uint32)slot | ((Uint32)rm->slots[slot].generation << 16);
+}
+
+Resource* resolveResource(ResourceManager* rm, ResourceEnum type, Uint32 id)
+{
+	Resource *resource;
+	int slot = (int)(id & 0xFFFF);
+
+	if(id == 0 || slot >= rm->nSlots)
+		return NULL;
+
+	resource = &rm->slots[slot];
+	if(resource->refs == 0 || resource->type != type || resource->generation != (Uint16)(id >> 16))
+		return NULL;
+
+	return resource;
+}
+
+/*DROP THE REFERENCE BEHIND *id (THEN 0), FREEING THE RESOURCE WITH ITS LAST ONE*/
+void releaseResource(ResourceManager* rm, ResourceEnum type, Uint32* id)
+{
+	Resource *resource = resolveResource(rm, type, *id);
+
+	*id = 0;
+
+	if(resource == NULL || --resource->refs > 0)
+		return;
+
+	freeResource(resource);
+}
+
+void freeResource(Resource* resource)
+{
+	switch(resource->type){
+	case RESOURCE_TEXTURE:
+		SDL_DestroyTexture(resource->texture.texture);
+		SDL_FreeSurface(resource->pixels);
+		break;
+	case RESOURCE_FONT:
+		TTF_CloseFont(resource->font);
+		break;
+	case RESOURCE_SOUND:
+		freeSound(&resource->sound);
+		break;
+	}
+
+	resource->refs = 0;
+	SDL_zero(resource->texture);
+	resource->pixels = NULL;
+	resource->font = NULL;
+	resource->key[0] = '\0';
+}
@@ -0,0 +1,62 @@
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_ttf.h"
+#include "engine.h"
+#include "mixer.h"
+
+#define RESOURCE_MAX 128
+#define RESOURCE_KEY_SIZE 160
+
+typedef enum
+{
+	RESOURCE_TEXTURE,
+	RESOURCE_FONT,
+	RESOURCE_SOUND
+} ResourceEnum;
+
+typedef struct{
+	ResourceEnum type;
+	char key[RESOURCE_KEY_SIZE];  //path and load parameters, empty: never shared
+	int refs;                     //0: free slot
+	Uint16 generation;
+	Texture texture;
+	SDL_Surface *pixels;          //CPU copy kept with pixel streaming textures
+	TTF_Font *font;
+	Sound sound;
+	Uint64 gpuBytes, cpuBytes;
+} Resource;
+
+//every texture, font and sound the game holds, loaded once per path and parameters and freed with its last reference.
+//slots never move, so pointers from getTexture etc. stay valid while a reference is held
+typedef struct{
+	Resource slots[RESOURCE_MAX];
+	int nSlots;                   //slots ever used
+	int shared;                   //loads served by an existing resource
+} ResourceManager;
+
+TextureHandle findTexture(ResourceManager* rm, const char* path, SDL_Color* colorKey, bool pixelstream);
+TextureHandle addTexture(ResourceManager* rm, const char* path, SDL_Color* colorKey, Texture texture, SDL_Surface* pixels);
+TextureHandle loadTextureResource(ResourceManager* rm, const char* path, SDL_Color* colorKey);
+TextureHandle loadPixelTextureResource(ResourceManager* rm, const char* path);
+FontHandle findFont(ResourceManager* rm, const char* path, int size);
+FontHandle addFont(ResourceManager* rm, const char* path, int size, TTF_Font* font);
+FontHandle loadFontResource(ResourceManager* rm, const char* path, int size);
+SoundHandle findSound(ResourceManager* rm, const char* path);
+SoundHandle addSound(ResourceManager* rm, const char* path, Sound sound);
+Texture* getTexture(ResourceManager* rm, TextureHandle texture);
+SDL_Surface* getTexturePixels(ResourceManager* rm, TextureHandle texture);
+TTF_Font* getFont(ResourceManager* rm, FontHandle font);
+Sound* getSound(ResourceManager* rm, SoundHandle sound);
+void releaseTexture(ResourceManager* rm, TextureHandle* texture);
+void releaseFont(ResourceManager* rm, FontHandle* font);
+void releaseSound(ResourceManager* rm, SoundHandle* sound);
+void printResourceReport(ResourceManager* rm, FILE* out);
+void closeResourceManager(ResourceManager* rm, FILE* out);
+
+extern ResourceManager resources;
+
+#endif
@@ -0,0 +1,103 @@
+#include "ringbuffer.h"
+
+/*ALLOCATE ring WITH ROOM FOR AT LEAST minCapacity BYTES (ROUNDED UP TO A POWER OF TWO)*/
+bool initRingBuffer(RingBuffer* ring, Uint32 minCapacity)
+{
+	Uint32 capacity = 1;
+
+	while(capacity < minCapacity && capacity < 0x80000000u)
+		capacity <<= 1;
+
+	ring->data = (Uint8*)SDL_malloc(capacity);
+	ring->capacity = ring->data != NULL ? capacity : 0;
+	resetRingBuffer(ring);
+	SDL_AtomicSet(&ring->overruns, 0);
+	SDL_AtomicSet(&ring->underruns, 0);
+
+	return ring->data != NULL;
+}
+
+void freeRingBuffer(RingBuffer* ring)
+{
+	SDL_free(ring->data);
+	ring->data = NULL;
+	ring->capacity = 0;
+}
+
+/*EMPTY ring (ONLY WHILE NEITHER SIDE IS RUNNING, E.G. WITH ITS AUDIO DEVICE PAUSED)*/
+void resetRingBuffer(RingBuffer* ring)
+{
+	SDL_AtomicSet(&ring->head, 0);
+	SDL_AtomicSet(&ring->tail, 0);
+	SDL_AtomicSet(&ring->finished, 0);
+}
+
+/*BYTES READY TO BE READ*/
+Uint32 ringBufferAvailable(RingBuffer* ring)
+{
+	return (Uint32)SDL_AtomicGet(&ring->head) - (Uint32)SDL_AtomicGet(&ring->tail);
+}
+
+/*BYTES THAT CAN BE WRITTEN WITHOUT OVERRUN*/
+Uint32 ringBufferSpace(RingBuffer* ring)
+{
+	return ring->capacity - ringBufferAvailable(ring);
+}
+
+/*PRODUCER: COPY UP TO len BYTES OF data INTO ring, RETURN BYTES WRITTEN (THE REST IS COUNTED AS OVERRUN)*/
+Uint32 ringBufferWrite(RingBuffer* ring, const void* data, Uint32 len)
+{
+	Uint32 head, space, n, offset, first;
+
+	if(ring->data == NULL)
+		return 0;
+
+	head = (Uint32)SDL_AtomicGet(&ring->head);
+	space = ring->capacity - (head - (Uint32)SDL_AtomicGet(&ring->tail));
+	n = len < space ? len : space;
+	offset = head & (ring->capacity - 1);
+	first = n < ring->capacity - offset ? n : ring->capacity - offset;
+
+	SDL_memcpy(ring->data + offset, data, first);
+	SDL_memcpy(ring->data, (const Uint8*)data + first, n - first);
+
+	SDL_MemoryBarrierRelease(); //bytes land before the consumer can see the new head
+	SDL_AtomicSet(&ring->head, (int)(head + n));
+
+	if(n < len)
+		SDL_AtomicAdd(&ring->overruns, (int)(len - n));
+
+	return n;
+}
+
+/*CONSUMER: COPY UP TO len BYTES FROM ring INTO data, RETURN BYTES READ (SHORT READS COUNT AS UNDERRUN UNLESS FINISHED)*/
+Uint32 ringBufferRead(RingBuffer* ring, void* data, Uint32 len)
+{
+	Uint32 tail, available, n, offset, first;
+
+	if(ring->data == NULL)
+		return 0;
+
+	tail = (Uint32)SDL_AtomicGet(&ring->tail);
+	available = (Uint32)SDL_AtomicGet(&ring->head) - tail;
+	n = len < available ? len : available;
+	offset = tail & (ring->capacity - 1);
+	first = n < ring->capacity - offset ? n : ring->capacity - offset;
+
+	SDL_MemoryBarrierAcquire(); //read bytes only after seeing the head that published them
+	SDL_memcpy(data, ring->data + offset, first);
+	SDL_memcpy((Uint8*)data + first, ring->data, n - first);
+
+	SDL_AtomicSet(&ring->tail, (int)(tail + n));
+
+	if(n < len && !SDL_AtomicGet(&ring->finished))
+		SDL_AtomicAdd(&ring->underruns, (int)(len - n));
+
+	return n;
+}
+
+/*PRODUCER: NO MORE DATA WILL BE WRITTEN UNTIL THE NEXT RESET*/
+void ringBufferFinish(RingBuffer* ring)
+{
+	SDL_AtomicSet(&ring->finished, 1);
+}
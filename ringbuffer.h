@@ -0,0 +1,28 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+
+//single producer/single consumer byte queue: one thread only writes, one thread only reads, no locks.
+//head and tail run freely and wrap through capacity (a power of two)
+typedef struct{
+	Uint8 *data;
+	Uint32 capacity;
+	SDL_atomic_t head;      //bytes written so far (producer)
+	SDL_atomic_t tail;      //bytes read so far (consumer)
+	SDL_atomic_t finished;  //producer wrote its last byte, short reads are not underruns
+	SDL_atomic_t overruns;  //bytes dropped on writes to a full buffer
+	SDL_atomic_t underruns; //bytes missing on reads from an empty buffer
+} RingBuffer;
+
+bool initRingBuffer(RingBuffer* ring, Uint32 minCapacity);
+void freeRingBuffer(RingBuffer* ring);
+void resetRingBuffer(RingBuffer* ring);
+Uint32 ringBufferAvailable(RingBuffer* ring);
+Uint32 ringBufferSpace(RingBuffer* ring);
+Uint32 ringBufferWrite(RingBuffer* ring, const void* data, Uint32 len);
+Uint32 ringBufferRead(RingBuffer* ring, void* data, Uint32 len);
+void ringBufferFinish(RingBuffer* ring);
+
+#endif
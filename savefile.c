@@ -0,0 +1,644 @@
+#include "savefile.h"
+#include "engine.h"
+#include "levelgen.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool readSaveIndexHeader(SaveFile* save, Uint64* lines, Uint64* textBytes, Uint32* flags, Uint64* framedFrom);
+bool indexSaveText(SaveFile* save, bool rewrite);
+bool writeSaveIndexHeader(SaveFile* save);
+bool savedLineFramed(SaveFile* save, Uint64 offset);
+int savedLineText(const Uint8* line, int len, bool framed, const Uint8** text);
+Uint32 saveCrc32(const Uint8* bytes, int len);
+int saveWriterThread(void* data);
+void drainSaveQueue(SaveFile* save);
+bool flushSaveBatch(SaveFile* save);
+bool syncSaveFiles(SaveFile* save);
+bool syncFile(FILE* file);
+Uint64 readLE64(const Uint8* bytes);
+Uint64 uniformRandom(Uint64* state, Uint64 bound);
+
+/*OPEN path FOR APPENDING AND MAP IT ALONG ITS LINE INDEX, INDEXING ONLY TEXT THE SIDECAR DOES NOT COVER YET (ALL OF IT IF MISSING OR CORRUPT),
+ *THEN START THE WRITER THREAD THAT APPENDS QUEUED LINES, SYNCING THEM TO DISK AS sync SAYS*/
+bool openSaveFile(SaveFile* save, const char* path, SaveSyncPolicy sync)
+{
+	Uint64 lines, textBytes, framedFrom;
+	Uint32 flags;
+	bool valid;
+
+	SDL_zerop(save);
+	SDL_snprintf(save->indexPath, sizeof(save->indexPath), "%s%s", path, SAVE_INDEX_SUFFIX);
+	save->sync = sync;
+
+	save->file = fopen(path, "ab"); //binary: offsets are byte exact on every platform
+	if(save->file == NULL)
+		SDL_SetError("Could not open %s", path);
+
+	if(save->file == NULL || !mapFile(&save->text, path)){
+		print_err("Could not open save file");
+		closeSaveFile(save);
+		return false;
+	}
+
+	valid = mapFile(&save->index, save->indexPath) && readSaveIndexHeader(save, &lines, &textBytes, &flags, &framedFrom);
+	unmapFile(&save->index); //remapped once up to date
+
+	save->indexedLines = valid ? lines : 0;
+	save->indexedBytes = valid ? textBytes : 0;
+	save->flags = valid ? flags : 0;
+	save->framedFrom = valid ? framedFrom : 0;
+
+	if((!valid || save->indexedBytes < save->text.size) && !indexSaveText(save, !valid)){
+		closeSaveFile(save);
+		return false;
+	}
+
+	if(save->tornLines > 0){
+		SDL_SetError("%d torn lines in %s", (int)save->tornLines, path);
+		print_err("Skipped save file lines from an interrupted write");
+	}
+
+	if(save->indexFile == NULL)
+		save->indexFile = fopen(save->indexPath, "r+b");
+
+	if(save->indexFile == NULL || !mapFile(&save->index, save->indexPath)){
+		print_err("Could not open save file index");
+		closeSaveFile(save);
+		return false;
+	}
+
+	save->mappedLines = SDL_min(save->indexedLines, (save->index.size - SAVE_INDEX_HEADER_SIZE) / sizeof(Uint64));
+	save->fileSize = save->text.size;
+	save->tornTail = save->indexedBytes < save->text.size;
+	save->lastSyncTicks = SDL_GetTicks();
+	SDL_AtomicSet(&save->stop, 0);
+	SDL_AtomicSet(&save->dropped, 0);
+
+	if(!initRingBuffer(&save->queue, SAVE_QUEUE_BYTES)){
+		closeSaveFile(save);
+		return false;
+	}
+
+	save->writer = SDL_CreateThread(saveWriterThread, "saveWriter", save);
+	if(save->writer == NULL){
+		print_err("Could not start save file writer thread");
+		closeSaveFile(save);
+		return false;
+	}
+
+	return true;
+}
+
+/*WRITE WHAT IS STILL QUEUED, JOIN THE WRITER THREAD AND CLOSE EVERYTHING, REPORTING LINES THAT NEVER MADE IT TO THE QUEUE*/
+void closeSaveFile(SaveFile* save)
+{
+	if(save->writer != NULL){
+		SDL_AtomicSet(&save->stop, 1);
+		SDL_WaitThread(save->writer, NULL);
+		save->writer = NULL;
+
+		if(SDL_AtomicGet(&save->dropped) > 0){
+			SDL_SetError("%d lines dropped", SDL_AtomicGet(&save->dropped));
+			print_err("Save file queue was full, lines were not saved");
+		}
+	}
+
+	if(save->file != NULL)
+		fclose(save->file);
+	if(save->indexFile != NULL)
+		fclose(save->indexFile);
+
+	freeRingBuffer(&save->queue);
+	unmapFile(&save->text);
+	unmapFile(&save->index);
+	save->file = save->indexFile = NULL;
+	save->mappedLines = save->indexedLines = save->indexedBytes = 0;
+}
+
+/*QUEUE line (len BYTES, NO DELIMITER, CUT TO SAVE_MAX_LINE) FOR THE WRITER THREAD, NEVER WAITING: FALSE IF IT HAD TO BE DROPPED*/
+bool appendSavedLine(SaveFile* save, const char* line, int len)
+{
+	Uint8 record[sizeof(Uint16) + SAVE_MAX_LINE];
+	Uint16 n = (Uint16)SDL_min(SDL_max(len, 0), SAVE_MAX_LINE);
+
+	if(save->writer == NULL)
+		return false;
+
+	if(ringBufferSpace(&save->queue) < sizeof(Uint16) + n){
+		if(SDL_AtomicAdd(&save->dropped, 1) == 0){ //once, closeSaveFile reports the total
+			SDL_SetError("Save queue full (%d bytes)", SAVE_QUEUE_BYTES);
+			print_err("Dropping save file lines, the writer thread fell behind");
+		}
+		return false;
+	}
+
+	//one write publishes length and line together
+	SDL_memcpy(record, &n, sizeof(Uint16));
+	SDL_memcpy(record + sizeof(Uint16), line, n);
+	ringBufferWrite(&save->queue, record, sizeof(Uint16) + n);
+
+	return true;
+}
+
+/*COPY UP TO k DISTINCT SAVED LINES, EACH SET OF k EQUALLY LIKELY AND IN RANDOM ORDER (FLOYD'S SAMPLING, O(k)), RETURN LINES COPIED*/
+int sampleSavedLines(SaveFile* save, char** lines, int k, int lineSize, Uint64* rngState)
+{
+	Uint64 picked[SAVE_MAX_SAMPLES], j, t, start, swap;
+	const Uint8 *line, *end, *text;
+	int i, m = 0, len;
+	bool taken;
+
+	k = (int)SDL_min((Uint64)SDL_min(k, SAVE_MAX_SAMPLES), save->mappedLines);
+
+	//for the last k indices take a random earlier one, or the index itself when already taken
+	for(j = save->mappedLines - k; j < save->mappedLines; j++)
+	{
+		t = uniformRandom(rngState, j + 1);
+		for(i = 0; i < m && picked[i] != t; i++);
+		taken = i < m;
+		picked[m++] = taken ? j : t;
+	}
+
+	//Floyd's picks are a uniform set but not in uniform order
+	for(i = k - 1; i > 0; i--){
+		t = uniformRandom(rngState, i + 1);
+		swap = picked[i];
+		picked[i] = picked[t];
+		picked[t] = swap;
+	}
+
+	for(i = 0; i < k; i++)
+	{
+		lines[i][0] = '\0';
+
+		start = readLE64(save->index.data + SAVE_INDEX_HEADER_SIZE + picked[i] * sizeof(Uint64));
+		if(start >= save->text.size)
+			continue;
+
+		line = save->text.data + start;
+		len = (int)SDL_min(save->text.size - start, (Uint64)(SAVE_FRAME_PREFIX + SAVE_MAX_LINE + 1));
+		end = (const Uint8*)memchr(line, SAVE_LINE_DELIMITER, len);
+		len = end != NULL ? (int)(end - line) : len;
+
+		//the index only holds good lines, framed ones are told apart by where framing started, not by how they look
+		len = savedLineText(line, len, savedLineFramed(save, start), &text);
+		if(len < 0)
+			continue;
+
+		len = utf8Fit((const char*)text, len, lineSize - 1); //cut between codepoints
+		if(len > 0 && text[len-1] == '\r') //saved in text mode on Windows
+			len--;
+
+		SDL_memcpy(lines[i], text, len);
+		lines[i][len] = '\0';
+	}
+
+	return k;
+}
+
+/*PARSE A SYNC POLICY: none, interval:MS OR lines:N*/
+bool parseSaveSyncPolicy(const char* text, SaveSyncPolicy* sync)
+{
+	if(strcmp(text, "none") == 0){
+		sync->mode = SAVE_SYNC_NONE;
+		sync->every = 0;
+		return true;
+	}
+
+	if(strncmp(text, "interval:", 9) == 0){
+		sync->mode = SAVE_SYNC_INTERVAL;
+		sync->every = (Uint32)SDL_max(SDL_atoi(text + 9), 0);
+		return sync->every > 0;
+	}
+
+	if(strncmp(text, "lines:", 6) == 0){
+		sync->mode = SAVE_SYNC_LINES;
+		sync->every = (Uint32)SDL_max(SDL_atoi(text + 6), 0);
+		return sync->every > 0;
+	}
+
+	return false;
+}
+
+/*MAP THE WHOLE FILE AT path READ ONLY, FALSE (SDL ERROR SET) IF IT CAN'T BE OPENED*/
+bool mapFile(MappedFile* mapped, const char* path)
+{
+	void *view = NULL;
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+#else
+	struct stat info;
+	int fd;
+#endif
+
+	mapped->data = NULL;
+	mapped->size = 0;
+
+#ifdef _WIN32
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE)
+		return SDL_SetError("Could not open %s", path) == 0;
+
+	if(!GetFileSizeEx(file, &size)){
+		CloseHandle(file);
+		return SDL_SetError("Could not size %s", path) == 0;
+	}
+
+	if(size.QuadPart > 0){
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping != NULL){
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); //the view keeps the mapping alive
+		}
+	}
+	CloseHandle(file);
+
+	if(size.QuadPart > 0 && view == NULL)
+		return SDL_SetError("Could not map %s", path) == 0;
+
+	mapped->size = (Uint64)size.QuadPart;
+#else
+	fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return SDL_SetError("Could not open %s", path) == 0;
+
+	if(fstat(fd, &info) != 0){
+		close(fd);
+		return SDL_SetError("Could not size %s", path) == 0;
+	}
+
+	if(info.st_size > 0){
+		view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(view == MAP_FAILED)
+			view = NULL;
+	}
+	close(fd); //the mapping outlives the descriptor
+
+	if(info.st_size > 0 && view == NULL)
+		return SDL_SetError("Could not map %s", path) == 0;
+
+	mapped->size = (Uint64)info.st_size;
+#endif
+
+	mapped->data = (const Uint8*)view;
+
+	return true;
+}
+
+void unmapFile(MappedFile* mapped)
+{
+	if(mapped->data != NULL){
+#ifdef _WIN32
+		UnmapViewOfFile(mapped->data);
+#else
+		munmap((void*)mapped->data, (size_t)mapped->size);
+#endif
+	}
+
+	mapped->data = NULL;
+	mapped->size = 0;
+}
+
+/*READ THE MAPPED SIDECAR HEADER, FALSE IF IT DOES NOT DESCRIBE A PREFIX OF THE MAPPED TEXT ENDING IN A GOOD LINE*/
+bool readSaveIndexHeader(SaveFile* save, Uint64* lines, Uint64* textBytes, Uint32* flags, Uint64* framedFrom)
+{
+	const Uint8 *header = save->index.data, *text;
+	Uint32 magic, version;
+	Uint64 last;
+
+	if(save->index.size < SAVE_INDEX_HEADER_SIZE)
+		return false;
+
+	SDL_memcpy(&magic, header, sizeof(Uint32));
+	SDL_memcpy(&version, header + 4, sizeof(Uint32));
+	SDL_memcpy(flags, header + 8, sizeof(Uint32));
+	*flags = SDL_SwapLE32(*flags);
+	*textBytes = readLE64(header + 16);
+	*lines = readLE64(header + 24);
+	*framedFrom = readLE64(header + 32);
+
+	if(SDL_SwapLE32(magic) != SAVE_INDEX_MAGIC || SDL_SwapLE32(version) != SAVE_INDEX_VERSION ||
+		*textBytes > save->text.size || *lines > (save->index.size - SAVE_INDEX_HEADER_SIZE) / sizeof(Uint64))
+		return false;
+
+	if(*lines == 0)
+		return true;
+
+	//an index written ahead of its text (crash before the text reached the disk) ends on a torn line
+	last = readLE64(header + SAVE_INDEX_HEADER_SIZE + (*lines - 1) * sizeof(Uint64));
+
+	return last < *textBytes && save->text.data[*textBytes - 1] == SAVE_LINE_DELIMITER &&
+		savedLineText(save->text.data + last, (int)SDL_min(*textBytes - 1 - last, (Uint64)SDL_MAX_SINT32),
+			(*flags & SAVE_INDEX_FRAMED) && last >= *framedFrom, &text) >= 0;
+}
+
+/*ADD THE START OF EVERY GOOD COMPLETE LINE PAST indexedBytes TO THE SIDECAR (A NEW ONE WHEN rewrite), COUNTING TORN ONES, LEAVING indexFile OPEN*/
+bool indexSaveText(SaveFile* save, bool rewrite)
+{
+	Uint64 offsets[SAVE_INDEX_WRITE_CHUNK];
+	const Uint8 *text = save->text.data, *p, *end, *next, *lineText;
+	int n = 0, len;
+
+	save->indexFile = fopen(save->indexPath, rewrite ? "w+b" : "r+b");
+	if(save->indexFile == NULL)
+		SDL_SetError("Could not open %s", save->indexPath);
+
+	if(save->indexFile == NULL || (rewrite && !writeSaveIndexHeader(save)) ||
+		fseek(save->indexFile, (long)(SAVE_INDEX_HEADER_SIZE + save->indexedLines * sizeof(Uint64)), SEEK_SET) != 0){
+		print_err("Could not index save file");
+		return false;
+	}
+
+	if(text == NULL)
+		return true;
+
+	//a trailing line without delimiter stays unindexed until it is completed
+	p = text + save->indexedBytes;
+	end = text + save->text.size;
+	while(p < end && (next = (const Uint8*)memchr(p, SAVE_LINE_DELIMITER, end - p)) != NULL)
+	{
+		len = (int)SDL_min((Uint64)(next - p), (Uint64)SDL_MAX_SINT32);
+
+		//no index said where framing started (missing sidecar): the first line with a good frame does
+		if(!(save->flags & SAVE_INDEX_FRAMED) && savedLineText(p, len, true, &lineText) >= 0){
+			save->flags |= SAVE_INDEX_FRAMED;
+			save->framedFrom = (Uint64)(p - text);
+		}
+
+		if(savedLineText(p, len, savedLineFramed(save, (Uint64)(p - text)), &lineText) < 0){
+			save->tornLines++;
+		}
+		else{
+			offsets[n++] = SDL_SwapLE64((Uint64)(p - text));
+			save->indexedLines++;
+		}
+
+		p = next + 1;
+
+		if(n == SAVE_INDEX_WRITE_CHUNK){
+			if(fwrite(offsets, sizeof(Uint64), n, save->indexFile) != (size_t)n){
+				print_err("Could not write save file index");
+				return false;
+			}
+			n = 0;
+		}
+	}
+
+	if(n > 0 && fwrite(offsets, sizeof(Uint64), n, save->indexFile) != (size_t)n){
+		print_err("Could not write save file index");
+		return false;
+	}
+
+	save->indexedBytes = (Uint64)(p - text);
+
+	return writeSaveIndexHeader(save) && fflush(save->indexFile) == 0;
+}
+
+bool writeSaveIndexHeader(SaveFile* save)
+{
+	Uint8 header[SAVE_INDEX_HEADER_SIZE];
+	Uint32 values32[4] = {SDL_SwapLE32(SAVE_INDEX_MAGIC), SDL_SwapLE32(SAVE_INDEX_VERSION), SDL_SwapLE32(save->flags), 0};
+	Uint64 values64[3] = {SDL_SwapLE64(save->indexedBytes), SDL_SwapLE64(save->indexedLines), SDL_SwapLE64(save->framedFrom)};
+
+	SDL_memcpy(header, values32, sizeof(values32));
+	SDL_memcpy(header + sizeof(values32), values64, sizeof(values64));
+
+	if(fseek(save->indexFile, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), save->indexFile) != sizeof(header)){
+		SDL_SetError("Could not write %s", save->indexPath);
+		print_err("Could not write save file index");
+		return false;
+	}
+
+	return true;
+}
+
+/*WHETHER THE LINE STARTING AT offset WAS WRITTEN FRAMED: AT OR PAST THE FIRST FRAMED LINE*/
+bool savedLineFramed(SaveFile* save, Uint64 offset)
+{
+	return (save->flags & SAVE_INDEX_FRAMED) && offset >= save->framedFrom;
+}
+
+/*TEXT OF A SAVED LINE OF len BYTES (NO DELIMITER): AFTER ITS FRAME WHEN framed, RETURNING -1 FOR A TORN LINE (NO FRAME OR A BAD CRC),
+ *THE WHOLE LINE OTHERWISE, EVEN IF IT HAPPENS TO START LIKE A FRAME*/
+int savedLineText(const Uint8* line, int len, bool framed, const Uint8** text)
+{
+	Uint32 crc = 0;
+	int i;
+
+	if(!framed){
+		*text = line;
+		return len;
+	}
+
+	for(i = 0; i < SAVE_FRAME_PREFIX - 1 && i < len; i++){
+		if(line[i] >= '0' && line[i] <= '9')
+			crc = (crc << 4) | (Uint32)(line[i] - '0');
+		else if(line[i] >= 'A' && line[i] <= 'F')
+			crc = (crc << 4) | (Uint32)(line[i] - 'A' + 10);
+		else
+			break;
+	}
+
+	if(i < SAVE_FRAME_PREFIX - 1 || len < SAVE_FRAME_PREFIX || line[i] != ' ' ||
+		crc != saveCrc32(line + SAVE_FRAME_PREFIX, len - SAVE_FRAME_PREFIX))
+		return -1;
+
+	*text = line + SAVE_FRAME_PREFIX;
+	return len - SAVE_FRAME_PREFIX;
+}
+
+/*CRC-32 (IEEE, BITWISE: LINES ARE SHORT)*/
+Uint32 saveCrc32(const Uint8* bytes, int len)
+{
+	Uint32 crc = 0xFFFFFFFFu;
+	int i, b;
+
+	for(i = 0; i < len; i++){
+		crc ^= bytes[i];
+		for(b = 0; b < 8; b++)
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+	}
+
+	return ~crc;
+}
+
+/*WRITER THREAD: APPEND QUEUED LINES IN BATCHES UNTIL STOPPED, SYNCING BY POLICY, THEN WRITE AND SYNC WHAT IS LEFT*/
+int saveWriterThread(void* data)
+{
+	SaveFile *save = (SaveFile*)data;
+	bool stopping;
+
+	do{
+		stopping = SDL_AtomicGet(&save->stop) != 0; //read before draining so lines queued until stop are not lost
+
+		drainSaveQueue(save);
+
+		if(save->sync.mode == SAVE_SYNC_INTERVAL && save->unsynced > 0 && SDL_GetTicks() - save->lastSyncTicks >= save->sync.every)
+			syncSaveFiles(save);
+
+		if(!stopping)
+			SDL_Delay(SAVE_WRITER_POLL_MS);
+	} while(!stopping);
+
+	if(save->sync.mode != SAVE_SYNC_NONE && save->unsynced > 0)
+		syncSaveFiles(save);
+
+	return save->failed ? -1 : 0;
+}
+
+/*FRAME EVERY QUEUED LINE INTO THE BATCH, WRITING IT OUT WHEN FULL, WHEN A LINES SYNC IS DUE AND ONCE THE QUEUE IS EMPTY*/
+void drainSaveQueue(SaveFile* save)
+{
+	Uint8 line[SAVE_MAX_LINE];
+	char prefix[SAVE_FRAME_PREFIX + 1];
+	Uint16 len;
+
+	while(ringBufferAvailable(&save->queue) >= sizeof(Uint16))
+	{
+		ringBufferRead(&save->queue, &len, sizeof(Uint16));
+		ringBufferRead(&save->queue, line, len);
+
+		if(save->failed) //keep draining so appends never back up, drop the lines
+			continue;
+
+		if(save->batchLen + SAVE_FRAME_PREFIX + len + 1 > SAVE_WRITE_BATCH && !flushSaveBatch(save))
+			continue;
+
+		//close a line torn by an earlier run so it does not swallow the first new one
+		if(save->tornTail){
+			save->batch[save->batchLen++] = SAVE_LINE_DELIMITER;
+			save->tornTail = false;
+		}
+
+		save->batchOffsets[save->batchLines++] = save->fileSize + save->batchLen;
+
+		SDL_snprintf(prefix, sizeof(prefix), "%08X ", saveCrc32(line, len));
+		SDL_memcpy(&save->batch[save->batchLen], prefix, SAVE_FRAME_PREFIX);
+		SDL_memcpy(&save->batch[save->batchLen + SAVE_FRAME_PREFIX], line, len);
+		save->batchLen += SAVE_FRAME_PREFIX + len;
+		save->batch[save->batchLen++] = SAVE_LINE_DELIMITER;
+
+		if(save->sync.mode == SAVE_SYNC_LINES && save->unsynced + save->batchLines >= save->sync.every)
+			flushSaveBatch(save);
+	}
+
+	flushSaveBatch(save);
+}
+
+/*WRITE THE BATCH WITH ONE CALL, THEN ITS OFFSETS AND THE INDEX HEADER (SYNCING THE TEXT BEFORE THE INDEX POINTS AT IT WHEN A LINES SYNC IS DUE)*/
+bool flushSaveBatch(SaveFile* save)
+{
+	bool syncNow;
+	int i;
+
+	if(save->failed)
+		save->batchLen = save->batchLines = 0;
+	if(save->batchLen == 0)
+		return !save->failed;
+
+	//say where framing starts before the first framed line is written, a crash in between must not leave it to guessing
+	if(!(save->flags & SAVE_INDEX_FRAMED)){
+		save->flags |= SAVE_INDEX_FRAMED;
+		save->framedFrom = save->batchOffsets[0];
+
+		if(!writeSaveIndexHeader(save) || fflush(save->indexFile) != 0){
+			save->failed = true;
+			save->batchLen = save->batchLines = 0;
+			return false;
+		}
+	}
+
+	if(fwrite(save->batch, 1, save->batchLen, save->file) != (size_t)save->batchLen || fflush(save->file) != 0){
+		SDL_SetError("Could not append %d bytes", save->batchLen);
+		print_err("Could not write save file");
+		save->failed = true;
+		save->batchLen = save->batchLines = 0;
+		return false;
+	}
+
+	save->fileSize += save->batchLen;
+	save->unsynced += save->batchLines;
+	syncNow = save->sync.mode == SAVE_SYNC_LINES && save->unsynced >= save->sync.every;
+
+	for(i = 0; i < save->batchLines; i++)
+		save->batchOffsets[i] = SDL_SwapLE64(save->batchOffsets[i]);
+
+	if((syncNow && !syncFile(save->file)) ||
+		fseek(save->indexFile, (long)(SAVE_INDEX_HEADER_SIZE + save->indexedLines * sizeof(Uint64)), SEEK_SET) != 0 ||
+		fwrite(save->batchOffsets, sizeof(Uint64), save->batchLines, save->indexFile) != (size_t)save->batchLines){
+		SDL_SetError("Could not index %d lines", save->batchLines);
+		print_err("Could not write save file index");
+		save->failed = true;
+		save->batchLen = save->batchLines = 0;
+		return false;
+	}
+
+	save->indexedLines += save->batchLines;
+	save->indexedBytes = save->fileSize;
+	save->batchLen = save->batchLines = 0;
+
+	if(!writeSaveIndexHeader(save) || fflush(save->indexFile) != 0){
+		save->failed = true;
+		return false;
+	}
+
+	return !syncNow || syncSaveFiles(save);
+}
+
+bool syncSaveFiles(SaveFile* save)
+{
+	if(!syncFile(save->file) || !syncFile(save->indexFile)){
+		SDL_SetError("Could not sync %s", save->indexPath);
+		print_err("Could not sync save file");
+		save->failed = true;
+		return false;
+	}
+
+	save->unsynced = 0;
+	save->lastSyncTicks = SDL_GetTicks();
+
+	return true;
+}
+
+/*FLUSH file AND WAIT UNTIL THE OS HAS IT ON DISK*/
+bool syncFile(FILE* file)
+{
+	if(fflush(file) != 0)
+		return false;
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+Uint64 readLE64(const Uint8* bytes)
+{
+	Uint64 value;
+
+	SDL_memcpy(&value, bytes, sizeof(Uint64));
+
+	return SDL_SwapLE64(value);
+}
+
+/*UNIFORM NUMBER IN [0, bound), REJECTING THE FEW DRAWS THAT WOULD BIAS THE MODULO*/
+Uint64 uniformRandom(Uint64* state, Uint64 bound)
+{
+	Uint64 threshold = (0 - bound) % bound, r;
+
+	do{
+		r = levelRandom(state);
+	}while(r < threshold);
+
+	return r % bound;
+}
@@ -0,0 +1,82 @@
+#ifndef SAVEFILE_H
+#define SAVEFILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "ringbuffer.h"
+
+#define SAVE_FILE_PATH_SIZE 256
+#define SAVE_INDEX_SUFFIX ".idx"
+#define SAVE_INDEX_MAGIC 0x58444950u //"PIDX"
+#define SAVE_INDEX_VERSION 3
+#define SAVE_INDEX_HEADER_SIZE 40    //magic, version, flags, reserved, indexed text bytes, lines, offset of the first framed line
+#define SAVE_INDEX_FRAMED 1          //header flag: framed lines were written, lines from the first one on must carry a good frame
+#define SAVE_LINE_DELIMITER '\n'
+#define SAVE_FRAME_PREFIX 9          //"%08X " CRC-32 of the line, then the line
+#define SAVE_MAX_LINE 1024           //longer lines are cut
+#define SAVE_MAX_SAMPLES 16          //lines drawn per sampleSavedLines call at most
+#define SAVE_INDEX_WRITE_CHUNK 1024  //offsets buffered per write while indexing
+#define SAVE_QUEUE_BYTES 65536       //lines waiting for the writer thread, appends are dropped past it
+#define SAVE_WRITE_BATCH 16384       //framed bytes the writer thread gathers per write
+#define SAVE_WRITER_POLL_MS 20       //idle wait of the writer thread
+#define SAVE_DEFAULT_SYNC_MS 1000
+
+//when the writer thread forces written lines to disk (fsync), later lines can be lost on a crash but never earlier ones
+typedef enum
+{
+	SAVE_SYNC_NONE,     //leave it to the OS
+	SAVE_SYNC_INTERVAL, //every `every` ms while lines are pending
+	SAVE_SYNC_LINES     //every `every` lines
+} SaveSyncEnum;
+
+typedef struct{
+	SaveSyncEnum mode;
+	Uint32 every;
+} SaveSyncPolicy;
+
+//read only view of a whole file as it was when mapped, data is NULL for empty files
+typedef struct{
+	const Uint8 *data;
+	Uint64 size;
+} MappedFile;
+
+//delimited text lines only ever appended to, with a sidecar index of line start offsets (little endian Uint64s after the header)
+//so opening and sampling never scan the text: both files are mapped as they were at open, appended lines are indexed for the next run.
+//appends are queued to a writer thread that frames each line with its CRC, so a torn tail is skipped when the text is indexed again
+typedef struct{
+	FILE *file;             //text, append only, writer thread once started
+	FILE *indexFile;        //sidecar, header rewritten after every batch
+	MappedFile text;
+	MappedFile index;
+	Uint64 mappedLines;     //lines readable through the mappings
+	Uint64 indexedBytes;    //text bytes up to the end of the last indexed line
+	Uint64 indexedLines;
+	Uint64 fileSize;        //text bytes written
+	Uint32 flags;           //SAVE_INDEX_ header flags
+	Uint64 framedFrom;      //offset of the first framed line (SAVE_INDEX_FRAMED), lines before it are unframed ones from older versions
+	Uint64 tornLines;       //lines skipped while indexing
+	bool tornTail;          //text ends in an unterminated line, closed before the next append
+	SaveSyncPolicy sync;
+	Uint32 unsynced;        //lines written since the last sync
+	Uint32 lastSyncTicks;
+	RingBuffer queue;       //game thread -> writer thread, Uint16 length then the line
+	SDL_Thread *writer;
+	SDL_atomic_t stop;
+	SDL_atomic_t dropped;   //lines lost to a full queue
+	bool failed;            //writer thread hit an I/O error
+	char batch[SAVE_WRITE_BATCH];
+	Uint64 batchOffsets[SAVE_WRITE_BATCH / (SAVE_FRAME_PREFIX + 1)];
+	int batchLen, batchLines;
+	char indexPath[SAVE_FILE_PATH_SIZE];
+} SaveFile;
+
+bool openSaveFile(SaveFile* save, const char* path, SaveSyncPolicy sync);
+void closeSaveFile(SaveFile* save);
+bool appendSavedLine(SaveFile* save, const char* line, int len);
+int sampleSavedLines(SaveFile* save, char** lines, int k, int lineSize, Uint64* rngState);
+bool parseSaveSyncPolicy(const char* text, SaveSyncPolicy* sync);
+bool mapFile(MappedFile* mapped, const char* path);
+void unmapFile(MappedFile* mapped);
+
+#endif
@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include "atlas.h"
+
+#define ATLASPACK_PADDING 2     //transparent pixels around every packed clip, so filtering never samples a neighbour
+#define ATLASPACK_MIN_SIZE 64
+#define ATLASPACK_MAX_SIZE 4096
+#define ATLASPACK_OUT_SIZE (ATLAS_PATH_SIZE - 4)
+
+typedef struct{
+	AtlasClip clip;        //rect: trimmed size, placed on the page by shelfPack
+	SDL_Surface *pixels;   //trimmed RGBA32 pixels
+} Piece;
+
+bool cutPieces(Atlas* spec, Piece* pieces, int* nPieces, Uint64* sourcePixels);
+bool savePage(Piece* pieces, int nPieces, const char* path, int* width, int* height);
+SDL_Surface* loadSourcePage(Atlas* spec, int page);
+SDL_Surface* cutPiece(SDL_Surface* source, SDL_Rect rect, int level, SDL_Rect* frame);
+int comparePieces(const void* a, const void* b);
+int shelfPack(Piece** order, int nPieces, int width);
+
+/*PACK THE CLIPS OF A SPEC FILE INTO ONE PAGE: atlaspack --spec FILE --out NAME (WRITES NAME.png AND NAME.txt)*/
+int main(int argc, char** argv)
+{
+	static Atlas spec, packed;
+	static Piece pieces[ATLAS_MAX_CLIPS];
+	const char *specPath = NULL, *outName = NULL;
+	char pngPath[ATLAS_PATH_SIZE], txtPath[ATLAS_PATH_SIZE];
+	Uint64 sourcePixels = 0;
+	int nPieces = 0, width = 0, height = 0, i;
+	bool success;
+
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--spec") == 0 && i+1 < argc)
+			specPath = argv[++i];
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outName = argv[++i];
+		else
+			break;
+	}
+
+	if(i < argc || specPath == NULL || outName == NULL || strlen(outName) >= ATLASPACK_OUT_SIZE){
+		fprintf(stderr, "usage: %s --spec FILE --out NAME\n", argv[0]);
+		return 1;
+	}
+
+	SDL_snprintf(pngPath, sizeof(pngPath), "%s.png", outName);
+	SDL_snprintf(txtPath, sizeof(txtPath), "%s.txt", outName);
+
+	if(!readAtlas(&spec, specPath)){
+		fprintf(stderr, "%s\n", SDL_GetError());
+		return 1;
+	}
+
+	if(IMG_Init(IMG_INIT_PNG) == 0){
+		print_err("Could not initialize SDL_image");
+		return 1;
+	}
+
+	success = cutPieces(&spec, pieces, &nPieces, &sourcePixels) && savePage(pieces, nPieces, pngPath, &width, &height);
+
+	if(success){
+		addAtlasPage(&packed, pngPath, NULL);
+		for(i = 0; i < nPieces; i++)
+			packed.clips[packed.nClips++] = pieces[i].clip;
+
+		success = writeAtlas(&packed, txtPath);
+		if(!success)
+			fprintf(stderr, "%s\n", SDL_GetError());
+	}
+
+	if(success){
+		printf("%d clips (%d with variants) from %d images -> %s %dx%d, %.0f%% of the source pixels\n", spec.nClips, nPieces, spec.nPages,
+			pngPath, width, height, 100.0 * width * height / (double)sourcePixels);
+	}
+
+	for(i = 0; i < nPieces; i++)
+		SDL_FreeSurface(pieces[i].pixels);
+	IMG_Quit();
+
+	return success ? 0 : 1;
+}
+
+/*CUT EVERY CLIP OF spec AT EVERY LEVEL IT ASKS FOR INTO pieces, TRIMMED TO ITS VISIBLE PIXELS*/
+bool cutPieces(Atlas* spec, Piece* pieces, int* nPieces, Uint64* sourcePixels)
+{
+	SDL_Surface *sources[ATLAS_MAX_PAGES] = {NULL};
+	SDL_Surface *source;
+	AtlasClip *clip;
+	Piece *piece;
+	int i, level;
+	bool success = spec->nClips > 0;
+
+	if(!success)
+		fprintf(stderr, "No clips to pack\n");
+
+	for(i = 0; success && i < spec->nClips; i++)
+	{
+		clip = &spec->clips[i];
+
+		if(sources[clip->page] == NULL){
+			sources[clip->page] = loadSourcePage(spec, clip->page);
+			if(sources[clip->page] != NULL)
+				*sourcePixels += (Uint64)sources[clip->page]->w * sources[clip->page]->h;
+		}
+
+		source = sources[clip->page];
+		if(source == NULL)
+			break;
+
+		if(clip->level != 0 || clip->rect.x < 0 || clip->rect.y < 0 || clip->rect.x + clip->rect.w > source->w || clip->rect.y + clip->rect.h > source->h){
+			fprintf(stderr, "Clip %s is not a full size rect inside %s\n", clip->name, spec->pages[clip->page]);
+			break;
+		}
+
+		for(level = 0; success && level < clip->levels; level++)
+		{
+			if(*nPieces == ATLAS_MAX_CLIPS){
+				fprintf(stderr, "More than %d clips with their variants\n", ATLAS_MAX_CLIPS);
+				success = false;
+				break;
+			}
+
+			piece = &pieces[*nPieces];
+			piece->clip = *clip;
+			piece->clip.page = 0;
+			piece->clip.level = level;
+			piece->clip.levels = 1;
+			piece->pixels = cutPiece(source, clip->rect, level, &piece->clip.frame);
+			if(piece->pixels == NULL){
+				success = false;
+				break;
+			}
+
+			piece->clip.rect = (SDL_Rect){0, 0, piece->pixels->w, piece->pixels->h};
+			(*nPieces)++;
+		}
+	}
+
+	for(level = 0; level < ATLAS_MAX_PAGES; level++)
+		SDL_FreeSurface(sources[level]);
+
+	return success && i == spec->nClips;
+}
+
+/*PLACE pieces ON THE SMALLEST SQUARE-ISH POWER OF TWO WIDE PAGE THEY FIT IN AND SAVE IT AS A PNG TO path*/
+bool savePage(Piece* pieces, int nPieces, const char* path, int* width, int* height)
+{
+	Piece *order[ATLAS_MAX_CLIPS];
+	SDL_Surface *page;
+	int i, row;
+	bool saved;
+
+	for(i = 0; i < nPieces; i++)
+		order[i] = &pieces[i];
+	qsort(order, nPieces, sizeof(Piece*), comparePieces);
+
+	for(*width = ATLASPACK_MIN_SIZE; *width <= ATLASPACK_MAX_SIZE; *width *= 2)
+	{
+		*height = shelfPack(order, nPieces, *width);
+		if(*height > 0 && *height <= *width)
+			break;
+	}
+
+	if(*width > ATLASPACK_MAX_SIZE){
+		fprintf(stderr, "Clips don't fit on a %dx%d page\n", ATLASPACK_MAX_SIZE, ATLASPACK_MAX_SIZE);
+		return false;
+	}
+
+	page = SDL_CreateRGBSurfaceWithFormat(0, *width, *height, 32, SDL_PIXELFORMAT_RGBA32);
+	if(page == NULL){
+		print_err("Could not create atlas page");
+		return false;
+	}
+
+	SDL_FillRect(page, NULL, 0);
+
+	for(i = 0; i < nPieces; i++)
+	{
+		for(row = 0; row < pieces[i].clip.rect.h; row++)
+		{
+			memcpy((Uint8*)page->pixels + (pieces[i].clip.rect.y + row) * page->pitch + pieces[i].clip.rect.x * 4,
+				(Uint8*)pieces[i].pixels->pixels + row * pieces[i].pixels->pitch, pieces[i].clip.rect.w * 4);
+		}
+	}
+
+	saved = IMG_SavePNG(page, path) == 0;
+	if(!saved)
+		print_err("Could not save atlas page");
+
+	SDL_FreeSurface(page);
+	return saved;
+}
+
+/*LOAD page OF spec AS RGBA32, COLOR KEYED PIXELS MADE TRANSPARENT*/
+SDL_Surface* loadSourcePage(Atlas* spec, int page)
+{
+	SDL_Surface *loaded = loadSurface(spec->pages[page]);
+	SDL_Surface *surface = NULL;
+	SDL_Color key = spec->pageKeys[page];
+	Uint8 *pixel;
+	int x, y;
+
+	if(loaded != NULL){
+		surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(loaded);
+	}
+
+	if(surface == NULL){
+		fprintf(stderr, "Could not load %s: %s\n", spec->pages[page], SDL_GetError());
+		return NULL;
+	}
+
+	if(spec->pageKeyed[page]){
+		for(y = 0; y < surface->h; y++)
+		{
+			pixel = (Uint8*)surface->pixels + y * surface->pitch;
+			for(x = 0; x < surface->w; x++, pixel += 4)
+			{
+				if(pixel[0] == key.r && pixel[1] == key.g && pixel[2] == key.b)
+					pixel[3] = 0;
+			}
+		}
+	}
+
+	return surface;
+}
+
+/*CUT rect OUT OF source AT 1/2^level (BOX FILTERED, ALPHA WEIGHTED) AND TRIM ITS TRANSPARENT BORDERS. frame GETS THE UNTRIMMED SIZE
+AND WHERE THE TRIMMED PIXELS SIT INSIDE IT*/
+SDL_Surface* cutPiece(SDL_Surface* source, SDL_Rect rect, int level, SDL_Rect* frame)
+{
+	int scale = 1 << level, w = SDL_max(rect.w >> level, 1), h = SDL_max(rect.h >> level, 1);
+	int x, y, sx, sy, minX = w, minY = h, maxX = -1, maxY = -1;
+	Uint32 sum[4], n;
+	Uint8 *in, *out;
+	SDL_Surface *scaled = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+	SDL_Surface *trimmed;
+
+	if(scaled == NULL){
+		print_err("Could not create clip surface");
+		return NULL;
+	}
+
+	for(y = 0; y < h; y++)
+	{
+		out = (Uint8*)scaled->pixels + y * scaled->pitch;
+		for(x = 0; x < w; x++, out += 4)
+		{
+			sum[0] = sum[1] = sum[2] = sum[3] = n = 0;
+
+			for(sy = rect.y + y*scale; sy < rect.y + (y+1)*scale && sy < rect.y + rect.h; sy++)
+			{
+				in = (Uint8*)source->pixels + sy * source->pitch + (rect.x + x*scale) * 4;
+				for(sx = 0; sx < scale && x*scale + sx < rect.w; sx++, in += 4, n++)
+				{
+					sum[0] += in[0] * in[3];
+					sum[1] += in[1] * in[3];
+					sum[2] += in[2] * in[3];
+					sum[3] += in[3];
+				}
+			}
+
+			out[0] = sum[3] ? (Uint8)(sum[0] / sum[3]) : 0;
+			out[1] = sum[3] ? (Uint8)(sum[1] / sum[3]) : 0;
+			out[2] = sum[3] ? (Uint8)(sum[2] / sum[3]) : 0;
+			out[3] = n ? (Uint8)(sum[3] / n) : 0;
+
+			if(out[3] != 0){
+				minX = SDL_min(minX, x);
+				maxX = SDL_max(maxX, x);
+				minY = SDL_min(minY, y);
+				maxY = SDL_max(maxY, y);
+			}
+		}
+	}
+
+	if(maxX < 0) //fully transparent, keep one pixel
+		minX = maxX = minY = maxY = 0;
+
+	*frame = (SDL_Rect){minX, minY, w, h};
+
+	trimmed = SDL_CreateRGBSurfaceWithFormat(0, maxX - minX + 1, maxY - minY + 1, 32, SDL_PIXELFORMAT_RGBA32);
+	if(trimmed == NULL){
+		print_err("Could not create clip surface");
+		SDL_FreeSurface(scaled);
+		return NULL;
+	}
+
+	for(y = 0; y < trimmed->h; y++)
+		memcpy((Uint8*)trimmed->pixels + y * trimmed->pitch, (Uint8*)scaled->pixels + (minY + y) * scaled->pitch + minX * 4, trimmed->w * 4);
+
+	SDL_FreeSurface(scaled);
+	return trimmed;
+}
+
+/*TALLEST PIECES FIRST, WIDEST FIRST AMONG EQUALLY TALL ONES*/
+int comparePieces(const void* a, const void* b)
+{
+	const Piece *pa = *(const Piece* const*)a, *pb = *(const Piece* const*)b;
+
+	if(pa->clip.rect.h != pb->clip.rect.h)
+		return pb->clip.rect.h - pa->clip.rect.h;
+
+	return pb->clip.rect.w - pa->clip.rect.w;
+}
+
+/*PLACE order ON SHELVES OF A width WIDE PAGE AND RETURN THE HEIGHT USED (-1 IF A PIECE IS WIDER THAN THE PAGE)*/
+int shelfPack(Piece** order, int nPieces, int width)
+{
+	int i, x = ATLASPACK_PADDING, y = ATLASPACK_PADDING, shelfHeight = 0;
+
+	for(i = 0; i < nPieces; i++)
+	{
+		SDL_Rect *rect = &order[i]->clip.rect;
+
+		if(rect->w + 2*ATLASPACK_PADDING > width)
+			return -1;
+
+		if(x + rect->w + ATLASPACK_PADDING > width){
+			y += shelfHeight + ATLASPACK_PADDING;
+			x = ATLASPACK_PADDING;
+			shelfHeight = 0;
+		}
+
+		rect->x = x;
+		rect->y = y;
+		x += rect->w + ATLASPACK_PADDING;
+		shelfHeight = SDL_max(shelfHeight, rect->h);
+	}
+
+	return y + shelfHeight + ATLASPACK_PADDING;
+}
@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include "levelgen.h"
+
+#define LEVELGEN_DEFAULT_COLS 22
+#define LEVELGEN_DEFAULT_ROWS 11
+#define LEVELGEN_DEFAULT_WALL_PERCENT 100
+#define LEVELGEN_DEFAULT_SEED 1
+
+/*WRITE A GENERATED LEVEL FILE: levelgen [--kind maze|arena] [--size COLSxROWS] [--walls PERCENT] [--seed N] --out FILE*/
+int main(int argc, char** argv)
+{
+	LevelSpec spec = {LEVEL_MAZE, LEVELGEN_DEFAULT_COLS, LEVELGEN_DEFAULT_ROWS, LEVELGEN_DEFAULT_WALL_PERCENT, LEVELGEN_DEFAULT_SEED};
+	const char *outPath = NULL;
+	int i;
+
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--kind") == 0 && i+1 < argc)
+			spec.kind = levelKindFromName(argv[++i]);
+		else if(strcmp(argv[i], "--size") == 0 && i+1 < argc){
+			if(sscanf(argv[++i], "%dx%d", &spec.cols, &spec.rows) != 2)
+				spec.cols = spec.rows = 0;
+		}
+		else if(strcmp(argv[i], "--walls") == 0 && i+1 < argc)
+			spec.wallPercent = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc)
+			spec.seed = strtoull(argv[++i], NULL, 10);
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outPath = argv[++i];
+		else
+			break;
+	}
+
+	if(i < argc || outPath == NULL || spec.kind == N_LEVEL_KINDS || spec.cols <= 0 || spec.rows <= 0 || spec.wallPercent < 0 || spec.wallPercent > 100){
+		fprintf(stderr, "usage: %s [--kind maze|arena] [--size COLSxROWS] [--walls 0-100] [--seed N] --out FILE\n", argv[0]);
+		return 1;
+	}
+
+	if(!generateLevelFile(spec, outPath)){
+		fprintf(stderr, "Could not write %s\n", outPath);
+		return 1;
+	}
+
+	return 0;
+}
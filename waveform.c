@@ -0,0 +1,305 @@
+#include <float.h>
+#include "waveform.h"
+#include "engine.h"
+#include "commandbuffer.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define WAVE_SSE 1
+#endif
+
+void peakKernel(const float* samples, int n, Peak* peak);
+void startPeakBlock(PeakAccumulator* acc);
+void accumulateSamples(PeakAccumulator* acc, const Uint8* bytes, int nSamples, PeakHandler handler, void* data);
+Peak combinePeaks(Peak a, Peak b);
+bool appendPeak(PeakLevel* level, Peak peak);
+
+/*PREPARE acc FOR AUDIO IN spec FORMAT (F32, S16 OR S32), FALSE IF THE FORMAT IS NOT SUPPORTED*/
+bool initPeakAccumulator(PeakAccumulator* acc, const SDL_AudioSpec* spec)
+{
+	bool supported = spec->format == AUDIO_F32SYS || spec->format == AUDIO_S16SYS || spec->format == AUDIO_S32SYS;
+
+	acc->format = spec->format;
+	acc->sampleSize = SDL_AUDIO_BITSIZE(spec->format) / 8;
+	acc->blockSamples = supported ? WAVE_PEAK_BLOCK_FRAMES * spec->channels : 0; //unsupported: accumulatePeaks ignores everything
+	acc->nCarry = 0;
+	startPeakBlock(acc);
+
+	return supported;
+}
+
+/*FEED len BYTES OF AUDIO TO acc, CALLING handler WITH EVERY LEVEL 0 PEAK COMPLETED*/
+void accumulatePeaks(PeakAccumulator* acc, const Uint8* bytes, Uint32 len, PeakHandler handler, void* data)
+{
+	Uint32 n;
+
+	if(acc->blockSamples == 0 || acc->sampleSize == 0 || len == 0)
+		return;
+
+	//finish the sample cut by the previous call
+	if(acc->nCarry > 0){
+		n = SDL_min(len, (Uint32)(acc->sampleSize - acc->nCarry));
+		SDL_memcpy(&acc->carry[acc->nCarry], bytes, n);
+		acc->nCarry += n;
+		bytes += n;
+		len -= n;
+
+		if(acc->nCarry < acc->sampleSize)
+			return;
+
+		accumulateSamples(acc, acc->carry, 1, handler, data);
+		acc->nCarry = 0;
+	}
+
+	n = len / acc->sampleSize;
+	accumulateSamples(acc, bytes, n, handler, data);
+
+	acc->nCarry = len - n * acc->sampleSize;
+	SDL_memcpy(acc->carry, bytes + n * acc->sampleSize, acc->nCarry);
+}
+
+/*CONVERT nSamples WHOLE SAMPLES TO FLOAT IN BATCHES AND RUN THEM THROUGH THE PEAK KERNEL*/
+void accumulateSamples(PeakAccumulator* acc, const Uint8* bytes, int nSamples, PeakHandler handler, void* data)
+{
+	float batch[WAVE_KERNEL_BATCH];
+	Sint16 s16;
+	Sint32 s32;
+	int i, n;
+
+	while(nSamples > 0)
+	{
+		n = SDL_min(SDL_min(nSamples, WAVE_KERNEL_BATCH), acc->blockSamples - acc->samples);
+
+		//copies also keep the kernel off unaligned loads from the audio stream
+		if(acc->format == AUDIO_F32SYS){
+			SDL_memcpy(batch, bytes, n * sizeof(float));
+		}
+		else if(acc->format == AUDIO_S16SYS){
+			for(i = 0; i < n; i++){
+				SDL_memcpy(&s16, bytes + i * sizeof(Sint16), sizeof(Sint16));
+				batch[i] = s16 * (1.0f / 32768.0f);
+			}
+		}
+		else{
+			for(i = 0; i < n; i++){
+				SDL_memcpy(&s32, bytes + i * sizeof(Sint32), sizeof(Sint32));
+				batch[i] = (float)s32 * (1.0f / 2147483648.0f);
+			}
+		}
+
+		peakKernel(batch, n, &acc->peak);
+		acc->samples += n;
+		bytes += n * acc->sampleSize;
+		nSamples -= n;
+
+		if(acc->samples == acc->blockSamples){
+			acc->peak.meanSquare /= acc->blockSamples;
+			handler(data, acc->peak);
+			startPeakBlock(acc);
+		}
+	}
+}
+
+/*FOLD n SAMPLES INTO peak MIN, MAX AND SUM OF SQUARES (4 LANES AT A TIME WITH SSE)*/
+void peakKernel(const float* samples, int n, Peak* peak)
+{
+	float lo = peak->min, hi = peak->max, sum = peak->meanSquare;
+	int i = 0;
+
+#ifdef WAVE_SSE
+	if(n >= 4){
+		__m128 vmin = _mm_set1_ps(lo), vmax = _mm_set1_ps(hi), vsum = _mm_setzero_ps(), v;
+		float lanes[3][4];
+		int j;
+
+		for(; i + 4 <= n; i += 4){
+			v = _mm_loadu_ps(samples + i);
+			vmin = _mm_min_ps(vmin, v);
+			vmax = _mm_max_ps(vmax, v);
+			vsum = _mm_add_ps(vsum, _mm_mul_ps(v, v));
+		}
+
+		_mm_storeu_ps(lanes[0], vmin);
+		_mm_storeu_ps(lanes[1], vmax);
+		_mm_storeu_ps(lanes[2], vsum);
+		for(j = 0; j < 4; j++){
+			lo = SDL_min(lo, lanes[0][j]);
+			hi = SDL_max(hi, lanes[1][j]);
+			sum += lanes[2][j];
+		}
+	}
+#endif
+
+	for(; i < n; i++){
+		lo = SDL_min(lo, samples[i]);
+		hi = SDL_max(hi, samples[i]);
+		sum += samples[i] * samples[i];
+	}
+
+	peak->min = lo;
+	peak->max = hi;
+	peak->meanSquare = sum;
+}
+
+void startPeakBlock(PeakAccumulator* acc)
+{
+	acc->peak = (Peak){FLT_MAX, -FLT_MAX, 0};
+	acc->samples = 0;
+}
+
+/*FORGET ALL PEAKS, KEEPING LEVEL MEMORY FOR THE NEXT RECORDING*/
+void resetPeakPyramid(PeakPyramid* pyramid)
+{
+	int i;
+
+	for(i = 0; i < WAVE_MAX_LEVELS; i++)
+		pyramid->levels[i].count = 0;
+
+	pyramid->nLevels = 0;
+	pyramid->frames = 0;
+}
+
+void freePeakPyramid(PeakPyramid* pyramid)
+{
+	int i;
+
+	for(i = 0; i < WAVE_MAX_LEVELS; i++){
+		SDL_free(pyramid->levels[i].peaks);
+		pyramid->levels[i] = (PeakLevel){NULL, 0, 0};
+	}
+
+	pyramid->nLevels = 0;
+	pyramid->frames = 0;
+}
+
+/*APPEND A LEVEL 0 PEAK, COMBINING IT UP THE PYRAMID WHENEVER IT COMPLETES A PAIR*/
+bool addPeak(PeakPyramid* pyramid, Peak peak)
+{
+	PeakLevel *level;
+	int k;
+
+	if(!appendPeak(&pyramid->levels[0], peak))
+		return false;
+
+	pyramid->frames += WAVE_PEAK_BLOCK_FRAMES;
+	pyramid->nLevels = SDL_max(pyramid->nLevels, 1);
+
+	for(k = 0; k + 1 < WAVE_MAX_LEVELS && pyramid->levels[k].count % 2 == 0; k++)
+	{
+		level = &pyramid->levels[k];
+		if(!appendPeak(&pyramid->levels[k+1], combinePeaks(level->peaks[level->count-2], level->peaks[level->count-1])))
+			return false;
+
+		pyramid->nLevels = SDL_max(pyramid->nLevels, k + 2);
+	}
+
+	return true;
+}
+
+bool appendPeak(PeakLevel* level, Peak peak)
+{
+	Peak *peaks;
+	int capacity;
+
+	if(level->count == level->capacity){
+		capacity = level->capacity > 0 ? level->capacity * 2 : 64;
+		peaks = (Peak*)SDL_realloc(level->peaks, capacity * sizeof(Peak));
+		if(peaks == NULL){
+			print_err("Could not grow waveform peaks");
+			return false;
+		}
+
+		level->peaks = peaks;
+		level->capacity = capacity;
+	}
+
+	level->peaks[level->count++] = peak;
+
+	return true;
+}
+
+/*COMBINE TWO EQUALLY SIZED PEAKS*/
+Peak combinePeaks(Peak a, Peak b)
+{
+	return (Peak){SDL_min(a.min, b.min), SDL_max(a.max, b.max), (a.meanSquare + b.meanSquare) * 0.5f};
+}
+
+/*SUMMARIZE FRAMES [firstFrame, lastFrame) (WIDENED TO WHOLE BLOCKS) FROM THE COARSEST ALIGNED PEAKS THAT FIT, FALSE IF NONE ARE RECORDED*/
+bool queryPeakRange(PeakPyramid* pyramid, Uint64 firstFrame, Uint64 lastFrame, Peak* peak)
+{
+	Uint64 block = firstFrame / WAVE_PEAK_BLOCK_FRAMES;
+	Uint64 end = (lastFrame + WAVE_PEAK_BLOCK_FRAMES - 1) / WAVE_PEAK_BLOCK_FRAMES;
+	Uint64 blocks = 0;
+	double sum = 0;
+	int k = 0;
+	Peak p;
+
+	end = SDL_min(end, (Uint64)pyramid->levels[0].count);
+	if(pyramid->nLevels == 0 || block >= end)
+		return false;
+
+	*peak = (Peak){FLT_MAX, -FLT_MAX, 0};
+
+	//walk the range like a segment tree: climb while aligned and inside, drop when overshooting
+	while(block < end)
+	{
+		while(k + 1 < pyramid->nLevels && (block & ((2ull << k) - 1)) == 0 && block + (2ull << k) <= end &&
+			(block >> (k + 1)) < (Uint64)pyramid->levels[k+1].count)
+			k++;
+		while(k > 0 && (block + (1ull << k) > end || (block >> k) >= (Uint64)pyramid->levels[k].count))
+			k--;
+
+		p = pyramid->levels[k].peaks[block >> k];
+		peak->min = SDL_min(peak->min, p.min);
+		peak->max = SDL_max(peak->max, p.max);
+		sum += (double)p.meanSquare * (1ull << k);
+		blocks += 1ull << k;
+		block += 1ull << k;
+	}
+
+	peak->meanSquare = (float)(sum / blocks);
+
+	return true;
+}
+
+/*DRAW ONE MIN/MAX BAR (AND AN RMS BAR INSIDE IT) PER COLUMN OF area, COLUMN c SHOWING framesPerPixel FRAMES FROM firstFrame + c * framesPerPixel*/
+void renderWaveform(PeakPyramid* pyramid, Sint64 firstFrame, double framesPerPixel, SDL_Rect area, SDL_Color color, SDL_Rect* camera)
+{
+	SDL_Rect *bars, *rmsBars;
+	Sint64 first, last;
+	int c, n = 0, top, bottom, rms;
+	int mid = area.y - camera->y + area.h / 2;
+	float half = area.h / 2.0f;
+	Peak peak;
+
+	if(area.w <= 0 || framesPerPixel <= 0 || !checkCollision(area, *camera)) //off-screen
+		return;
+
+	bars = (SDL_Rect*)arenaAlloc(&frameArena, 2 * area.w * sizeof(SDL_Rect));
+	if(bars == NULL)
+		return;
+	rmsBars = bars + area.w;
+
+	for(c = 0; c < area.w; c++)
+	{
+		first = firstFrame + (Sint64)(c * framesPerPixel);
+		last = firstFrame + (Sint64)((c + 1) * framesPerPixel);
+
+		if(last <= 0 || !queryPeakRange(pyramid, (Uint64)SDL_max(first, 0), (Uint64)last, &peak))
+			continue;
+
+		top = mid - (int)(SDL_min(SDL_max(peak.max, -1.0f), 1.0f) * half);
+		bottom = mid - (int)(SDL_min(SDL_max(peak.min, -1.0f), 1.0f) * half);
+		rms = (int)(SDL_min(sqrtf(peak.meanSquare), 1.0f) * half);
+
+		bars[n] = (SDL_Rect){area.x - camera->x + c, top, 1, bottom - top + 1};
+		rmsBars[n] = (SDL_Rect){area.x - camera->x + c, mid - rms, 1, 2 * rms + 1};
+		n++;
+	}
+
+	if(n == 0)
+		return;
+
+	drawFillRects(bars, n, (SDL_Color){color.r, color.g, color.b, 128}, SDL_BLENDMODE_BLEND);
+	drawFillRects(rmsBars, n, (SDL_Color){color.r, color.g, color.b, 255}, SDL_BLENDMODE_BLEND);
+}
@@ -0,0 +1,52 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+
+#define WAVE_PEAK_BLOCK_FRAMES 256 //audio frames summarized by one level 0 peak
+#define WAVE_MAX_LEVELS 24         //level k peaks cover WAVE_PEAK_BLOCK_FRAMES << k frames
+#define WAVE_KERNEL_BATCH 256      //samples converted to float per kernel call
+
+//min/max/RMS summary of a block of samples (all channels together)
+typedef struct{
+	float min, max;
+	float meanSquare;
+} Peak;
+
+typedef struct{
+	Peak *peaks;
+	int count;
+	int capacity;
+} PeakLevel;
+
+//multi resolution peak summary of a recording: level 0 holds one peak per block, each level
+//above combines pairs of the one below, so any zoom reads O(pixels) peaks rather than samples
+typedef struct{
+	PeakLevel levels[WAVE_MAX_LEVELS];
+	int nLevels;
+	Uint64 frames; //frames summarized in complete level 0 blocks
+} PeakPyramid;
+
+typedef void (*PeakHandler)(void* data, Peak peak);
+
+//turns raw audio bytes into level 0 peaks, samples may arrive split across calls
+typedef struct{
+	Peak peak;        //block in progress, meanSquare holds the sum of squares until emitted
+	int samples;      //samples in the block in progress
+	int blockSamples;
+	int sampleSize;
+	SDL_AudioFormat format;
+	Uint8 carry[4];   //bytes of a sample cut by the previous call
+	int nCarry;
+} PeakAccumulator;
+
+bool initPeakAccumulator(PeakAccumulator* acc, const SDL_AudioSpec* spec);
+void accumulatePeaks(PeakAccumulator* acc, const Uint8* bytes, Uint32 len, PeakHandler handler, void* data);
+void resetPeakPyramid(PeakPyramid* pyramid);
+void freePeakPyramid(PeakPyramid* pyramid);
+bool addPeak(PeakPyramid* pyramid, Peak peak);
+bool queryPeakRange(PeakPyramid* pyramid, Uint64 firstFrame, Uint64 lastFrame, Peak* peak);
+void renderWaveform(PeakPyramid* pyramid, Sint64 firstFrame, double framesPerPixel, SDL_Rect area, SDL_Color color, SDL_Rect* camera);
+
+#endif
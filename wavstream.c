@@ -0,0 +1,285 @@
+#include "wavstream.h"
+#include "engine.h"
+
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+#define WAV_MAX_DATA_SIZE (0xFFFFFFFFu - (WAV_HEADER_SIZE - 8)) //RIFF sizes are 32 bit
+
+bool writeWavHeader(SDL_RWops* file, const SDL_AudioSpec* spec, Uint32 dataSize);
+bool readWavHeader(SDL_RWops* file, SDL_AudioSpec* spec, Uint32* dataSize);
+int wavWriterThread(void* data);
+int wavReaderThread(void* data);
+int fillWavReader(WavStream* stream);
+
+/*CREATE path AND START A THREAD APPENDING EVERYTHING QUEUED IN ring (SAMPLES IN spec FORMAT) TO IT AS WAV DATA, PASSING EACH CHUNK TO tap IF SET*/
+bool startWavWriter(WavStream* stream, const char* path, const SDL_AudioSpec* spec, RingBuffer* ring, WavStreamTap tap, void* tapData)
+{
+	stream->file = SDL_RWFromFile(path, "wb");
+	if(stream->file == NULL){
+		print_err("Could not open recording file for writing");
+		return false;
+	}
+
+	stream->ring = ring;
+	stream->spec = *spec;
+	stream->tap = tap;
+	stream->tapData = tapData;
+	stream->dataSize = 0;
+	stream->failed = false;
+	SDL_AtomicSet(&stream->stop, 0);
+	SDL_AtomicSet(&stream->bytes, 0);
+
+	//sizes are patched in by stopWavWriter once known
+	if(!writeWavHeader(stream->file, spec, 0)){
+		print_err("Could not write recording file header");
+		SDL_RWclose(stream->file);
+		stream->file = NULL;
+		return false;
+	}
+
+	stream->thread = SDL_CreateThread(wavWriterThread, "wavWriter", stream);
+	if(stream->thread == NULL){
+		print_err("Could not start recording writer thread");
+		SDL_RWclose(stream->file);
+		stream->file = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/*DRAIN WHAT IS LEFT IN THE RING, JOIN THE WRITER THREAD AND CLOSE THE FILE WITH ITS FINAL SIZES, RETURN SAMPLE BYTES WRITTEN*/
+Uint32 stopWavWriter(WavStream* stream)
+{
+	if(stream->thread == NULL)
+		return 0;
+
+	SDL_AtomicSet(&stream->stop, 1);
+	SDL_WaitThread(stream->thread, NULL);
+	stream->thread = NULL;
+
+	stream->dataSize = (Uint32)SDL_AtomicGet(&stream->bytes);
+
+	if(SDL_RWseek(stream->file, 4, RW_SEEK_SET) < 0 || !SDL_WriteLE32(stream->file, (WAV_HEADER_SIZE - 8) + stream->dataSize) ||
+		SDL_RWseek(stream->file, WAV_HEADER_SIZE - 4, RW_SEEK_SET) < 0 || !SDL_WriteLE32(stream->file, stream->dataSize)){
+		print_err("Could not finish recording file header");
+		stream->failed = true;
+	}
+
+	SDL_RWclose(stream->file);
+	stream->file = NULL;
+
+	return stream->dataSize;
+}
+
+/*OPEN WAV FILE path AND START A THREAD QUEUEING ITS SAMPLES INTO ring CONVERTED TO ringSpec (FINISHED AT END OF FILE), THE FIRST RING FULL IS QUEUED BEFORE RETURNING*/
+bool startWavReader(WavStream* stream, const char* path, RingBuffer* ring, const SDL_AudioSpec* ringSpec)
+{
+	stream->file = SDL_RWFromFile(path, "rb");
+	if(stream->file == NULL){
+		print_err("Could not open recording file for reading");
+		return false;
+	}
+
+	stream->ring = ring;
+	stream->failed = false;
+	stream->chunkPos = stream->chunkLen = 0;
+	SDL_AtomicSet(&stream->stop, 0);
+	SDL_AtomicSet(&stream->bytes, 0);
+
+	if(!readWavHeader(stream->file, &stream->spec, &stream->dataSize)){
+		print_err("Invalid recording file");
+		SDL_RWclose(stream->file);
+		stream->file = NULL;
+		return false;
+	}
+
+	initAudioConverter(&stream->converter, &stream->spec, ringSpec); //falls back to a plain copy
+
+	//prime the ring so playback does not start on an underrun
+	while(fillWavReader(stream) > 0);
+
+	stream->thread = SDL_CreateThread(wavReaderThread, "wavReader", stream);
+	if(stream->thread == NULL){
+		print_err("Could not start recording reader thread");
+		freeAudioConverter(&stream->converter);
+		SDL_RWclose(stream->file);
+		stream->file = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/*JOIN THE READER THREAD (STOPPING IT EARLY IF STILL QUEUEING) AND CLOSE ITS FILE*/
+void stopWavReader(WavStream* stream)
+{
+	if(stream->thread == NULL)
+		return;
+
+	SDL_AtomicSet(&stream->stop, 1);
+	SDL_WaitThread(stream->thread, NULL);
+	stream->thread = NULL;
+
+	freeAudioConverter(&stream->converter);
+	SDL_RWclose(stream->file);
+	stream->file = NULL;
+}
+
+/*WRITER THREAD: APPEND RING CONTENTS TO THE FILE UNTIL STOPPED, THEN DRAIN THE REST*/
+int wavWriterThread(void* data)
+{
+	WavStream *stream = (WavStream*)data;
+	Uint32 n, written;
+	bool stopping;
+
+	do{
+		stopping = SDL_AtomicGet(&stream->stop) != 0; //read before draining so bytes queued until stop are not lost
+
+		while((n = ringBufferRead(stream->ring, stream->chunk, SDL_min(ringBufferAvailable(stream->ring), WAV_STREAM_CHUNK))) > 0)
+		{
+			written = (Uint32)SDL_AtomicGet(&stream->bytes);
+
+			if(stream->failed || written >= WAV_MAX_DATA_SIZE) //keep draining so the callback never overruns, drop the bytes
+				continue;
+
+			n = SDL_min(n, WAV_MAX_DATA_SIZE - written);
+			if(SDL_RWwrite(stream->file, stream->chunk, 1, n) != n)
+				stream->failed = true;
+			else
+				SDL_AtomicAdd(&stream->bytes, (int)n);
+
+			if(stream->tap != NULL)
+				stream->tap(stream->tapData, stream->chunk, n);
+		}
+
+		if(!stopping)
+			SDL_Delay(WAV_STREAM_POLL_MS);
+	} while(!stopping);
+
+	return stream->failed ? -1 : 0;
+}
+
+/*READER THREAD: KEEP THE RING TOPPED UP FROM THE FILE UNTIL END OF DATA OR STOPPED*/
+int wavReaderThread(void* data)
+{
+	WavStream *stream = (WavStream*)data;
+	int n;
+
+	while(!SDL_AtomicGet(&stream->stop) && (n = fillWavReader(stream)) >= 0)
+	{
+		if(n == 0)
+			SDL_Delay(WAV_STREAM_POLL_MS);
+	}
+
+	return stream->failed ? -1 : 0;
+}
+
+/*CONVERT ONE CHUNK OF THE FILE INTO THE RING (READING THE NEXT ONE WHEN DONE), RETURN BYTES MOVED (0 IF THE RING IS FULL) OR -1 ONCE ALL DATA IS QUEUED*/
+int fillWavReader(WavStream* stream)
+{
+	Uint32 queued = (Uint32)SDL_AtomicGet(&stream->bytes);
+	Uint32 n, used;
+
+	if(stream->chunkPos == stream->chunkLen)
+	{
+		if(queued >= stream->dataSize || stream->failed){
+			ringBufferFinish(stream->ring);
+			return -1;
+		}
+
+		n = (Uint32)SDL_RWread(stream->file, stream->chunk, 1, SDL_min(WAV_STREAM_CHUNK, stream->dataSize - queued));
+		if(n == 0){ //truncated file: play what there is
+			stream->failed = true;
+			ringBufferFinish(stream->ring);
+			return -1;
+		}
+
+		stream->chunkPos = 0;
+		stream->chunkLen = n;
+		SDL_AtomicAdd(&stream->bytes, (int)n);
+	}
+
+	n = convertAudio(&stream->converter, stream->chunk + stream->chunkPos, stream->chunkLen - stream->chunkPos, stream->converted,
+		SDL_min(ringBufferSpace(stream->ring), WAV_STREAM_CHUNK), &used);
+	stream->chunkPos += used;
+
+	//a trailing partial frame can never be converted
+	if(used == 0 && stream->chunkLen - stream->chunkPos < (Uint32)stream->converter.inFrameSize)
+		stream->chunkPos = stream->chunkLen;
+
+	ringBufferWrite(stream->ring, stream->converted, n);
+
+	return (int)(n + used);
+}
+
+/*WRITE A CANONICAL 44 BYTE WAV HEADER FOR dataSize BYTES OF spec SAMPLES*/
+bool writeWavHeader(SDL_RWops* file, const SDL_AudioSpec* spec, Uint32 dataSize)
+{
+	Uint16 bits = SDL_AUDIO_BITSIZE(spec->format);
+	Uint16 blockAlign = spec->channels * (bits / 8);
+	Uint16 formatTag = SDL_AUDIO_ISFLOAT(spec->format) ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+
+	return SDL_RWwrite(file, "RIFF", 4, 1) == 1 && SDL_WriteLE32(file, (WAV_HEADER_SIZE - 8) + dataSize) &&
+		SDL_RWwrite(file, "WAVEfmt ", 8, 1) == 1 && SDL_WriteLE32(file, 16) &&
+		SDL_WriteLE16(file, formatTag) && SDL_WriteLE16(file, spec->channels) &&
+		SDL_WriteLE32(file, spec->freq) && SDL_WriteLE32(file, spec->freq * blockAlign) &&
+		SDL_WriteLE16(file, blockAlign) && SDL_WriteLE16(file, bits) &&
+		SDL_RWwrite(file, "data", 4, 1) == 1 && SDL_WriteLE32(file, dataSize);
+}
+
+/*READ WAV HEADER CHUNKS UP TO THE START OF THE SAMPLE DATA, FILLING spec AND dataSize*/
+bool readWavHeader(SDL_RWops* file, SDL_AudioSpec* spec, Uint32* dataSize)
+{
+	char id[4];
+	Uint32 size;
+	Uint16 formatTag = 0, bits = 0;
+	bool hasFormat = false;
+
+	if(SDL_RWread(file, id, 4, 1) != 1 || SDL_memcmp(id, "RIFF", 4) != 0)
+		return false;
+	SDL_ReadLE32(file);
+	if(SDL_RWread(file, id, 4, 1) != 1 || SDL_memcmp(id, "WAVE", 4) != 0)
+		return false;
+
+	SDL_zerop(spec);
+
+	while(SDL_RWread(file, id, 4, 1) == 1)
+	{
+		size = SDL_ReadLE32(file);
+
+		if(SDL_memcmp(id, "fmt ", 4) == 0 && size >= 16){
+			formatTag = SDL_ReadLE16(file);
+			spec->channels = (Uint8)SDL_ReadLE16(file);
+			spec->freq = (int)SDL_ReadLE32(file);
+			SDL_ReadLE32(file); //byte rate
+			SDL_ReadLE16(file); //block align
+			bits = SDL_ReadLE16(file);
+			hasFormat = true;
+			size -= 16;
+		}
+		else if(SDL_memcmp(id, "data", 4) == 0){
+			*dataSize = size;
+			break;
+		}
+
+		if(SDL_RWseek(file, size + (size & 1), RW_SEEK_CUR) < 0) //chunks are word aligned
+			return false;
+	}
+
+	if(!hasFormat || spec->channels == 0 || SDL_memcmp(id, "data", 4) != 0)
+		return false;
+
+	if(formatTag == WAVE_FORMAT_IEEE_FLOAT && bits == 32)
+		spec->format = AUDIO_F32SYS;
+	else if(formatTag == WAVE_FORMAT_PCM && bits == 32)
+		spec->format = AUDIO_S32SYS;
+	else if(formatTag == WAVE_FORMAT_PCM && bits == 16)
+		spec->format = AUDIO_S16SYS;
+	else if(formatTag == WAVE_FORMAT_PCM && bits == 8)
+		spec->format = AUDIO_U8;
+	else
+		return false;
+
+	return true;
+}
@@ -0,0 +1,39 @@
+#ifndef WAVSTREAM_H
+#define WAVSTREAM_H
+
+#include <stdbool.h>
+#include "SDL2/SDL.h"
+#include "ringbuffer.h"
+#include "audioconvert.h"
+
+#define WAV_STREAM_CHUNK 16384  //bytes moved between ring and file per read/write
+#define WAV_STREAM_POLL_MS 5    //idle wait of the stream threads when there is nothing to move
+#define WAV_HEADER_SIZE 44
+
+typedef void (*WavStreamTap)(void* data, const Uint8* bytes, Uint32 len);
+
+//moves audio between a RingBuffer and a WAV file on its own thread, so neither the
+//audio callback nor the game thread touch the disk while recording/playing
+typedef struct{
+	SDL_Thread *thread;
+	SDL_RWops *file;
+	RingBuffer *ring;
+	SDL_AudioSpec spec;
+	WavStreamTap tap;       //writer: also sees every chunk written, on the writer thread
+	void *tapData;
+	SDL_atomic_t stop;      //game thread asks the stream thread to finish
+	SDL_atomic_t bytes;     //sample bytes written to/read from the file so far
+	Uint32 dataSize;        //reader: sample bytes in the file
+	AudioConverter converter; //reader: file spec -> ring spec
+	Uint32 chunkPos, chunkLen; //reader: chunk bytes not converted yet
+	bool failed;            //stream thread hit an I/O error
+	Uint8 chunk[WAV_STREAM_CHUNK];
+	Uint8 converted[WAV_STREAM_CHUNK];
+} WavStream;
+
+bool startWavWriter(WavStream* stream, const char* path, const SDL_AudioSpec* spec, RingBuffer* ring, WavStreamTap tap, void* tapData);
+Uint32 stopWavWriter(WavStream* stream);
+bool startWavReader(WavStream* stream, const char* path, RingBuffer* ring, const SDL_AudioSpec* ringSpec);
+void stopWavReader(WavStream* stream);
+
+#endif